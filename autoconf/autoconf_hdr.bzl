@@ -1,15 +1,89 @@
 """# autoconf_hdr"""
 
+load("@rules_cc//cc/common:cc_common.bzl", "cc_common")
+load("@rules_cc//cc/common:cc_info.bzl", "CcInfo")
 load(
     "//autoconf/private:autoconf_config.bzl",
     "collect_deps",
     "collect_transitive_results",
     "filter_defaults",
+    "find_result_file",
     "get_autoconf_toolchain_defaults",
     "get_autoconf_toolchain_defaults_by_label",
 )
 load("//autoconf/private:providers.bzl", "CcAutoconfInfo")
 
+def _shard_owners(dep_infos, define_checks):
+    """Map each define to a shard named after the `CcAutoconfInfo` owning it.
+
+    Args:
+        dep_infos (list): Transitive `CcAutoconfInfo` of the header's deps.
+        define_checks (dict[str, File]): The defines rendered by the header.
+
+    Returns:
+        dict[str, str]: Define name to shard name. Defines that only come from
+        toolchain defaults have no owner and stay in the umbrella header.
+    """
+    define_owner = {}
+    for info in dep_infos:
+        for define_name, result_file in info.define_results.items():
+            if define_name in define_owner or define_name not in define_checks:
+                continue
+            if define_checks[define_name].path == result_file.path:
+                define_owner[define_name] = info.owner
+
+    # Shards are named after the owning target, qualified by package only
+    # where two owners share a name.
+    owners_by_name = {}
+    for owner in define_owner.values():
+        owners_by_name.setdefault(owner.name, {})[owner] = True
+    shard_names = {}
+    for name, owners in owners_by_name.items():
+        for owner in owners:
+            if len(owners) == 1:
+                shard_names[owner] = name
+            else:
+                shard_names[owner] = "{}_{}".format(
+                    owner.package.replace("/", "_"),
+                    name,
+                )
+
+    return {
+        define_name: shard_names[owner]
+        for define_name, owner in define_owner.items()
+    }
+
+def _module_map_content(label, out, shards):
+    """Render a Clang module map for a generated header and its fragments.
+
+    Args:
+        label (Label): The owning target, used as the module name.
+        out (File): The generated header.
+        shards (dict[str, File]): Fragments by shard name.
+
+    Returns:
+        str: The module map content.
+    """
+    module_name = "{}//{}:{}".format(
+        "@" + label.workspace_name if label.workspace_name else "",
+        label.package,
+        label.name,
+    )
+    lines = [
+        "module \"{}\" {{".format(module_name),
+        "    header \"{}\"".format(out.basename),
+        "    export *",
+    ]
+    for shard_name, shard in shards.items():
+        lines.extend([
+            "    module \"{}\" {{".format(shard_name),
+            "        header \"{}.d/{}\"".format(out.basename, shard.basename),
+            "        export *",
+            "    }",
+        ])
+    lines.append("}")
+    return "\n".join(lines) + "\n"
+
 def _autoconf_hdr_impl(ctx):
     """Implementation of the autoconf_hdr rule."""
 
@@ -46,6 +120,10 @@ def _autoconf_hdr_impl(ctx):
     for uq in dep_results.get("unquoted_defines", []):
         all_unquoted[uq] = True
 
+    define_shards = {}
+    if ctx.attr.shards:
+        define_shards = _shard_owners(dep_infos, all_define_checks)
+
     # Build the manifest: maps define/subst names to result file paths + metadata
     manifest_data = {
         "defines": {},
@@ -56,12 +134,28 @@ def _autoconf_hdr_impl(ctx):
             "path": result_file.path,
             "unquote": define_name in all_unquoted,
         }
+        if define_name in define_shards:
+            manifest_data["defines"][define_name]["owner"] = define_shards[define_name]
     for subst_name, result_file in all_subst_checks.items():
         manifest_data["substs"][subst_name] = {
             "path": result_file.path,
             "unquote": subst_name in all_unquoted,
         }
 
+    # gl_CONDITIONAL_HEADER results, wrapped around the render by the resolver
+    conditional_files = []
+    if ctx.attr.condition:
+        if not ctx.attr.next_header:
+            fail("`{}` sets `condition` but not `next_header`".format(ctx.label))
+        if ctx.attr.shards:
+            fail("`{}` cannot combine `condition` with `shards`".format(ctx.label))
+        manifest_data["conditional"] = {}
+        all_cache = defaults.cache | dep_results["cache"]
+        for name in [ctx.attr.condition, ctx.attr.include_next, ctx.attr.next_header]:
+            result_file = find_result_file(name, all_cache, all_define_checks, all_subst_checks, ctx.label)
+            manifest_data["conditional"][name] = {"path": result_file.path}
+            conditional_files.append(result_file)
+
     manifest = ctx.actions.declare_file("{}.manifest.json".format(ctx.label.name))
     ctx.actions.write(
         output = manifest,
@@ -69,7 +163,7 @@ def _autoconf_hdr_impl(ctx):
     )
 
     inputs = depset(
-        [ctx.file.template, manifest] + all_subst_checks.values() + all_define_checks.values(),
+        [ctx.file.template, manifest] + all_subst_checks.values() + all_define_checks.values() + conditional_files,
     )
 
     # Process inlines: collect files and create mappings
@@ -101,21 +195,69 @@ def _autoconf_hdr_impl(ctx):
     if ctx.attr.substitutions:
         args.add("--subst", json.encode(ctx.attr.substitutions))
 
+    if ctx.attr.condition:
+        args.add("--condition", ctx.attr.condition)
+        args.add("--include-next", ctx.attr.include_next)
+        args.add("--next-header", ctx.attr.next_header)
+
+    # One fragment per owning target, next to `out` so the umbrella can
+    # include them by a relative path.
+    shards = {}
+    for shard_name in sorted(depset(define_shards.values()).to_list()):
+        shard = ctx.actions.declare_file(
+            "{}.d/{}.h".format(ctx.outputs.out.basename, shard_name),
+            sibling = ctx.outputs.out,
+        )
+        shards[shard_name] = shard
+        args.add("--shard", "{}={}".format(shard_name, shard.path))
+
     ctx.actions.run(
         executable = ctx.executable._resolver,
         arguments = [args],
         inputs = inputs,
-        outputs = [ctx.outputs.out],
+        outputs = [ctx.outputs.out] + shards.values(),
         mnemonic = "CcAutoconfHdr",
         env = ctx.configuration.default_shell_env,
     )
 
+    headers = [ctx.outputs.out] + shards.values()
+
+    # The rendered header only holds macros, which makes it a good module:
+    # with implicit modules Clang finds the map next to the header and
+    # parses the header once per build instead of once per translation unit.
+    module_map = None
+    if ctx.attr.module_map:
+        module_map = ctx.actions.declare_file(
+            "module.modulemap",
+            sibling = ctx.outputs.out,
+        )
+        ctx.actions.write(
+            output = module_map,
+            content = _module_map_content(ctx.label, ctx.outputs.out, shards),
+        )
+        headers.append(module_map)
+
     # Return a dict mapping define names to result files (from autoconf deps)
     # The merged output_results_json is still created for backward compatibility, but the provider
     # now carries the dict of define names to files
+    output_groups = {
+        "autoconf_hdr_shard_" + shard_name: depset([shard])
+        for shard_name, shard in shards.items()
+    }
+    if module_map:
+        output_groups["autoconf_hdr_module_map"] = depset([module_map])
     return [
         DefaultInfo(
-            files = depset([ctx.outputs.out]),
+            files = depset(headers),
+        ),
+        CcInfo(
+            compilation_context = cc_common.create_compilation_context(
+                headers = depset(headers),
+            ),
+        ),
+        OutputGroupInfo(
+            autoconf_hdr_shards = depset(shards.values()),
+            **output_groups
         ),
     ]
 
@@ -157,8 +299,80 @@ Valid `mode` values:
 - `"all"`: Process both defines and substitution variables.
 
 This allows you to run checks once and generate multiple header files from the same results.
+
+The generated header is also provided through `CcInfo`, so an `autoconf_hdr`
+target can be listed directly in the `deps` of `cc_*` rules.
+
+Sharding:
+
+With `shards = True`, every define is written to a fragment named after the
+`autoconf`/`autoconf_library` target that owns it (`<out>.d/<target name>.h`,
+next to `out`), and `out` becomes a small umbrella header that includes the
+fragments in place. Including `out` is equivalent to the unsharded header,
+while a translation unit that only needs a few modules can include just their
+fragments and skip parsing the rest. Fragments only hold the plain
+`#define`/`#undef` lines (and their comments); anything conditional or inlined
+stays in the umbrella.
+
+Each fragment is also exposed as the `autoconf_hdr_shard_<target name>` output
+group (`autoconf_hdr_shards` holds all of them):
+
+```python
+autoconf_hdr(
+    name = "config_h",
+    out = "config.h",
+    shards = True,
+    template = "config.h.in",
+    deps = [":malloc", ":strerror"],
+)
+
+filegroup(
+    name = "malloc_config",
+    srcs = [":config_h"],
+    output_group = "autoconf_hdr_shard_malloc",
+)
+```
+
+Conditional headers:
+
+Setting `condition` applies gnulib's `gl_CONDITIONAL_HEADER` pattern while
+rendering, like a `gnulib_conditional_hdr` downstream of this rule but in one
+action. The `condition`, `include_next` and `next_header` names are looked up
+across the cache, define and subst results of `deps` (and the toolchain
+defaults). When `condition` is truthy (non-empty, not `"false"`, not `"0"`)
+the rendered header is written as-is; otherwise it is kept as dead code
+behind a passthrough to the system header:
+
+```c
+#if 1
+#include_next <assert.h>
+#else
+/* rendered template (dead code) */
+#endif
+```
+
+```python
+autoconf_hdr(
+    name = "assert_h",
+    out = "lib/assert.h",
+    template = "lib/assert.in.h",
+    mode = "subst",
+    condition = "GL_GENERATE_ASSERT_H",
+    next_header = "NEXT_ASSERT_H",
+    deps = [
+        "@rules_cc_autoconf//gnulib/m4/assert_h",
+        "@rules_cc_autoconf//gnulib/m4/include_next",
+    ],
+)
+```
 """,
     attrs = {
+        "condition": attr.string(
+            doc = """Check result name that decides whether `out` is needed at all.
+
+            See "Conditional headers" above. Requires `next_header`.""",
+            default = "",
+        ),
         "defaults": attr.bool(
             doc = """Whether to include toolchain defaults.
 
@@ -188,6 +402,10 @@ This allows you to run checks once and generate multiple header files from the s
             doc = "List of `autoconf` targets which provide check results. Results from all deps will be merged together, and duplicate define names will produce an error. If not provided, an empty results file will be created.",
             providers = [CcAutoconfInfo],
         ),
+        "include_next": attr.string(
+            doc = "Check result name for the `#include_next` directive used with `condition`.",
+            default = "INCLUDE_NEXT",
+        ),
         "inlines": attr.string_keyed_label_dict(
             doc = """A mapping of strings to files for replace within the content of the given `template` attribute.
 
@@ -201,10 +419,31 @@ This allows you to run checks once and generate multiple header files from the s
             default = "defines",
             values = ["defines", "subst", "all"],
         ),
+        "module_map": attr.bool(
+            doc = """Also emit a Clang `module.modulemap` next to `out`.
+
+            The map declares `out` (and, with `shards`, each fragment as a
+            submodule) so that builds using Clang modules (`-fmodules`) parse
+            the header once instead of in every translation unit. The map is
+            part of the `CcInfo` headers and the `autoconf_hdr_module_map`
+            output group. Only one `autoconf_hdr` with `module_map = True`
+            may write to a given output directory.""",
+            default = False,
+        ),
+        "next_header": attr.string(
+            doc = "Check result name for the system header (`NEXT_<HEADER>_H`) used with `condition`.",
+            default = "",
+        ),
         "out": attr.output(
             doc = "The output config file (typically `config.h`).",
             mandatory = True,
         ),
+        "shards": attr.bool(
+            doc = """Split the header into an umbrella `out` and one fragment per owning target.
+
+            See "Sharding" above.""",
+            default = False,
+        ),
         "substitutions": attr.string_dict(
             doc = """A mapping of exact strings to replacement values.
 
@@ -38,6 +38,25 @@ On modern Linux (glibc 2.34+) where pthread/rt functions are in libc,
 AC_SEARCH_LIBS produces empty values and no extra -l flags are added.
 On older systems, the appropriate flags (-lpthread, -lrt) are added
 automatically.
+
+Binaries that combine several gnulib-derived libraries should link one
+merged target rather than each library's own:
+
+```python
+autoconf_linkopts(
+    name = "all_linkopts",
+    linkopts = [
+        "//lib/foo:linkopts",
+        "//lib/bar:linkopts",
+    ],
+)
+```
+
+The merged response file lists every library once, at its last occurrence
+in link order (`-lfoo -lpthread -lbar -lpthread` becomes
+`-lfoo -lbar -lpthread`). Other flags are kept in order, and flags that
+only work together (`-Wl,-rpath -Wl,/dir`, `-Wl,-Bstatic ... -Wl,-Bdynamic`)
+stay together.
 """
 
 load("@rules_cc//cc:find_cc_toolchain.bzl", "find_cpp_toolchain", "use_cc_toolchain")
@@ -49,7 +68,7 @@ load(
     "collect_transitive_results",
     "get_autoconf_toolchain_defaults",
 )
-load("//autoconf/private:providers.bzl", "CcAutoconfInfo")
+load("//autoconf/private:providers.bzl", "AutoconfLinkoptsInfo", "CcAutoconfInfo")
 
 _MSVC_LIKE_COMPILERS = ("msvc-cl", "clang-cl")
 
@@ -78,25 +97,30 @@ def _autoconf_linkopts_impl(ctx):
     inputs = []
     args = ctx.actions.args()
 
-    found_vars = []
-    for var_name in ctx.attr.vars:
-        if var_name in all_subst:
-            result_file = all_subst[var_name]
-            args.add("--var", "{}={}".format(var_name, result_file.path))
-            inputs.append(result_file)
-            found_vars.append(var_name)
-
-    # Also check cache results for variables that are stored as cache
-    # (some AC_SEARCH_LIBS results use the cache variable name)
+    # Resolve each variable from the subst results, falling back to the cache
+    # variable name some AC_SEARCH_LIBS results are stored under.
     all_cache = defaults.cache | dep_results["cache"]
+    own_results = []
     for var_name in ctx.attr.vars:
-        if var_name not in found_vars:
-            cache_name = "ac_cv_subst_" + var_name
-            if cache_name in all_cache:
-                result_file = all_cache[cache_name]
-                args.add("--var", "{}={}".format(var_name, result_file.path))
-                inputs.append(result_file)
-                found_vars.append(var_name)
+        result_file = all_subst.get(var_name)
+        if not result_file:
+            result_file = all_cache.get("ac_cv_subst_" + var_name)
+        if result_file:
+            own_results.append(struct(name = var_name, result = result_file))
+
+    # Topological order puts every target's variables before those of the
+    # targets it merges, and a shared target after all of its users.
+    results = depset(
+        own_results,
+        transitive = [
+            dep[AutoconfLinkoptsInfo].results
+            for dep in ctx.attr.linkopts
+        ],
+        order = "topological",
+    )
+    for entry in results.to_list():
+        args.add("--var", "{}={}".format(entry.name, entry.result.path))
+        inputs.append(entry.result)
 
     args.add("--output", flags_file)
     args.add("--pragma-output", pragma_file)
@@ -148,9 +172,12 @@ def _autoconf_linkopts_impl(ctx):
             linker_inputs = depset([linker_input]),
         )
 
+    # Only this target's response file is linked: the merged targets'
+    # flags are already part of it, so their CcInfo is not forwarded.
     return [
         DefaultInfo(files = depset([flags_file])),
         CcInfo(linking_context = linking_context),
+        AutoconfLinkoptsInfo(results = results),
     ]
 
 autoconf_linkopts = rule(
@@ -169,6 +196,14 @@ response files.
 
 Variables not found in the deps are silently ignored (they may
 be provided by a different module or not needed on this platform).
+
+Targets listed in `linkopts` are merged transitively into a single
+response file. Standalone libraries (`-l<name>` and library paths) are
+deduplicated keeping their last occurrence, so a library shared by several
+merged targets lands after all of them, as static archive resolution
+requires. Everything else keeps its original order; ordered pairs such as
+`-Wl,-framework -Wl,Foo` and regions such as `-Wl,--as-needed ...
+-Wl,--no-as-needed` are never split or deduplicated.
 """,
     attrs = {
         "defaults": attr.bool(
@@ -177,16 +212,21 @@ be provided by a different module or not needed on this platform).
         ),
         "deps": attr.label_list(
             doc = "List of autoconf targets providing check results.",
-            mandatory = True,
             providers = [CcAutoconfInfo],
         ),
+        "linkopts": attr.label_list(
+            doc = """\
+Other `autoconf_linkopts` targets whose flags are merged, transitively, into
+this target's response file. Their own response files are not linked.
+""",
+            providers = [AutoconfLinkoptsInfo],
+        ),
         "vars": attr.string_list(
             doc = """\
 List of AC_SUBST variable names to resolve (e.g., ["LIBPTHREAD", "FDATASYNC_LIB"]).
 Each variable is looked up in the subst results from deps. Non-empty values
 (like "-lpthread") are added to linkopts; empty values are skipped.
 """,
-            mandatory = True,
         ),
         "_linkopts_gen": attr.label(
             cfg = "exec",
@@ -4,7 +4,15 @@ Provides default autoconf checks that can be overridden by targets.
 """
 
 load("@rules_cc//cc:find_cc_toolchain.bzl", "use_cc_toolchain")
-load("//autoconf/private:autoconf_config.bzl", "collect_deps", "collect_transitive_results")
+load(
+    "//autoconf/private:autoconf_config.bzl",
+    "collect_deps",
+    "collect_transitive_results",
+    "create_config_dict",
+    "get_cc_toolchain_info",
+    "get_environment_variables",
+    "write_config_json",
+)
 load("//autoconf/private:autoconf_library.bzl", "COMMON_ATTRS", "autoconf_impl_common")
 load("//autoconf/private:providers.bzl", "CcAutoconfInfo")
 
@@ -36,10 +44,32 @@ def _autoconf_toolchain_impl(ctx):
     # Unified content cache: cache_deps + defaults (for content-based action dedup)
     unified_content_cache = cache_results["content_cache"] | defaults_results["content_cache"]
 
+    symbol_index = None
+    if ctx.attr.symbol_index:
+        toolchain_info = get_cc_toolchain_info(ctx)
+        config_json = write_config_json(ctx, create_config_dict(
+            toolchain_info = toolchain_info,
+        ))
+        symbol_index = ctx.actions.declare_file("{}.symbols.idx".format(ctx.label.name))
+        args = ctx.actions.args()
+        args.add("--config", config_json)
+        args.add("--build-symbol-index", symbol_index)
+        ctx.actions.run(
+            executable = ctx.executable._checker,
+            arguments = [args],
+            inputs = [config_json],
+            outputs = [symbol_index],
+            mnemonic = "CcAutoconfSymbolIndex",
+            progress_message = "CcAutoconfSymbolIndex %{label}",
+            env = get_environment_variables(ctx, toolchain_info) | ctx.configuration.default_shell_env,
+            tools = toolchain_info.cc_toolchain.all_files,
+        )
+
     return [
         platform_common.ToolchainInfo(
             label = ctx.label,
             autoconf_cache = unified_content_cache,
+            symbol_index = symbol_index,
             autoconf_defaults = struct(
                 cache = defaults_results["cache"],
                 define = defaults_results["define"],
@@ -142,6 +172,26 @@ dependencies with different result files"*:
   provides it.
 - Or factor the shared check into its own `autoconf` /
   `autoconf_cache` target and depend on it from both consumers.
+
+## Symbol index
+
+Link probes (`AC_CHECK_FUNC`, `AC_SEARCH_LIBS`) are among the most
+expensive checks. With `symbol_index = True` the toolchain runs one extra
+action that links an empty program with `-Wl,-t` and records which symbols
+the libraries of that default link export (ELF dynamic symbol tables,
+archive symbol indexes and GNU linker scripts).
+
+`autoconf` targets resolving this toolchain consult the index for
+`AC_CHECK_FUNC` and the first, no-extra-library probe of `AC_SEARCH_LIBS`
+when they use the stock probe code. A symbol the index finds is reported
+as available without linking. Probes that add `-l<name>` (`AC_CHECK_LIB`
+and the library probes of `AC_SEARCH_LIBS`) always link, since the library
+may need dependencies that do not resolve. So do custom `code`, symbols the
+index does not list, and MSVC and non-ELF toolchains.
+
+The index is an approximation of the default link: an archive member it
+lists may in principle need symbols the default link lacks. Leave it off
+where that matters.
 """,
     implementation = _autoconf_toolchain_impl,
     attrs = {
@@ -153,7 +203,18 @@ dependencies with different result files"*:
             doc = "Targets whose results provide baseline values for `autoconf_hdr` rendering.",
             providers = [CcAutoconfInfo],
         ),
+        "symbol_index": attr.bool(
+            doc = "Index the symbols exported by the C/C++ toolchain's libraries once, so function and library checks can skip linking. See [Symbol index](#symbol-index).",
+            default = False,
+        ),
+        "_checker": attr.label(
+            cfg = "exec",
+            executable = True,
+            default = Label("//autoconf/private/checker:checker_bin"),
+        ),
     },
+    fragments = ["cpp"],
+    toolchains = use_cc_toolchain(),
 )
 
 def _autoconf_cache_impl(ctx):
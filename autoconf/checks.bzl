@@ -421,15 +421,19 @@ def _ac_check_func(
     if not name:
         name = _get_cache_name_for_func(function)
 
-    if not code:
-        code = _AC_CHECK_FUNC_DEFAULT_TEMPLATE.format(function = function)
-
     check = {
         "language": language,
         "name": name,  # Cache variable name
         "type": "function",
     }
 
+    if not code:
+        code = _AC_CHECK_FUNC_DEFAULT_TEMPLATE.format(function = function)
+
+        # The stock template only asks whether the symbol resolves, which
+        # the toolchain symbol index can answer without linking.
+        check["symbol"] = function
+
     check["code"] = code
     if compile_defines:
         check["compile_defines"] = compile_defines
@@ -868,8 +872,9 @@ def _ac_prog_cxx(requires = None):
     )
 
 # Uses negative array size to verify sizeof at compile time. The checker
-# iterates candidate values, substituting {value}; compilation succeeds only
-# when sizeof matches. Portable across all C compilers including MSVC.
+# searches for the value by rewriting `== {value}` into `<=` comparisons
+# (galloping, then bisecting) and compiling each. Portable across all C
+# compilers including MSVC.
 _AC_CHECK_SIZEOF_TEMPLATE = """\
 {}
 #include <stddef.h>
@@ -983,8 +988,9 @@ def _ac_check_sizeof(
     return make_check(check)
 
 # Uses negative array size to verify alignment at compile time. The checker
-# iterates candidate values, substituting {value}; compilation succeeds only
-# when offsetof matches. Portable across all C compilers including MSVC.
+# searches for the value by rewriting `== {value}` into `<=` comparisons
+# (galloping, then bisecting) and compiling each. Portable across all C
+# compilers including MSVC.
 _AC_CHECK_ALIGNOF_TEMPLATE = """\
 {}
 #include <stddef.h>
@@ -1501,6 +1507,10 @@ def _ac_check_c_compiler_flag(
         subst = None):
     """Check if the C compiler supports a specific flag.
 
+    Flag checks of one target that share a language are run as a batch: all
+    flags are tried in a single compile and only the ones the compiler
+    rejects cost further compiles.
+
     Original m4 example:
     ```m4
     AC_CHECK_C_COMPILER_FLAG([-Wall], [CFLAGS="$CFLAGS -Wall"])
@@ -1555,6 +1565,10 @@ def _ac_check_cxx_compiler_flag(
         subst = None):
     """Check if the C++ compiler supports a specific flag.
 
+    Flag checks of one target that share a language are run as a batch: all
+    flags are tried in a single compile and only the ones the compiler
+    rejects cost further compiles.
+
     Original m4 example:
     ```m4
     AC_CHECK_CXX_COMPILER_FLAG([-std=c++17], [CXXFLAGS="$CXXFLAGS -std=c++17"])
@@ -1774,6 +1788,7 @@ def _ac_search_libs(
         check["code"] = code
     else:
         check["code"] = _AC_SEARCH_LIBS_TEMPLATE.format(function = function)
+        check["symbol"] = function
 
     if requires:
         check["requires"] = requires
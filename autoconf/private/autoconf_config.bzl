@@ -54,6 +54,21 @@ def get_autoconf_toolchain_cache(ctx):
     cache = getattr(toolchain, "autoconf_cache", None)
     return cache if cache else {}
 
+def get_autoconf_toolchain_symbol_index(ctx):
+    """Get the symbol index produced by the autoconf toolchain.
+
+    Args:
+        ctx (ctx): The rule context (must declare the autoconf toolchain type).
+
+    Returns:
+        File: The index, or None if no toolchain is configured or indexing is
+              disabled.
+    """
+    toolchain = ctx.toolchains[_TOOLCHAIN_TYPE]
+    if not toolchain:
+        return None
+    return getattr(toolchain, "symbol_index", None)
+
 def get_autoconf_toolchain_defaults(ctx):
     """Get default checks from the autoconf toolchain if available.
 
@@ -267,6 +282,53 @@ def collect_transitive_results(dep_infos):
         "unquoted_defines": sorted(unquoted_defines_set.keys()),
     }
 
+def find_result_file(name, all_cache, all_define, all_subst, label):
+    """Look up a check result name across cache/define/subst namespaces.
+
+    Args:
+        name (str): The check result name.
+        all_cache (dict): Cache variable name to result `File`.
+        all_define (dict): Define name to result `File`.
+        all_subst (dict): Subst name to result `File`.
+        label (Label): The requesting target, for error messages.
+
+    Returns:
+        File: The result file. Fails with a clear error if the name is not
+        found or is ambiguous.
+    """
+    candidates = []
+    if name in all_cache:
+        candidates.append(("cache", all_cache[name]))
+    if name in all_define:
+        candidates.append(("define", all_define[name]))
+    if name in all_subst:
+        candidates.append(("subst", all_subst[name]))
+
+    if not candidates:
+        all_available = {
+            "cache": sorted(all_cache.keys()),
+            "define": sorted(all_define.keys()),
+            "subst": sorted(all_subst.keys()),
+        }
+        fail("`{}` requires `{}` which is not provided by any deps. Available: {}".format(
+            label,
+            name,
+            json.encode_indent(all_available, indent = " " * 4),
+        ))
+
+    distinct_paths = {}
+    for bucket, f in candidates:
+        distinct_paths[f.path] = (bucket, f)
+
+    if len(distinct_paths) != 1:
+        fail("`{}` requires `{}` but it is ambiguous across deps.\nMatches: {}".format(
+            label,
+            name,
+            [(bucket, f.path) for (bucket, f) in candidates],
+        ))
+
+    return distinct_paths.values()[0][1]
+
 def collect_deps(deps):
     """Collect `CcAutoconfInfo` from dependencies.
 
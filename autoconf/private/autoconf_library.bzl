@@ -1,5 +1,6 @@
 """autoconf implementation"""
 
+load("@bazel_skylib//rules:common_settings.bzl", "BuildSettingInfo")
 load("@rules_cc//cc:find_cc_toolchain.bzl", "use_cc_toolchain")
 load(
     "//autoconf/private:autoconf_config.bzl",
@@ -7,11 +8,17 @@ load(
     "collect_transitive_results",
     "create_config_dict",
     "get_autoconf_toolchain_cache",
+    "get_autoconf_toolchain_symbol_index",
     "get_cc_toolchain_info",
     "get_environment_variables",
     "write_config_json",
 )
-load("//autoconf/private:condition_utils.bzl", "extract_condition_vars")
+load(
+    "//autoconf/private:condition_utils.bzl",
+    "evaluate_static_condition",
+    "extract_condition_vars",
+    "static_define_value",
+)
 load("//autoconf/private:providers.bzl", "CcAutoconfInfo")
 
 _CONTENT_KEY_FIELDS = (
@@ -29,6 +36,7 @@ _CONTENT_KEY_FIELDS = (
     "compile_defines",
     "includes",
     "members",
+    "flag",
 )
 
 def _check_content_key(check):
@@ -64,6 +72,140 @@ def _coerce_name(name, value):
 
     return name
 
+def _check_dep_files(ctx, check, all_results):
+    """Resolve the result files a check reads, keyed by lookup name.
+
+    Args:
+        ctx: The rule context (for error messages).
+        check: The check dict.
+        all_results: Local and dependency results by group
+            (`cache`, `define`, `subst`).
+
+    Returns:
+        A dict of lookup name to result `File`.
+    """
+    all_required_defines = []
+
+    for required in check.get("requires", []):
+        all_required_defines.extend(extract_condition_vars(required))
+
+    for dep_name in check.get("input_deps", []):
+        all_required_defines.extend(extract_condition_vars(dep_name))
+
+    condition = check.get("condition")
+    if condition:
+        all_required_defines.extend(extract_condition_vars(condition))
+
+    for required in check.get("compile_defines", []):
+        all_required_defines.extend(extract_condition_vars(required))
+
+    # Build a dictionary mapping lookup_name -> file_path
+    # This ensures strict deduplication before passing to C++
+    name_to_file = {}  # lookup_name -> file_path
+
+    for required_define in depset(all_required_defines).to_list():
+        dep_results_file = None
+        for group_name in ["cache", "define", "subst"]:
+            if required_define in all_results[group_name]:
+                candidate_file = all_results[group_name][required_define]
+                if dep_results_file:
+                    # Check if it's the same file (legitimate duplicate from AC_DEFINE with subst=True)
+                    if dep_results_file != candidate_file:
+                        # Check if this is a legitimate duplicate: same variable in both define and subst groups
+                        # When AC_DEFINE has subst=True and define_name == subst_name, both reference
+                        # the same cache file directly, so they're the same result
+                        is_legitimate_duplicate = (
+                            required_define in all_results["define"] and
+                            required_define in all_results["subst"] and
+                            group_name in ["define", "subst"]
+                        )
+                        if is_legitimate_duplicate:
+                            # Same variable in both define and subst - they reference the same cache file
+                            # Use the define file (arbitrary but consistent choice)
+                            if group_name == "subst":
+                                continue  # Skip subst, use define
+
+                            # If we already have define, skip this (shouldn't happen, but be safe)
+                            if dep_results_file == all_results["define"][required_define]:
+                                continue
+
+                        # Different files - real conflict
+                        all_duplicates = {
+                            "cache": sorted([k for k in all_results["cache"].keys() if k == required_define]),
+                            "define": sorted([k for k in all_results["define"].keys() if k == required_define]),
+                            "subst": sorted([k for k in all_results["subst"].keys() if k == required_define]),
+                        }
+                        fail("Duplicate results were found for check `{}`. Please update `{}`.\n Available options: {}".format(
+                            required_define,
+                            ctx.label,
+                            json.encode_indent(all_duplicates, indent = " " * 4) + "\n",
+                        ))
+
+                    # Same file - no conflict, continue (AC_DEFINE with subst=True case)
+                else:
+                    dep_results_file = candidate_file
+
+        if not dep_results_file:
+            all_available = {
+                "cache": sorted(all_results["cache"].keys()),
+                "define": sorted(all_results["define"].keys()),
+                "subst": sorted(all_results["subst"].keys()),
+            }
+            fail("No results were found for check `{}`. Please update `{}`.\n Available options: {}".format(
+                required_define,
+                ctx.label,
+                json.encode_indent(all_available, indent = " " * 4) + "\n",
+            ))
+
+        # Deduplicate: check if this name is already mapped
+        if required_define in name_to_file:
+            if name_to_file[required_define] != dep_results_file:
+                fail("Duplicate lookup name '{}' maps to different files:\n  {} -> {}\n  {} -> {}\nThis indicates a bug in dependency resolution.".format(
+                    required_define,
+                    required_define,
+                    name_to_file[required_define],
+                    required_define,
+                    dep_results_file,
+                ))
+
+            # Same name, same file - idempotent, skip
+            continue
+
+        # Add mapping
+        name_to_file[required_define] = dep_results_file
+
+    return name_to_file
+
+def _needs_toolchain(action, dep_files, static_values):
+    """Whether an action may probe, and so must stage the toolchain.
+
+    An action probes unless each of its checks is either a condition or has
+    a `requires` entry that is false from results known at analysis time.
+
+    Args:
+        action: The action struct.
+        dep_files: The action's lookup name to result `File`.
+        static_values: Result `File` to value, for results known at
+            analysis time (see `static_define_value`).
+
+    Returns:
+        True unless the action is known never to probe.
+    """
+    values = {}
+    for lookup_name, file in dep_files.items():
+        if file in static_values:
+            values[lookup_name] = static_values[file]
+    for check in [action.check] + [derived.check for derived in action.outputs]:
+        if "condition" in check:
+            continue
+        closed = False
+        for required in check.get("requires", []):
+            if evaluate_static_condition(required, values) == False:
+                closed = True
+        if not closed:
+            return True
+    return False
+
 def autoconf_impl_common(ctx, resolve_toolchain):
     """Shared implementation for autoconf and autoconf_library rules.
 
@@ -86,9 +228,11 @@ def autoconf_impl_common(ctx, resolve_toolchain):
     # Content-based cache: reuse results for checks with identical implementation
     # regardless of consumer naming (define/subst/name).
     available_content_cache = dict(dep_results["content_cache"])
+    symbol_index = None
     if resolve_toolchain:
         tc_content_cache = get_autoconf_toolchain_cache(ctx)
         available_content_cache = tc_content_cache | available_content_cache
+        symbol_index = get_autoconf_toolchain_symbol_index(ctx)
 
     cache_checks = {}
     define_checks = {}
@@ -102,85 +246,101 @@ def autoconf_impl_common(ctx, resolve_toolchain):
 
     actions = {}
 
-    # Process all checks
+    # Process all checks. A check's derived outputs are processed right after
+    # it as checks of their own, except that when this target runs the
+    # primary probe, the same action also writes every output that is not
+    # already cached.
     for check_json in ctx.attr.checks:
-        check = json.decode(check_json)
-
-        if "name" not in check:
-            fail("Check in '{}' is missing 'name' field (cache variable name). All checks must have a 'name' field.".format(
-                ctx.label,
-            ))
+        primary = json.decode(check_json)
+        outputs = primary.pop("outputs", [])
+        primary_action = None
+        for index, check in enumerate([primary] + outputs):
+            if "name" not in check:
+                fail("Check in '{}' is missing 'name' field (cache variable name). All checks must have a 'name' field.".format(
+                    ctx.label,
+                ))
 
-        name = check["name"]
-        define = check.get("define")
-        define_name = _coerce_name(name, define)
-        subst = check.get("subst")
+            name = check["name"]
+            define = check.get("define")
+            define_name = _coerce_name(name, define)
+            subst = check.get("subst")
 
-        # Subst will prefer the define name if it's available.
-        subst_name = _coerce_name(name, _coerce_name(define_name, subst))
+            # Subst will prefer the define name if it's available.
+            subst_name = _coerce_name(name, _coerce_name(define_name, subst))
 
-        # Compute content key from implementation fields only
-        content_key = _check_content_key(check)
+            # Compute content key from implementation fields only
+            content_key = _check_content_key(check)
 
-        # Same check implementation already processed in this target — idempotent skip
-        if content_key in content_cache and name in cache_results:
-            continue
+            # Same check implementation already processed in this target — idempotent skip
+            if content_key in content_cache and name in cache_results:
+                continue
 
-        # Reuse result from deps or toolchain when content key matches (cache hit)
-        if content_key in available_content_cache:
-            output = available_content_cache[content_key]
-        elif content_key in content_cache:
-            output = content_cache[content_key]
-        else:
-            output = ctx.actions.declare_file("{}/{}.result.cache.json".format(ctx.label.name, name))
-
-            check_spec = ctx.actions.declare_file("{}/{}.check.json".format(ctx.label.name, name))
-            ctx.actions.write(
-                output = check_spec,
-                content = json.encode_indent(check, indent = " " * 4) + "\n",
-            )
-
-            actions[name] = struct(
-                output = output,
-                check = check,
-                input = check_spec,
-            )
-
-        # Define/subst conflict detection: different cache variable claiming same symbol = error
-        if define:
-            check["define"] = define_name
-
-            if define_name in define_results:
-                fail("Define variable `{}` is duplicated on `{}`\nLEFT:  {}\nRIGHT: {}".format(
-                    define_name,
-                    ctx.label,
-                    define_checks[define_name],
-                    check,
+            # Reuse result from deps or toolchain when content key matches (cache hit)
+            if content_key in available_content_cache:
+                output = available_content_cache[content_key]
+            elif content_key in content_cache:
+                output = content_cache[content_key]
+            elif primary_action:
+                output = ctx.actions.declare_file("{}/{}.result.cache.json".format(ctx.label.name, name))
+                primary_action.outputs.append(struct(
+                    output = output,
+                    check = check,
                 ))
+            else:
+                output = ctx.actions.declare_file("{}/{}.result.cache.json".format(ctx.label.name, name))
+
+                # The primary's spec keeps its outputs for the checker.
+                spec = json.decode(check_json) if index == 0 else check
+                check_spec = ctx.actions.declare_file("{}/{}.check.json".format(ctx.label.name, name))
+                ctx.actions.write(
+                    output = check_spec,
+                    content = json.encode_indent(spec, indent = " " * 4) + "\n",
+                )
+
+                actions[name] = struct(
+                    output = output,
+                    check = check,
+                    input = check_spec,
+                    outputs = [],
+                )
+                if index == 0:
+                    primary_action = actions[name]
+
+            # Define/subst conflict detection: different cache variable claiming same symbol = error
+            if define:
+                check["define"] = define_name
+
+                if define_name in define_results:
+                    fail("Define variable `{}` is duplicated on `{}`\nLEFT:  {}\nRIGHT: {}".format(
+                        define_name,
+                        ctx.label,
+                        define_checks[define_name],
+                        check,
+                    ))
 
-            define_checks[define_name] = check
-            define_results[define_name] = output
+                define_checks[define_name] = check
+                define_results[define_name] = output
 
-            if check.get("unquote", False):
-                unquoted_defines.append(define_name)
+                if check.get("unquote", False):
+                    unquoted_defines.append(define_name)
 
-        if subst:
-            check["subst"] = subst_name
+            if subst:
+                check["subst"] = subst_name
 
-            if subst_name in subst_checks:
-                fail("Subst variable `{}` is duplicated on `{}`\nLEFT:  {}\nRIGHT: {}".format(
-                    subst_name,
-                    ctx.label,
-                    subst_checks[subst_name],
-                    check,
-                ))
+                if subst_name in subst_checks:
+                    fail("Subst variable `{}` is duplicated on `{}`\nLEFT:  {}\nRIGHT: {}".format(
+                        subst_name,
+                        ctx.label,
+                        subst_checks[subst_name],
+                        check,
+                    ))
 
-            subst_checks[subst_name] = check
-            subst_results[subst_name] = output
+                subst_checks[subst_name] = check
+                subst_results[subst_name] = output
 
-        cache_checks[name] = check
-        cache_results[name] = output
-        content_cache[content_key] = output
+            cache_checks[name] = check
+            cache_results[name] = output
+            content_cache[content_key] = output
 
     # Write config to JSON
     config_json = write_config_json(ctx, create_config_dict(
@@ -236,111 +396,149 @@ def autoconf_impl_common(ctx, resolve_toolchain):
         "subst": subst_results | dep_results["subst"],
     }
 
-    # Create individual CcAutoconfCheck actions for each cache variable
-    # All checks sharing the same cache variable are processed together
-    # (checks is already grouped by cache_name from _flatten_checks)
+    # An action reads what its outputs read too, except for the results it
+    # writes itself.
+    dep_files = {}
+    for check_name, action in actions.items():
+        written = [action.output] + [o.output for o in action.outputs]
+        files = _check_dep_files(ctx, action.check, all_results)
+        for derived in action.outputs:
+            for lookup_name, file in _check_dep_files(ctx, derived.check, all_results).items():
+                if file not in written:
+                    files[lookup_name] = file
+        dep_files[check_name] = files
+
+    # Compiler flag checks are batched per language: the checker tests every
+    # flag of a batch with one compile and only falls back to narrower
+    # compiles for the flags the compiler rejects. A check that reads the
+    # result of another flag check stays on its own to keep the batch
+    # acyclic.
+    flag_outputs = {
+        action.output: True
+        for action in actions.values()
+        if "flag" in action.check
+    }
+    flag_batches = {}
     for check_name, action in actions.items():
-        check_result_file = action.output
         check = action.check
-        check_json = action.input
-
-        all_required_defines = []
-
-        for required in check.get("requires", []):
-            all_required_defines.extend(extract_condition_vars(required))
-
-        for dep_name in check.get("input_deps", []):
-            all_required_defines.extend(extract_condition_vars(dep_name))
-
-        condition = check.get("condition")
-        if condition:
-            all_required_defines.extend(extract_condition_vars(condition))
-
-        for required in check.get("compile_defines", []):
-            all_required_defines.extend(extract_condition_vars(required))
+        if "flag" not in check or "condition" in check or action.outputs:
+            continue
+        if [f for f in dep_files[check_name].values() if f in flag_outputs]:
+            continue
+        flag_batches.setdefault(check.get("language", "c"), []).append(check_name)
 
+    batches = []
+    batched = {}
+    for language, check_names in sorted(flag_batches.items()):
+        if len(check_names) < 2:
+            continue
+        batches.append(("{} flags ({})".format(language, len(check_names)), check_names))
+        for check_name in check_names:
+            batched[check_name] = True
+
+    for check_name in actions:
+        if check_name not in batched:
+            batches.append((check_name, [check_name]))
+
+    # AC_DEFINEs without `requires` or a condition never probe, so their
+    # values are known here. A single-check action whose `requires` they
+    # close (or that only evaluates conditions) never probes either, and
+    # stages no toolchain.
+    static_values = {}
+    for name, check in cache_checks.items():
+        value = static_define_value(check)
+        if value != None:
+            static_values[cache_results[name]] = value
+
+    # With --//autoconf:prologue_report, every single-check action
+    # also profiles its probes and the profiles are summarized per target.
+    profile_prologues = ctx.attr._prologue_report[BuildSettingInfo].value
+    prologue_profiles = []
+
+    # With --//autoconf:probe_socket, single-check actions coalesce
+    # identical probes through a host-wide daemon.
+    probe_socket = ctx.attr._probe_socket[BuildSettingInfo].value
+    checker_jobs = ctx.attr._checker_jobs[BuildSettingInfo].value
+
+    # With --//autoconf:config_log, single-check actions write the failed
+    # probe commands of each check, with their output, to a config.log in the
+    # `autoconf_config_log` output group.
+    config_log_enabled = ctx.attr._config_log[BuildSettingInfo].value
+    config_logs = []
+
+    # With --//autoconf:record_probes, single-check actions also
+    # record their probes for offline replay (`autoconf_probe_records` output group).
+    record_probes = ctx.attr._record_probes[BuildSettingInfo].value
+    probe_records = []
+
+    # Create one CcAutoconfCheck action per cache variable (or batch)
+    # All checks sharing the same cache variable are processed together
+    # (checks is already grouped by cache_name from _flatten_checks)
+    for progress_name, check_names in batches:
         args = ctx.actions.args()
         args.use_param_file("@%s", use_always = True)
         args.set_param_file_format("multiline")
         args.add("--config", config_json)
-        args.add("--check", check_json)
-        args.add("--results", check_result_file)
-
-        # Collect dependencies for all required defines
-        # Build a dictionary mapping lookup_name -> file_path
-        # This ensures strict deduplication before passing to C++
-        name_to_file = {}  # lookup_name -> file_path
-
-        for required_define in depset(all_required_defines).to_list():
-            dep_results_file = None
-            for group_name in ["cache", "define", "subst"]:
-                if required_define in all_results[group_name]:
-                    candidate_file = all_results[group_name][required_define]
-                    if dep_results_file:
-                        # Check if it's the same file (legitimate duplicate from AC_DEFINE with subst=True)
-                        if dep_results_file != candidate_file:
-                            # Check if this is a legitimate duplicate: same variable in both define and subst groups
-                            # When AC_DEFINE has subst=True and define_name == subst_name, both reference
-                            # the same cache file directly, so they're the same result
-                            is_legitimate_duplicate = (
-                                required_define in all_results["define"] and
-                                required_define in all_results["subst"] and
-                                group_name in ["define", "subst"]
-                            )
-                            if is_legitimate_duplicate:
-                                # Same variable in both define and subst - they reference the same cache file
-                                # Use the define file (arbitrary but consistent choice)
-                                if group_name == "subst":
-                                    continue  # Skip subst, use define
-
-                                # If we already have define, skip this (shouldn't happen, but be safe)
-                                if dep_results_file == all_results["define"][required_define]:
-                                    continue
-
-                            # Different files - real conflict
-                            all_duplicates = {
-                                "cache": sorted([k for k in all_results["cache"].keys() if k == required_define]),
-                                "define": sorted([k for k in all_results["define"].keys() if k == required_define]),
-                                "subst": sorted([k for k in all_results["subst"].keys() if k == required_define]),
-                            }
-                            fail("Duplicate results were found for check `{}`. Please update `{}`.\n Available options: {}".format(
-                                required_define,
-                                ctx.label,
-                                json.encode_indent(all_duplicates, indent = " " * 4) + "\n",
-                            ))
-
-                        # Same file - no conflict, continue (AC_DEFINE with subst=True case)
-                    else:
-                        dep_results_file = candidate_file
-
-            if not dep_results_file:
-                all_available = {
-                    "cache": sorted(all_results["cache"].keys()),
-                    "define": sorted(all_results["define"].keys()),
-                    "subst": sorted(all_results["subst"].keys()),
-                }
-                fail("No results were found for check `{}`. Please update `{}`.\n Available options: {}".format(
-                    required_define,
-                    ctx.label,
-                    json.encode_indent(all_available, indent = " " * 4) + "\n",
-                ))
-
-            # Deduplicate: check if this name is already mapped
-            if required_define in name_to_file:
-                if name_to_file[required_define] != dep_results_file:
-                    fail("Duplicate lookup name '{}' maps to different files:\n  {} -> {}\n  {} -> {}\nThis indicates a bug in dependency resolution.".format(
-                        required_define,
-                        required_define,
-                        name_to_file[required_define],
-                        required_define,
-                        dep_results_file,
-                    ))
-
-                # Same name, same file - idempotent, skip
-                continue
 
-            # Add mapping
-            name_to_file[required_define] = dep_results_file
+        needs_toolchain = len(check_names) > 1 or _needs_toolchain(
+            actions[check_names[0]],
+            dep_files[check_names[0]],
+            static_values,
+        )
+        if not needs_toolchain:
+            args.add("--no-toolchain")
+
+        check_inputs = []
+        check_outputs = []
+        name_to_file = {}
+        use_symbol_index = False
+        for check_name in check_names:
+            action = actions[check_name]
+            check = action.check
+            args.add("--check", action.input)
+            args.add("--results", action.output)
+            check_inputs.append(action.input)
+            check_outputs.append(action.output)
+            for derived in action.outputs:
+                args.add("--output", "{}={}".format(derived.check["name"], derived.output.path))
+                check_outputs.append(derived.output)
+
+            # Link probes using the stock template can be answered by the
+            # toolchain symbol index without linking.
+            if symbol_index and "symbol" in check and needs_toolchain:
+                use_symbol_index = True
+
+            # Lookup names resolve to the same file across one target, so the
+            # union over a batch is conflict free.
+            name_to_file.update(dep_files[check_name])
+
+        # One index serves every check of the action.
+        if use_symbol_index:
+            args.add("--symbol-index", symbol_index)
+            check_inputs.append(symbol_index)
+
+        # Per-check outputs, given in --check order. Flag batches have none.
+        if len(check_names) == 1:
+            for check_name in check_names:
+                if profile_prologues:
+                    prologue_profile = ctx.actions.declare_file("{}/{}.prologue.json".format(ctx.label.name, check_name))
+                    args.add("--prologue-profile", prologue_profile)
+                    check_outputs.append(prologue_profile)
+                    prologue_profiles.append(prologue_profile)
+                if config_log_enabled:
+                    config_log = ctx.actions.declare_file("{}/{}.config.log".format(ctx.label.name, check_name))
+                    args.add("--config-log", config_log)
+                    check_outputs.append(config_log)
+                    config_logs.append(config_log)
+                if record_probes:
+                    probe_record = ctx.actions.declare_file("{}/{}.probes.json".format(ctx.label.name, check_name))
+                    args.add("--probe-record", probe_record)
+                    check_outputs.append(probe_record)
+                    probe_records.append(probe_record)
+            if probe_socket:
+                args.add("--probe-socket", probe_socket)
+            if checker_jobs > 1:
+                args.add("--jobs", str(checker_jobs))
 
         # Add --dep arguments with explicit name=file format
         check_deps = []
@@ -351,14 +549,36 @@ def autoconf_impl_common(ctx, resolve_toolchain):
         ctx.actions.run(
             executable = ctx.executable._checker,
             arguments = [args],
-            inputs = depset(inputs + [check_json] + check_deps),
-            outputs = [check_result_file],
+            inputs = depset(inputs + check_inputs + check_deps),
+            outputs = check_outputs,
             mnemonic = "CcAutoconfCheck",
-            progress_message = "CcAutoconfCheck %{label} - " + check_name,
+            progress_message = "CcAutoconfCheck %{label} - " + progress_name,
             env = env | ctx.configuration.default_shell_env,
-            tools = toolchain_info.cc_toolchain.all_files,
+            tools = toolchain_info.cc_toolchain.all_files if needs_toolchain else [],
         )
 
+    output_groups = {}
+    if profile_prologues:
+        prologue_report = ctx.actions.declare_file("{}.prologue_report.json".format(ctx.label.name))
+        report_args = ctx.actions.args()
+        report_args.use_param_file("@%s", use_always = True)
+        report_args.set_param_file_format("multiline")
+        report_args.add("--prologue-report", prologue_report)
+        report_args.add_all(prologue_profiles, before_each = "--prologue-profile")
+        ctx.actions.run(
+            executable = ctx.executable._checker,
+            arguments = [report_args],
+            inputs = prologue_profiles,
+            outputs = [prologue_report],
+            mnemonic = "CcAutoconfPrologueReport",
+            progress_message = "CcAutoconfPrologueReport %{label}",
+        )
+        output_groups["autoconf_prologue_report"] = depset([prologue_report])
+    if config_log_enabled:
+        output_groups["autoconf_config_log"] = depset(config_logs)
+    if record_probes:
+        output_groups["autoconf_probe_records"] = depset(probe_records)
+
     # Return provider with result buckets and content cache for dedup
     return [
         CcAutoconfInfo(
@@ -373,6 +593,7 @@ def autoconf_impl_common(ctx, resolve_toolchain):
         OutputGroupInfo(
             autoconf_checks = depset([action.input for action in actions.values()]),
             autoconf_results = depset(cache_results.values() + define_results.values() + subst_results.values()),
+            **output_groups
         ),
     ]
 
@@ -393,6 +614,21 @@ COMMON_ATTRS = {
         executable = True,
         default = Label("//autoconf/private/checker:checker_bin"),
     ),
+    "_checker_jobs": attr.label(
+        default = Label("//autoconf:checker_jobs"),
+    ),
+    "_config_log": attr.label(
+        default = Label("//autoconf:config_log"),
+    ),
+    "_probe_socket": attr.label(
+        default = Label("//autoconf:probe_socket"),
+    ),
+    "_prologue_report": attr.label(
+        default = Label("//autoconf:prologue_report"),
+    ),
+    "_record_probes": attr.label(
+        default = Label("//autoconf:record_probes"),
+    ),
 }
 
 autoconf = rule(
@@ -424,6 +660,152 @@ autoconf(
 
 The results can then be used by `autoconf_hdr` or `autoconf_srcs` to generate headers
 or wrapped source files.
+
+Prologue report:
+
+To find the include sets that make probes slow, build with
+`--@rules_cc_autoconf//autoconf:prologue_report` and request the
+`autoconf_prologue_report` output group:
+
+```
+bazel build //my:config --@rules_cc_autoconf//autoconf:prologue_report --output_groups=+autoconf_prologue_report
+```
+
+Each check additionally compiles its probe syntax-only with an include trace
+(`-H`, or `/showIncludes` on MSVC) and preprocesses it once. The resulting
+`<name>.prologue_report.json` groups the checks of the target by the set of
+headers their probe includes and lists, for each group, the checks, the
+headers the probes include directly, the total number of headers, the
+preprocessed size and the frontend time, most expensive group first.
+Batched compiler flag checks are not profiled.
+
+Probe diagnostics:
+
+Compiler output of probes is captured and kept only for commands that fail.
+With `--@rules_cc_autoconf//autoconf:config_log`, each check action writes
+those commands, their output (bounded) and the probe source to
+`<name>/<cache variable>.config.log`, in the style of autoconf's
+`config.log`. Scratch paths in the commands are shown as `@SOURCE@` and
+`@OUTPUT@`, as in probe records. Request the `autoconf_config_log` output
+group to get them:
+
+```
+bazel build //my:config --@rules_cc_autoconf//autoconf:config_log --output_groups=+autoconf_config_log
+```
+
+Without the flag no log is declared, so the extra output does not cost every
+check action in a normal build.
+
+Batched compiler flag checks have no log.
+
+Debugging:
+
+The checker reads two environment variables, passed with `--action_env`
+(changing them re-runs the check actions):
+
+- `RULES_CC_AUTOCONF_DEBUG`: unset shows errors only, any value adds
+  warnings and info, `debug` (or `2`) adds every command and its output.
+- `RULES_CC_AUTOCONF_TRACE`: where events go, a comma separated list of
+  `text` (the default, on stdout/stderr), `jsonl:PATH` (one JSON object per
+  event, appended) and `events:PATH` (Chrome/Perfetto trace event format,
+  viewable in `chrome://tracing` or ui.perfetto.dev). Each process writes
+  its own events file, with its pid before the extension
+  (`/tmp/autoconf.json` becomes `/tmp/autoconf.1234.json`), so concurrent
+  actions do not overwrite each other. Timestamps are wall clock
+  microseconds, so the files of one build merge into a single timeline.
+
+```
+bazel build //my:config --action_env=RULES_CC_AUTOCONF_DEBUG=debug --action_env=RULES_CC_AUTOCONF_TRACE=events:/tmp/autoconf.json --sandbox_writable_path=/tmp
+```
+
+Probe replay:
+
+To see how a toolchain upgrade changes configure results and cost, build
+with `--@rules_cc_autoconf//autoconf:record_probes` and request the
+`autoconf_probe_records` output group:
+
+```
+bazel build //my:config --@rules_cc_autoconf//autoconf:record_probes --output_groups=+autoconf_probe_records
+```
+
+Each check action writes `<name>/<cache variable>.probes.json`: every probe
+it ran (compile, link, link with a library, or compile with flags), with the
+probe source, the commands (scratch paths replaced by `@SOURCE@` and
+`@OUTPUT@`), the outcome and the wall time. The checker replays such records
+outside of Bazel against the config JSON of another toolchain, a file like
+`{"c_compiler": "gcc-14", "c_flags": ["-O2"], ...}`:
+
+```
+checker_bin --config new_toolchain.json --replay-report replay.json --jobs 8 \
+    --probe-record bazel-bin/my/config/ac_cv_header_stdio_h.probes.json ...
+```
+
+`replay.json` lists the checks whose probes changed outcome and compares
+per-check and total latencies (total, median, 90th percentile, maximum).
+Batched compiler flag checks are not recorded.
+
+Probe coalescing:
+
+Targets that repeat the same probes (the same check in several packages or
+configurations of one workspace) can share them host-wide by pointing
+`--@rules_cc_autoconf//autoconf:probe_socket` at a unix socket:
+
+```
+bazel build //... --@rules_cc_autoconf//autoconf:probe_socket=/tmp/autoconf-probes.sock
+```
+
+The first checker action to use the socket starts a daemon on it, which exits
+after a minute without clients. Identical probes (the same compiler, flags and
+source) that are in flight at the same time run once, and at most one probe
+per CPU runs at a time host-wide. Outcomes are not kept after the probe
+finishes, so a probe is never answered from an earlier build whose headers or
+libraries may have changed. A check whose probe was answered by another
+action records a "coalesced probe" entry in its config.log instead of the
+compiler output, which is in the config.log of the action that ran it.
+Relative include paths name different files in different working
+directories, so only actions running in the same directory share probes:
+all of them with a non-sandboxed strategy, none across sandboxes.
+The daemon only coordinates; probes still run in the checker actions. The
+socket must be reachable from the actions, e.g. with
+`--sandbox_writable_path=/tmp` or a non-sandboxed strategy; when it is not,
+each action simply probes on its own. The daemon can also be started ahead of
+the build, to choose its concurrency:
+
+```
+bazel run @rules_cc_autoconf//autoconf/private/checker:checker_bin -- --probe-daemon /tmp/autoconf-probes.sock --probe-daemon-jobs 8
+```
+
+Probe concurrency:
+
+Checks that try several independent probes (the libraries of
+`AC_SEARCH_LIBS`) may run them concurrently; the answer is still the first
+library in order that links. The checker is a GNU make jobserver client:
+when `MAKEFLAGS` in the action environment names a jobserver
+(`--jobserver-auth=fifo:PATH`), every probe beyond the action's own takes a
+token from it, so all actions sharing the jobserver stay within its `-j`:
+
+```
+bazel build //... --action_env=MAKEFLAGS=--jobserver-auth=fifo:/tmp/autoconf-jobs --sandbox_writable_path=/tmp
+```
+
+The wrapper that creates the fifo fills it with one byte per extra job.
+Without a jobserver, a check runs at most
+`--@rules_cc_autoconf//autoconf:checker_jobs` probes at once (default 1,
+as Bazel already runs one action per core).
+
+Gated checks:
+
+A check action normally stages the whole toolchain, even when a `requires`
+entry turns out false and the check only writes an empty result. When that
+entry reads `AC_DEFINE`s of the same target that have no `requires` or
+condition of their own, its value is known at analysis time: the action
+then stages no toolchain and runs the checker with `--no-toolchain`, which
+fails rather than probe should the analysis be wrong. Only single tests
+(`"HAVE_X"`, `"!HAVE_X"`, `"REPLACE_X==1"`) are evaluated this way; a gate
+on a probed result, or on a dependency's result, still stages the toolchain,
+as Bazel cannot skip an action or stage its inputs lazily. The checker
+never reads the config for a closed gate either way. Checks that only
+evaluate a `condition` never probe and stage no toolchain.
 """,
     attrs = COMMON_ATTRS,
     fragments = ["cpp"],
@@ -20,8 +20,10 @@ KNOWN_CHECK_FIELDS = {
     "libraries": "list[str]: Library names to search in order (for search_libs).",
     "library": "str: Single library name to link against (for AC_CHECK_LIB).",
     "name": "str: Cache variable name (e.g. 'ac_cv_header_stdio_h').",
+    "outputs": "(list[dict]): Define/subst checks derived from this check's result and written by the same checker run.",
     "requires": "(list[str]): Requirements that must be truthy for the check to run.",
     "subst": "(str | bool | None): Substitution variable name for `@VAR@` replacement, or True to use the cache variable name.",
+    "symbol": "str: Linker symbol probed by the stock function/search_libs template (enables the toolchain symbol index).",
     "type": "str: Check type (compile, link, function, type, sizeof, alignof, etc.).",
     "unquote": "bool: If true, emit the define with unquoted (AC_DEFINE_UNQUOTED) style.",
 }
@@ -72,6 +74,39 @@ def make_check(check):
     """
     return json.encode(check)
 
+def _validate_output(name, output):
+    """Fail if a derived output of check `name` is not a define/subst check."""
+    if output.get("type") not in ("define", "m4_variable", "subst"):
+        fail("Output '{}' of check '{}' must be an AC_DEFINE or AC_SUBST.".format(output.get("name"), name))
+    if "outputs" in output:
+        fail("Output '{}' of check '{}' cannot have outputs of its own.".format(output.get("name"), name))
+
+def add_outputs(check, outputs):
+    """Attach derived outputs to a check.
+
+    Outputs are `AC_DEFINE` / `AC_SUBST` checks, usually with a `condition`
+    on the result of `check`, that run no probe of their own. Instead of one checker
+    action per output, the action running `check` writes their results too.
+    Outputs whose result is already available from a dependency or the
+    toolchain are skipped by that action.
+
+    Args:
+        check: A JSON-encoded check.
+        outputs: JSON-encoded define/subst checks derived from `check`.
+
+    Returns:
+        A JSON-encoded check string suitable for the autoconf rule's checks attr.
+    """
+    primary = json.decode(check)
+    derived = primary.get("outputs", [])
+    for output_json in outputs:
+        output = json.decode(output_json)
+        _validate_output(primary["name"], output)
+        derived.append(output)
+    if derived:
+        primary["outputs"] = derived
+    return make_check(primary)
+
 def _autoconf_check_init(
         type,
         name,
@@ -88,8 +123,10 @@ def _autoconf_check_init(
         language = None,
         libraries = None,
         library = None,
+        outputs = None,
         requires = None,
         subst = None,
+        symbol = None,
         unquote = None):
     """Validate and construct an AutoconfCheck provider instance.
 
@@ -110,6 +147,9 @@ def _autoconf_check_init(
     _validate_list_field("input_deps", input_deps)
     _validate_list_field("requires", requires)
     _validate_list_field("libraries", libraries)
+    _validate_list_field("outputs", outputs)
+    for output in outputs or []:
+        _validate_output(name, output)
 
     return {
         "code": code,
@@ -126,8 +166,10 @@ def _autoconf_check_init(
         "libraries": libraries,
         "library": library,
         "name": name,
+        "outputs": outputs,
         "requires": requires,
         "subst": subst,
+        "symbol": symbol,
         "type": type,
         "unquote": unquote,
     }
@@ -1,6 +1,5 @@
 #include "autoconf/private/checker/check.h"
 
-#include "autoconf/private/checker/debug_logger.h"
 #include "tools/json/json.h"
 
 namespace rules_cc_autoconf {
@@ -183,6 +182,14 @@ std::optional<Check> Check::from_json(const void* json_data) {
         check.library_ = json["library"].get<std::string>();
     }
 
+    if (json.contains("flag") && json["flag"].is_string()) {
+        check.flag_ = json["flag"].get<std::string>();
+    }
+
+    if (json.contains("symbol") && json["symbol"].is_string()) {
+        check.symbol_ = json["symbol"].get<std::string>();
+    }
+
     if (json.contains("libraries") && json["libraries"].is_array()) {
         std::vector<std::string> libs_list;
         for (const nlohmann::json& lib : json["libraries"]) {
@@ -229,6 +236,22 @@ std::optional<Check> Check::from_json(const void* json_data) {
         check.unquote_ = json["unquote"].get<bool>();
     }
 
+    // Parse derived outputs; each is a define/subst check of its own
+    if (json.contains("outputs") && json["outputs"].is_array()) {
+        for (const nlohmann::json& output_json : json["outputs"]) {
+            std::optional<Check> output = Check::from_json(&output_json);
+            if ((output->type() != CheckType::kDefine &&
+                 output->type() != CheckType::kM4Variable) ||
+                !output->outputs().empty()) {
+                throw std::runtime_error(
+                    "Output '" + output->name() + "' of check '" +
+                    check.name() +
+                    "' must be a define/subst check without outputs");
+            }
+            check.outputs_.push_back(std::move(*output));
+        }
+    }
+
     // Validate structure: some check types require code (or code/file_path).
     // This keeps parsing strict so runtime failures are not silent/misleading.
     switch (type) {
@@ -115,6 +115,20 @@ class Check {
      */
     const std::optional<std::string>& library() const { return library_; }
 
+    /**
+     * @brief Get the compiler flag tested by a compiler-flag check.
+     * @return The flag (e.g. "-Wall"), or std::nullopt for other checks.
+     */
+    const std::optional<std::string>& flag() const { return flag_; }
+
+    /**
+     * @brief Get the linker symbol probed by a function/lib/search_libs check.
+     * @return The symbol name when the check uses the stock link template
+     * (so the result depends only on whether the symbol resolves), or
+     * std::nullopt for custom code.
+     */
+    const std::optional<std::string>& symbol() const { return symbol_; }
+
     /**
      * @brief Get the optional list of library names for AC_SEARCH_LIBS.
      * @return Optional vector of library names (without -l prefix) to try,
@@ -163,6 +177,17 @@ class Check {
      */
     bool unquote() const { return unquote_; }
 
+    /**
+     * @brief Get the derived outputs of this check.
+     *
+     * Each output is a define/subst check, usually conditional, evaluated
+     * against this check's result by the same checker run instead of by a
+     * separate action that re-reads it.
+     *
+     * @return The outputs, in declaration order (empty for most checks).
+     */
+    const std::vector<Check>& outputs() const { return outputs_; }
+
    private:
     std::string name_{};                   /// Name (e.g., header/function name)
     std::optional<std::string> define_{};  /// Optional preprocessor define name
@@ -171,6 +196,8 @@ class Check {
     std::optional<std::string> define_value_{};  /// Value if check succeeds
     std::optional<std::string> define_value_fail_{};  /// Value if check fails
     std::optional<std::string> library_{};  /// Library name for lib checks
+    std::optional<std::string> symbol_{};   /// Symbol probed by link checks
+    std::optional<std::string> flag_{};     /// Flag tested by flag checks
     std::optional<std::vector<std::string>>
         libraries_{};  /// Library names for search_libs checks
     std::optional<std::vector<std::string>> requires_{};  /// Required defines
@@ -183,6 +210,7 @@ class Check {
         subst_{};          /// Optional substitution variable name
     bool unquote_{false};  /// Whether this is AC_DEFINE_UNQUOTED (affects empty
                            /// value rendering)
+    std::vector<Check> outputs_{};  /// Derived define/subst outputs
 
     /**
      * @brief Private constructor (use from_json to create).
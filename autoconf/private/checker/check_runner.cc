@@ -1,17 +1,21 @@
 #include "autoconf/private/checker/check_runner.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
+#include <map>
 #include <iostream>
+#include <limits>
 #include <nlohmann/json.hpp>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
 
 #include "autoconf/private/checker/check.h"
-#include "autoconf/private/checker/debug_logger.h"
+#include "autoconf/private/checker/compiler_flags.h"
 #include "autoconf/private/checker/system_header.h"
+#include "autoconf/private/common/trace.h"
 
 namespace rules_cc_autoconf {
 
@@ -27,6 +31,45 @@ std::string check_id(const Check& check) {
     return check.define().has_value() ? *check.define() : check.name();
 }
 
+/**
+ * @brief Build the result of a compile check from its outcome, honouring
+ * define_value / define_value_fail.
+ */
+CheckResult compile_check_result(const Check& check, bool success) {
+    std::optional<std::string> value;
+    bool should_output = true;
+    if (check.define_value().has_value()) {
+        value = success ? *check.define_value()
+                        : (check.define_value_fail().has_value()
+                               ? *check.define_value_fail()
+                               : std::string("0"));
+    } else {
+        // define_value is not set
+        if (success) {
+            // Check succeeded - if define_value_fail is set, it means we only
+            // want to define on failure So don't output when success is true
+            if (check.define_value_fail().has_value()) {
+                should_output = false;
+                value = std::nullopt;
+            } else {
+                // Neither define_value nor define_value_fail is set - use
+                // default "1"
+                value = std::string("1");
+            }
+        } else {
+            // Check failed - use define_value_fail if set, otherwise "0"
+            value = check.define_value_fail().has_value()
+                        ? std::optional<std::string>(*check.define_value_fail())
+                        : std::optional<std::string>("0");
+        }
+    }
+
+    return CheckResult(check.name(), value, should_output ? success : false,
+                       check_type_is_define(check.type()),
+                       check.subst().has_value(), check.type(), check.define(),
+                       check.subst());
+}
+
 }  // namespace
 
 CheckRunner::CheckRunner(const Config& config) : config_(config) {}
@@ -44,6 +87,8 @@ void CheckRunner::set_dep_results(
 void CheckRunner::set_source_id(const std::string& source_id,
                                 const std::filesystem::path& source_dir) {
     source_dir_ = std::filesystem::path(source_dir).make_preferred();
+    scratch_.reset();
+    const std::filesystem::path& scratch_dir = scratch().dir();
 #ifdef _WIN32
     // External tools (cl.exe, link.exe) cannot handle paths longer than
     // MAX_PATH (260 characters). When the cache variable name is very long
@@ -53,13 +98,13 @@ void CheckRunner::set_source_id(const std::string& source_id,
     // The length check must use the absolute path because Bazel actions run
     // from an execroot (e.g. D:/_bazel/execroot/_main/) that adds significant
     // length to what appears to be a short relative path.
-    auto abs_test = std::filesystem::absolute(source_dir_ / (source_id + ".c"));
+    auto abs_test = std::filesystem::absolute(scratch_dir / (source_id + ".c"));
     if (abs_test.string().size() > 240) {
         size_t hash = std::hash<std::string>{}(source_id);
         std::ostringstream oss;
         oss << std::hex << hash;
         std::string hash_str = oss.str();
-        auto abs_dir = std::filesystem::absolute(source_dir_);
+        auto abs_dir = std::filesystem::absolute(scratch_dir);
         size_t dir_len = abs_dir.string().size() + 1;
         size_t max_id_len = 240 - dir_len - hash_str.size() - 4;
         source_id_ = source_id.substr(0, max_id_len) + "_" + hash_str;
@@ -67,10 +112,107 @@ void CheckRunner::set_source_id(const std::string& source_id,
         source_id_ = source_id;
     }
 #else
+    (void)scratch_dir;
     source_id_ = source_id;
 #endif
 }
 
+ScratchSpace& CheckRunner::scratch() {
+    if (!scratch_) {
+        ScratchBackend backend = scratch_backend_from_env();
+        bool msvc = config_.compiler_type.rfind("msvc", 0) == 0;
+        if (msvc && backend == ScratchBackend::kMemfd) {
+            // cl.exe infers the language from the file extension and cannot
+            // read /proc/self/fd paths.
+            backend = ScratchBackend::kTmpDir;
+        }
+        scratch_ = std::make_unique<ScratchSpace>(backend, source_dir_);
+    }
+    return *scratch_;
+}
+
+void CheckRunner::set_symbol_index(const SymbolIndex* index) {
+    symbol_index_ = index;
+}
+
+void CheckRunner::set_probe_coalescer(ProbeCoalescer* coalescer) {
+    probe_coalescer_ = coalescer;
+}
+
+void CheckRunner::set_job_server(JobServer* job_server) {
+    job_server_ = job_server;
+}
+
+void CheckRunner::set_probe_log(ProbeLog* log) {
+    probe_log_ = log;
+}
+
+void CheckRunner::set_probe_recorder(ProbeRecorder* recorder) {
+    probe_recorder_ = recorder;
+}
+
+void CheckRunner::set_profile_prologue(bool enabled) {
+    profile_prologue_ = enabled;
+    prologue_profile_.reset();
+}
+
+const std::optional<PrologueProfile>& CheckRunner::prologue_profile() const {
+    return prologue_profile_;
+}
+
+bool CheckRunner::symbol_index_resolves(const Check& check,
+                                        const std::string& library) const {
+    if (symbol_index_ == nullptr || !check.symbol().has_value()) {
+        return false;
+    }
+    const std::string& symbol = *check.symbol();
+    // compile_defines are emitted ahead of the probe; one named after the
+    // symbol would rename the call and change what gets linked.
+    if (check.compile_defines().has_value()) {
+        for (const std::string& define_name : *check.compile_defines()) {
+            if (define_name == symbol) {
+                return false;
+            }
+        }
+    }
+    if (!symbol_index_->contains(library, symbol)) {
+        return false;
+    }
+    AUTOCONF_TRACE_DEBUG("Symbol index: found, skipping link",
+                         {"symbol", symbol}, {"library", library});
+    return true;
+}
+
+SymbolIndex CheckRunner::build_symbol_index() {
+    SymbolIndex index;
+    if (config_.compiler_type.rfind("msvc", 0) == 0) {
+        AUTOCONF_TRACE_DEBUG("Symbol index: MSVC toolchains are not indexed");
+        return index;
+    }
+
+    for (const std::string& language : {std::string("c"), std::string("cpp")}) {
+        std::optional<std::string> trace = link_trace(language);
+        if (!trace.has_value()) {
+            AUTOCONF_TRACE_WARN(
+                "Symbol index: link trace failed, default libraries are not "
+                "indexed",
+                {"language", language});
+            continue;
+        }
+        const std::string library = SymbolIndex::default_library(language);
+        for (const std::filesystem::path& file : parse_link_trace(*trace)) {
+            if (!index.add_file(library, file)) {
+                AUTOCONF_TRACE_DEBUG("Symbol index: skipped", {"file", file});
+            }
+        }
+    }
+
+    AUTOCONF_TRACE_DEBUG("Symbol index: built",
+                         {"libraries", index.library_count()},
+                         {"symbols", index.entry_count()});
+    return index;
+}
+
 std::string CheckRunner::get_defines_from_previous_checks() const {
     std::ostringstream defines;
     // Collect all successful AC_DEFINE checks (type "define") from previous
@@ -141,7 +283,8 @@ std::string CheckRunner::resolve_compile_defines(const Check& check) const {
 }
 
 CheckResult CheckRunner::run_check(const Check& check) {
-    DebugLogger::debug("Running check for " + check_id(check));
+    AUTOCONF_TRACE_DEBUG("Running check", {"check", check_id(check)},
+                         {"type", check_type_to_string(check.type())});
     switch (check.type()) {
         case CheckType::kFunction:
             return check_function(check);
@@ -209,8 +352,12 @@ CheckResult CheckRunner::check_function(const Check& check) {
 
     // AC_CHECK_FUNC should use linking (not just compilation) to match GNU
     // Autoconf behavior This ensures functions that exist but aren't declared
-    // in headers are detected
-    bool success = try_compile_and_link(code, check.language());
+    // in headers are detected. A symbol index hit proves the link would
+    // succeed, so only misses pay for the link.
+    bool success =
+        symbol_index_resolves(
+            check, SymbolIndex::default_library(check.language())) ||
+        try_compile_and_link(code, check.language());
     return CheckResult(check.name(), success ? "1" : "0", success,
                        check_type_is_define(check.type()),
                        check.subst().has_value(), check.type(), check.define(),
@@ -233,6 +380,8 @@ CheckResult CheckRunner::check_lib(const Check& check) {
     }
     code = *check.code();
 
+    // Always links: `-l<library>` may pull in dependencies that do not
+    // resolve, which the symbol index cannot see.
     bool success =
         try_compile_and_link_with_lib(code, library, check.language());
     return CheckResult(check.name(), success ? "1" : "0", success,
@@ -279,40 +428,126 @@ CheckResult CheckRunner::check_compile(const Check& check) {
         code = defines_code + code;
     }
 
-    bool success = try_compile(code, check.language());
+    bool success =
+        check.flag().has_value()
+            ? test_compiler_flags({*check.flag()}, code, check.language())[0]
+            : try_compile(code, check.language());
+    return compile_check_result(check, success);
+}
 
-    std::optional<std::string> value;
-    bool should_output = true;
-    if (check.define_value().has_value()) {
-        value = success ? *check.define_value()
-                        : (check.define_value_fail().has_value()
-                               ? *check.define_value_fail()
-                               : std::string("0"));
-    } else {
-        // define_value is not set
-        if (success) {
-            // Check succeeded - if define_value_fail is set, it means we only
-            // want to define on failure So don't output when success is true
-            if (check.define_value_fail().has_value()) {
-                should_output = false;
-                value = std::nullopt;
-            } else {
-                // Neither define_value nor define_value_fail is set - use
-                // default "1"
-                value = std::string("1");
+std::vector<bool> CheckRunner::test_compiler_flags(
+    const std::vector<std::string>& flags, const std::string& code,
+    const std::string& language) {
+    std::vector<bool> accepted(flags.size(), false);
+    size_t compiles = 0;
+
+    // Each pending group is compiled as a whole. Flags the diagnostics reject
+    // are dropped and the rest of the group retried; flags they only cast
+    // doubt on are compiled on their own, where the exit status decides. A
+    // failure nothing is blamed for is split in half until it is down to a
+    // single flag.
+    std::vector<std::vector<size_t>> pending = {{}};
+    for (size_t i = 0; i < flags.size(); ++i) pending.front().push_back(i);
+    while (!pending.empty()) {
+        std::vector<size_t> group = std::move(pending.back());
+        pending.pop_back();
+        if (group.empty()) continue;
+
+        std::vector<std::string> group_flags;
+        for (size_t i : group) group_flags.push_back(flags[i]);
+        std::string output;
+        bool success =
+            try_compile_with_flags(code, language, group_flags, output);
+        ++compiles;
+
+        FlagDiagnostics diagnostics = find_rejected_flags(output, group_flags);
+        const std::vector<size_t>& rejected = diagnostics.rejected;
+        const std::vector<size_t>& suspected = diagnostics.suspected;
+        if (!rejected.empty()) {
+            std::vector<size_t> rest;
+            for (size_t j = 0, r = 0; j < group.size(); ++j) {
+                if (r < rejected.size() && rejected[r] == j) {
+                    AUTOCONF_TRACE_DEBUG("Compiler rejected flag",
+                                         {"flag", flags[group[j]]});
+                    ++r;
+                } else {
+                    rest.push_back(group[j]);
+                }
             }
+            pending.push_back(std::move(rest));
+        } else if (!suspected.empty() && group.size() > 1) {
+            std::vector<size_t> rest;
+            for (size_t j = 0, s = 0; j < group.size(); ++j) {
+                if (s < suspected.size() && suspected[s] == j) {
+                    pending.push_back({group[j]});
+                    ++s;
+                } else {
+                    rest.push_back(group[j]);
+                }
+            }
+            pending.push_back(std::move(rest));
+        } else if (success) {
+            for (size_t i : group) accepted[i] = true;
+        } else if (group.size() > 1) {
+            size_t half = group.size() / 2;
+            pending.emplace_back(group.begin() + half, group.end());
+            pending.emplace_back(group.begin(), group.begin() + half);
         } else {
-            // Check failed - use define_value_fail if set, otherwise "0"
-            value = check.define_value_fail().has_value()
-                        ? std::optional<std::string>(*check.define_value_fail())
-                        : std::optional<std::string>("0");
+            AUTOCONF_TRACE_DEBUG("Compile failed with flag",
+                                 {"flag", flags[group[0]]},
+                                 {"output", output});
         }
     }
 
-    return CheckResult(check.name(), value, should_output ? success : false,
-                       check_type_is_define(check.type()),
-                       check.subst().has_value(), check.type(), check.define(),
-                       check.subst());
+    AUTOCONF_TRACE_DEBUG("Tested compiler flags", {"flags", flags.size()},
+                         {"compiles", compiles});
+    return accepted;
+}
+
+std::vector<CheckResult> CheckRunner::run_flag_checks(
+    const std::vector<const Check*>& checks) {
+    // Checks only share a compile when both the language and the test
+    // program (including resolved compile_defines) match.
+    std::map<std::pair<std::string, std::string>, std::vector<size_t>> groups;
+    for (size_t i = 0; i < checks.size(); ++i) {
+        const Check& check = *checks[i];
+        if (check.type() != CheckType::kCompile || !check.flag().has_value()) {
+            throw std::runtime_error("Not a compiler flag check: " +
+                                     check_id(check));
+        }
+        std::string code = check.code().has_value()
+                               ? *check.code()
+                               : "int main(void) { return 0; }";
+        code = resolve_compile_defines(check) + code;
+        groups[{check.language(), code}].push_back(i);
+    }
+
+    std::vector<std::optional<bool>> success(checks.size());
+    for (const auto& [key, members] : groups) {
+        std::vector<std::string> flags;
+        std::map<std::string, size_t> flag_index;
+        for (size_t i : members) {
+            const std::string& flag = *checks[i]->flag();
+            if (flag_index.emplace(flag, flags.size()).second) {
+                flags.push_back(flag);
+            }
+        }
+        std::vector<bool> accepted =
+            test_compiler_flags(flags, key.second, key.first);
+        for (size_t i : members) {
+            success[i] = accepted[flag_index.at(*checks[i]->flag())];
+        }
+    }
+
+    std::vector<CheckResult> results;
+    results.reserve(checks.size());
+    for (size_t i = 0; i < checks.size(); ++i) {
+        const Check& check = *checks[i];
+        AUTOCONF_TRACE_DEBUG("Running check", {"check", check_id(check)},
+                             {"type", check_type_to_string(check.type())});
+        results.push_back(compile_check_result(check, *success[i]));
+    }
+    return results;
 }
 
 CheckResult CheckRunner::check_link(const Check& check) {
@@ -431,7 +666,7 @@ CheckResult CheckRunner::check_alignof(const Check& check) {
 CheckResult CheckRunner::check_compute_int(const Check& check) {
     std::string id = check_id(check);
     if (!check.code().has_value()) {
-        DebugLogger::warn("compute_int check missing code");
+        AUTOCONF_TRACE_WARN("compute_int check missing code", {"check", id});
         return CheckResult(id, "0", false, check_type_is_define(check.type()),
                            check.subst().has_value(), check.type());
     }
@@ -528,7 +763,7 @@ CheckResult CheckRunner::check_gl_next_header(const Check& check) {
     }
 
     std::string header = *check.code();
-    DebugLogger::debug("GL_NEXT_HEADER: resolving " + header);
+    AUTOCONF_TRACE_DEBUG("GL_NEXT_HEADER: resolving", {"header", header});
 
     // Look up INCLUDE_NEXT from dependency results to determine strategy
     auto it = dep_results_.find("INCLUDE_NEXT");
@@ -539,8 +774,8 @@ CheckResult CheckRunner::check_gl_next_header(const Check& check) {
     if (have_include_next) {
         // GCC/Clang: #include_next is supported, use angle-bracket include
         std::string value = "<" + header + ">";
-        DebugLogger::debug("GL_NEXT_HEADER: include_next supported, value=" +
-                           value);
+        AUTOCONF_TRACE_DEBUG("GL_NEXT_HEADER: include_next supported",
+                             {"value", value});
         return CheckResult(check.name(), value, true, false, true, check.type(),
                            check.define(), check.subst());
     }
@@ -557,7 +792,7 @@ CheckResult CheckRunner::check_gl_next_header(const Check& check) {
 
     auto sys_path =
         find_system_header_path(compiler, flags, config_.compiler_type, header,
-                                source_id_, source_dir_);
+                                source_id_, scratch());
 
     bool msvc = config_.compiler_type.rfind("msvc", 0) == 0;
 
@@ -568,17 +803,16 @@ CheckResult CheckRunner::check_gl_next_header(const Check& check) {
         // directive.  Headers absent from the platform are guarded by `#if 0`
         // in gnulib templates.
         std::string value = msvc ? "" : "<" + header + ">";
-        DebugLogger::debug("GL_NEXT_HEADER: system header not found for " +
-                           header + ", returning " +
-                           (value.empty() ? "empty" : value));
+        AUTOCONF_TRACE_DEBUG("GL_NEXT_HEADER: system header not found",
+                             {"header", header}, {"value", value});
         return CheckResult(check.name(), value, true, false, true, check.type(),
                            check.define(), check.subst());
     }
 
     auto content = read_file_content(*sys_path);
     if (!content.has_value()) {
-        DebugLogger::warn("GL_NEXT_HEADER: could not read system header at " +
-                          sys_path->string());
+        AUTOCONF_TRACE_WARN("GL_NEXT_HEADER: could not read system header",
+                            {"path", *sys_path});
         std::string value = msvc ? "" : "<" + header + ">";
         return CheckResult(check.name(), value, true, false, true, check.type(),
                            check.define(), check.subst());
@@ -622,33 +856,80 @@ CheckResult CheckRunner::check_gl_next_header(const Check& check) {
     // Prepend a newline so the template's `# @INCLUDE_NEXT@ @NEXT_*@` becomes
     // `# ` (null directive) followed by the inlined content on the next line
     std::string value = "\n" + *content;
-    DebugLogger::debug("GL_NEXT_HEADER: inlined " +
-                       std::to_string(content->size()) + " bytes from " +
-                       sys_path->string());
+    AUTOCONF_TRACE_DEBUG("GL_NEXT_HEADER: inlined", {"path", *sys_path},
+                         {"bytes", content->size()});
     return CheckResult(check.name(), value, true, false, true, check.type(),
                        check.define(), check.subst());
 }
 
+/**
+ * @brief Turn the `== {value}` test of a value template into another one.
+ * @param base_code_template Code template comparing against `== {value}`.
+ * @param comparison Replacement for every `== {value}`, e.g. `<= 8`.
+ * @return The code to compile.
+ */
+static std::string gen_value_compare(const std::string& base_code_template,
+                                     const std::string& comparison) {
+    static const std::string kEquals = "== {value}";
+    std::string code = base_code_template;
+    bool found = false;
+    for (size_t pos = code.find(kEquals); pos != std::string::npos;
+         pos = code.find(kEquals, pos)) {
+        code.replace(pos, kEquals.length(), comparison);
+        pos += comparison.length();
+        found = true;
+    }
+    if (!found) {
+        throw std::runtime_error(
+            "Code template must contain '== {value}' for static_assert "
+            "checks");
+    }
+    return code;
+}
+
 std::optional<int> CheckRunner::find_compile_time_value_with_static_assert(
     const std::string& base_code_template, const std::string& language) {
-    std::vector<int> values_to_try = {1,  2,   4,   8,   16,  32,
-                                      64, 128, 256, 512, 1024};
-
-    for (int value : values_to_try) {
-        std::string code = base_code_template;
-        std::string value_str = std::to_string(value);
-        size_t pos = 0;
-        while ((pos = code.find("{value}", pos)) != std::string::npos) {
-            code.replace(pos, 7, value_str);
-            pos += value_str.length();
-        }
+    auto at_most = [&](int value) {
+        return try_compile(
+            gen_value_compare(base_code_template,
+                              "<= " + std::to_string(value)),
+            language);
+    };
+
+    // Only sizeof and alignof checks search for a value. Neither value is
+    // ever 0, so this only fails when the type (or an include) is missing.
+    if (!try_compile(gen_value_compare(base_code_template, "!= 0"),
+                     language)) {
+        return std::nullopt;
+    }
 
-        if (try_compile(code, language)) {
-            return value;
+    // Gallop: lo < value <= hi once `value <= hi` compiles.
+    int lo = 0;
+    int hi = 1;
+    while (!at_most(hi)) {
+        if (hi > std::numeric_limits<int>::max() / 2) {
+            return std::nullopt;
         }
+        lo = hi;
+        hi *= 2;
     }
 
-    return std::nullopt;
+    // Sizes are mostly powers of two, so try `hi` itself first.
+    if (hi - lo > 1) {
+        if (!at_most(hi - 1)) {
+            return hi;
+        }
+        --hi;
+    }
+    while (hi - lo > 1) {
+        int middle = lo + (hi - lo) / 2;
+        if (at_most(middle)) {
+            hi = middle;
+        } else {
+            lo = middle;
+        }
+    }
+    return hi;
 }
 
 static std::string gen_less_compare(const std::string& base_code_template,
@@ -802,28 +1083,37 @@ CheckResult CheckRunner::check_search_libs(const Check& check) {
     // - "-l<lib>" if function was found in a library
     // - "" (empty) if function was not found (success=false)
 
-    if (try_compile_and_link(code, check.language())) {
-        DebugLogger::debug("search_libs: " + check.name() +
-                           " found without extra library");
+    if (symbol_index_resolves(
+            check, SymbolIndex::default_library(check.language())) ||
+        try_compile_and_link(code, check.language())) {
+        AUTOCONF_TRACE_DEBUG("search_libs: found without extra library",
+                             {"check", check.name()});
         return CheckResult(check.name(), std::string(""), true,
                            check_type_is_define(check.type()),
                            check.subst().has_value(), check.type(),
                            check.define(), check.subst());
     }
 
+    std::vector<std::function<bool()>> probes;
     for (const auto& lib : libs) {
-        DebugLogger::debug("search_libs: " + check.name() + " trying -l" + lib);
-        if (try_compile_and_link_with_lib(code, lib, check.language())) {
-            DebugLogger::debug("search_libs: " + check.name() + " found in -l" +
-                               lib);
-            return CheckResult(check.name(), "-l" + lib, true,
-                               check_type_is_define(check.type()),
-                               check.subst().has_value(), check.type(),
-                               check.define(), check.subst());
-        }
+        probes.push_back([&, lib]() {
+            AUTOCONF_TRACE_DEBUG("search_libs: trying", {"check", check.name()},
+                                 {"library", lib});
+            return try_compile_and_link_with_lib(code, lib, check.language());
+        });
+    }
+    std::optional<size_t> found = first_success(probes);
+    if (found.has_value()) {
+        const std::string& lib = libs[*found];
+        AUTOCONF_TRACE_DEBUG("search_libs: found", {"check", check.name()},
+                             {"library", lib});
+        return CheckResult(check.name(), "-l" + lib, true,
+                           check_type_is_define(check.type()),
+                           check.subst().has_value(), check.type(),
+                           check.define(), check.subst());
     }
 
-    DebugLogger::debug("search_libs: " + check.name() + " not found");
+    AUTOCONF_TRACE_DEBUG("search_libs: not found", {"check", check.name()});
     return CheckResult(check.name(), std::string(""), false,
                        check_type_is_define(check.type()),
                        check.subst().has_value(), check.type(), check.define(),
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -9,6 +11,13 @@
 #include "autoconf/private/checker/check.h"
 #include "autoconf/private/checker/check_result.h"
 #include "autoconf/private/checker/config.h"
+#include "autoconf/private/checker/jobserver.h"
+#include "autoconf/private/checker/probe_coalescer.h"
+#include "autoconf/private/checker/probe_log.h"
+#include "autoconf/private/checker/probe_record.h"
+#include "autoconf/private/checker/prologue_profile.h"
+#include "autoconf/private/checker/scratch_space.h"
+#include "autoconf/private/checker/symbol_index.h"
 
 namespace rules_cc_autoconf {
 
@@ -34,6 +43,18 @@ class CheckRunner {
      */
     CheckResult run_check(const Check& check);
 
+    /**
+     * @brief Run several compiler flag checks (`check.flag()` set) together.
+     *
+     * Checks sharing a language and test program are answered by a single
+     * batched compile (see test_compiler_flags()).
+     *
+     * @param checks Compile checks that carry a flag.
+     * @return Results, parallel to `checks`.
+     */
+    std::vector<CheckResult> run_flag_checks(
+        const std::vector<const Check*>& checks);
+
     /**
      * @brief Set defines from required checks (dependencies).
      * @param required_defines Map of define names to their values from required
@@ -54,18 +75,101 @@ class CheckRunner {
      * path.
      *
      * The source_id is used as the base name for generated conftest source
-     * files. The source_dir controls where those files are written (next to
-     * the check JSON file). Typically derived from the check JSON path by
-     * replacing ".json" with ".conftest", producing filenames like
-     * "ac_cv_header_stdio_h.check.conftest.c" in the same directory.
+     * files. Typically derived from the check JSON path by replacing ".json"
+     * with ".conftest", producing filenames like
+     * "ac_cv_header_stdio_h.check.conftest.c". Those files are written to the
+     * scratch space selected by RULES_CC_AUTOCONF_SCRATCH; source_dir is only
+     * used when that is "output".
      *
      * @param source_id The identifier to use for source file naming.
-     * @param source_dir The directory where source files should be written
-     *                   (parent of the check JSON file).
+     * @param source_dir The directory of the check JSON file (output tree).
      */
     void set_source_id(const std::string& source_id,
                        const std::filesystem::path& source_dir);
 
+    /**
+     * @brief Set the toolchain symbol index consulted by function, lib and
+     * search_libs checks before linking.
+     * @param index The index, or nullptr to always link. Must outlive the
+     *              runner.
+     */
+    void set_symbol_index(const SymbolIndex* index);
+
+    /**
+     * @brief Profile the prologue of the first probe this runner compiles.
+     *
+     * The probe is additionally compiled syntax-only with an include trace
+     * (`-H`, or `/showIncludes` on MSVC) and preprocessed (`-E`/`/EP`), so
+     * this is only meant for diagnostics.
+     *
+     * @param enabled Whether to profile.
+     */
+    void set_profile_prologue(bool enabled);
+
+    /**
+     * @brief The profile recorded since set_profile_prologue(true).
+     * @return The profile, or std::nullopt if nothing was compiled.
+     */
+    const std::optional<PrologueProfile>& prologue_profile() const;
+
+    /**
+     * @brief Coalesce compile and link probes through `coalescer`.
+     *
+     * Identical probes (same commands up to scratch paths, same source) are
+     * then run once per process, and once host-wide when the coalescer has a
+     * daemon socket.
+     *
+     * @param coalescer The coalescer, or nullptr to run every probe. Must
+     *                  outlive the runner.
+     */
+    void set_probe_coalescer(ProbeCoalescer* coalescer);
+
+    /**
+     * @brief Bound the probes a check may run concurrently.
+     *
+     * Checks that try several independent probes (e.g. the libraries of a
+     * search_libs check) run them concurrently, one job slot each.
+     *
+     * @param job_server The job server, or nullptr to probe sequentially.
+     *                   Must outlive the runner.
+     */
+    void set_job_server(JobServer* job_server);
+
+    /**
+     * @brief Record failed probe commands, with their output, in `log`.
+     * @param log The log, or nullptr to discard probe output. Must outlive
+     *            the runner.
+     */
+    void set_probe_log(ProbeLog* log);
+
+    /**
+     * @brief Record every probe, with its outcome and duration, in
+     * `recorder`.
+     * @param recorder The recorder, or nullptr to record nothing. Must
+     *                 outlive the runner.
+     */
+    void set_probe_recorder(ProbeRecorder* recorder);
+
+    /**
+     * @brief Run a recorded probe again with this runner's configuration.
+     * @param record The probe; its outcome and commands are ignored.
+     * @return Whether the probe succeeded.
+     */
+    bool replay_probe(const ProbeRecord& record);
+
+    /**
+     * @brief Build the symbol index for the configured toolchain.
+     *
+     * Indexes the libraries a default C and C++ link pulls in (taken from a
+     * linker `-t` trace) and every `-l<name>` resolvable on the compiler's
+     * library search path. Toolchains the index cannot describe (MSVC,
+     * non-ELF targets) yield an empty index, which never short-circuits a
+     * check.
+     *
+     * @return The index.
+     */
+    SymbolIndex build_symbol_index();
+
     // Deleted copy and move assignment operators (const reference member)
     CheckRunner& operator=(const CheckRunner&) = delete;
     CheckRunner& operator=(CheckRunner&&) = delete;
@@ -81,9 +185,36 @@ class CheckRunner {
     ///< Source file identifier derived from check JSON filename, used as the
     ///< base name for conftest source files to ensure global uniqueness
     std::string source_id_;
-    ///< Directory where conftest source files are written (next to the check
-    ///< JSON file), provided by Bazel via the check path
+    ///< Directory of the check JSON file, provided by Bazel via the check
+    ///< path. Only written to when the "output" scratch backend is selected.
     std::filesystem::path source_dir_;
+    ///< Scratch space for conftest artifacts, created on first use
+    std::unique_ptr<ScratchSpace> scratch_{};
+    ///< Optional toolchain symbol index (not owned)
+    const SymbolIndex* symbol_index_ = nullptr;
+    ///< Whether to profile the prologue of the first compiled probe
+    bool profile_prologue_ = false;
+    ///< Prologue profile of the first compiled probe
+    std::optional<PrologueProfile> prologue_profile_{};
+    ///< Optional probe coalescer (not owned)
+    ProbeCoalescer* probe_coalescer_ = nullptr;
+    ///< Optional job server bounding concurrent probes (not owned)
+    JobServer* job_server_ = nullptr;
+    ///< Optional log of failed probe commands (not owned)
+    ProbeLog* probe_log_ = nullptr;
+    ///< Optional recorder of every probe (not owned)
+    ProbeRecorder* probe_recorder_ = nullptr;
+
+    /** @brief Get the scratch space, creating it on first use. */
+    ScratchSpace& scratch();
+
+    /**
+     * @brief Record the prologue profile of `source` unless one exists.
+     * @param source The probe source about to be compiled.
+     * @param language Language of the source ("c" or "cpp").
+     */
+    void record_prologue(const ScratchFile& source,
+                         const std::string& language);
 
     /** @brief Check if a function exists and can be linked. */
     CheckResult check_function(const Check& check);
@@ -97,6 +228,23 @@ class CheckRunner {
     /** @brief Check if code compiles successfully. */
     CheckResult check_compile(const Check& check);
 
+    /**
+     * @brief Determine which compiler flags are accepted.
+     *
+     * Compiles `code` once with every flag. Flags named by the compiler's
+     * rejection diagnostics are dropped and the rest recompiled; a failure
+     * no diagnostic attributes is bisected. N accepted flags cost one
+     * compile instead of N.
+     *
+     * @param flags Flags to test.
+     * @param code Source code to compile.
+     * @param language Language of the code ("c" or "cpp").
+     * @return Per-flag acceptance, parallel to `flags`.
+     */
+    std::vector<bool> test_compiler_flags(const std::vector<std::string>& flags,
+                                          const std::string& code,
+                                          const std::string& language);
+
     /** @brief Check if code compiles and links. */
     CheckResult check_link(const Check& check);
 
@@ -137,15 +285,30 @@ class CheckRunner {
                      const std::string& language = "c");
 
     /**
-     * @brief Try to link an object file into an executable.
+     * @brief Try to compile code with extra compiler flags, capturing the
+     * compiler's diagnostics.
+     * @param code Source code to compile.
+     * @param language Language of the code ("c" or "cpp").
+     * @param flags Flags appended after the configured compile flags.
+     * @param output Receives the combined stdout/stderr of the compiler.
+     * @return true if compilation succeeded, false otherwise.
+     */
+    bool try_compile_with_flags(const std::string& code,
+                                const std::string& language,
+                                const std::vector<std::string>& flags,
+                                std::string& output);
+
+    /**
+     * @brief Build the command linking an object file into an executable.
      * @param object_file Path to the object file to link.
      * @param executable Path where the executable should be created.
      * @param language Language of the code ("c" or "cpp").
-     * @return true if linking succeeded, false otherwise.
+     * @return The link command.
      */
-    bool try_link(const std::filesystem::path& object_file,
-                  const std::filesystem::path& executable,
-                  const std::string& language = "c");
+    std::vector<std::string> link_command(
+        const std::filesystem::path& object_file,
+        const std::filesystem::path& executable,
+        const std::string& language = "c");
 
     /**
      * @brief Try to compile and link code (without running).
@@ -167,6 +330,54 @@ class CheckRunner {
                                        const std::string& library,
                                        const std::string& language = "c");
 
+    /**
+     * @brief Run a probe through the probe coalescer, if one is set, and
+     * record it if a recorder is set.
+     * @param record What the probe is; its commands, outcome and duration
+     *               are filled in.
+     * @param commands The commands `probe` runs, in order.
+     * @param scratch_paths Action-specific paths appearing in `commands`.
+     * @param probe Runs the commands and returns whether they succeeded.
+     * @param coalesce Whether an identical probe may answer instead; false
+     *                 when the caller needs the output of the commands.
+     * @return The outcome of `probe`, or of an identical probe.
+     */
+    bool run_probe(ProbeRecord record,
+                   const std::vector<std::vector<std::string>>& commands,
+                   const std::vector<std::string>& scratch_paths,
+                   const std::function<bool()>& probe, bool coalesce = true);
+
+    /**
+     * @brief Run independent probes, concurrently when the job server
+     * allows it.
+     *
+     * A probe that has not started yet is skipped once an earlier one
+     * succeeded, so the answer is the one sequential probing would give.
+     *
+     * @param probes The probes, in order of preference.
+     * @return Index of the first probe that succeeded, or std::nullopt.
+     */
+    std::optional<size_t> first_success(
+        const std::vector<std::function<bool()>>& probes);
+
+    /**
+     * @brief Whether the symbol index proves that `library` provides the
+     * symbol probed by `check`.
+     * @param check A function, lib or search_libs check.
+     * @param library Library name, or SymbolIndex::default_library().
+     * @return true only when the index has a positive answer; the caller
+     * must link otherwise.
+     */
+    bool symbol_index_resolves(const Check& check,
+                               const std::string& library) const;
+
+    /**
+     * @brief Link an empty program with `-Wl,-t` and return the trace.
+     * @param language Language of the program ("c" or "cpp").
+     * @return Linker output, or std::nullopt if the link failed.
+     */
+    std::optional<std::string> link_trace(const std::string& language);
+
     /**
      * @brief Filter out flags that promote warnings to errors.
      * @param flags Original compiler flags.
@@ -209,13 +420,19 @@ class CheckRunner {
     std::string get_defines_from_previous_checks() const;
 
     /**
-     * @brief Find compile-time constant value using static_assert binary
-     * search.
-     * @param base_code_template Code template with {value} placeholder for
-     * static_assert.
+     * @brief Find a positive compile-time value (a size or alignment) by
+     * galloping search.
+     *
+     * The template's `== {value}` test is rewritten into `<=` comparisons:
+     * doubling bounds bracket the value, then bisection finds it, in
+     * O(log n) compiles. One failed compile of `!= 0` reports a missing
+     * type.
+     *
+     * @param base_code_template Code template testing `== {value}` in a
+     * static assertion.
      * @param language Language of the code ("c" or "cpp").
-     * @return The value that makes static_assert pass, or std::nullopt if none
-     * found.
+     * @return The value, or std::nullopt if the template does not compile
+     * (e.g. the type does not exist).
      */
     std::optional<int> find_compile_time_value_with_static_assert(
         const std::string& base_code_template, const std::string& language);
@@ -1,17 +1,31 @@
 #include "autoconf/private/checker/checker.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 
 #include "autoconf/private/checker/check.h"
 #include "autoconf/private/checker/condition_evaluator.h"
 #include "autoconf/private/checker/config.h"
-#include "autoconf/private/checker/debug_logger.h"
+#include "autoconf/private/checker/jobserver.h"
+#include "autoconf/private/checker/probe_coalescer.h"
+#include "autoconf/private/checker/probe_log.h"
+#include "autoconf/private/checker/probe_record.h"
+#include "autoconf/private/checker/prologue_profile.h"
+#include "autoconf/private/checker/symbol_index.h"
 #include "autoconf/private/common/file_util.h"
+#include "autoconf/private/common/trace.h"
 #include "tools/json/json.h"
 
 namespace rules_cc_autoconf {
@@ -153,225 +167,664 @@ class ResultLookup {
     }
 };
 
-}  // namespace
+/**
+ * @brief Load a single check from its JSON file.
+ */
+Check load_check(const std::filesystem::path& check_path) {
+    std::ifstream check_file = open_ifstream(check_path);
+    if (!check_file.is_open()) {
+        throw std::runtime_error("Failed to open check file: " +
+                                 check_path.string());
+    }
 
-int Checker::run_check_from_file(const std::filesystem::path& check_path,
-                                 const std::filesystem::path& config_path,
-                                 const std::filesystem::path& results_path,
-                                 const std::vector<DepMapping>& dep_mappings) {
-    try {
-        // Load config for compiler info only
-        std::unique_ptr<Config> config = Config::from_file(config_path);
+    nlohmann::json check_json;
+    check_file >> check_json;
+    check_file.close();
 
-        // Load the check from JSON file
-        std::ifstream check_file = open_ifstream(check_path);
-        if (!check_file.is_open()) {
-            throw std::runtime_error("Failed to open check file: " +
-                                     check_path.string());
-        }
+    std::optional<Check> check_opt = Check::from_json(&check_json);
+    if (!check_opt.has_value()) {
+        throw std::runtime_error("Failed to parse check from file: " +
+                                 check_path.string());
+    }
+    return *check_opt;
+}
 
-        nlohmann::json check_json;
-        check_file >> check_json;
-        check_file.close();
+/**
+ * @brief Load the results of dependent checks, keyed by lookup name.
+ */
+std::map<std::string, CheckResult> load_dep_results(
+    const std::vector<DepMapping>& dep_mappings) {
+    ResultLookup result_lookup;
+    for (const DepMapping& mapping : dep_mappings) {
+        result_lookup.add_mapping(mapping.lookup_name, mapping.file_path);
+    }
 
-        std::optional<Check> check_opt = Check::from_json(&check_json);
-        if (!check_opt.has_value()) {
-            throw std::runtime_error("Failed to parse check from file: " +
-                                     check_path.string());
+    // Convert to map for backward compatibility with existing code
+    std::map<std::string, CheckResult> dep_results_map =
+        result_lookup.to_map();
+
+    // Debug: log what's in the map
+    if (trace::enabled(trace::Level::kDebug)) {
+        AUTOCONF_TRACE_DEBUG("Dep results map",
+                             {"entries", dep_results_map.size()});
+        for (const auto& [key, result] : dep_results_map) {
+            AUTOCONF_TRACE_DEBUG("Dep result", {"key", key},
+                                 {"define", result.define.value_or("(none)")},
+                                 {"value", result.value.value_or("")});
         }
-        const Check& check = *check_opt;
+    }
+    return dep_results_map;
+}
 
-        ResultLookup result_lookup;
-        for (const DepMapping& mapping : dep_mappings) {
-            result_lookup.add_mapping(mapping.lookup_name, mapping.file_path);
+/**
+ * @brief Hand dependent check results to a runner.
+ */
+void set_runner_deps(
+    CheckRunner& runner,
+    const std::map<std::string, CheckResult>& dep_results_map) {
+    // Extract AC_DEFINE defines from dependent checks to include in
+    // compilation tests Since dep_results_map now has multiple entries per
+    // result (by name, define, subst), we need to process each unique
+    // result only once
+    std::map<std::string, std::string> compile_defines_map;
+    std::set<std::string> processed_results;
+    for (const auto& [key, info] : dep_results_map) {
+        // Only process each result once (use cache variable name as unique
+        // identifier)
+        if (processed_results.find(info.name) != processed_results.end()) {
+            continue;
         }
+        processed_results.insert(info.name);
+
+        if (info.is_define && info.success && info.value.has_value() &&
+            !info.value->empty()) {
+            // Use define name if available, otherwise use cache variable
+            // name
+            std::string define_name =
+                info.define.has_value() ? *info.define : info.name;
+            compile_defines_map[define_name] = *info.value;
+        }
+    }
+    runner.set_required_defines(compile_defines_map);
+    runner.set_dep_results(dep_results_map);
+}
 
-        // Convert to map for backward compatibility with existing code
-        std::map<std::string, CheckResult> dep_results_map =
-            result_lookup.to_map();
-
-        // Debug: log what's in the map
-        if (DebugLogger::is_debug_enabled()) {
-            DebugLogger::debug("Dep results map contains " +
-                               std::to_string(dep_results_map.size()) +
-                               " entries:");
-            for (const auto& [key, result] : dep_results_map) {
-                std::string define_str =
-                    result.define.has_value() ? *result.define : "(none)";
-                DebugLogger::debug("  Key: '" + key + "', define: '" +
-                                   define_str + "', value: '" +
-                                   result.value.value_or("") + "'");
+/**
+ * @brief Check if all required defines of a check are satisfied.
+ * @throws std::runtime_error if a requirement cannot be evaluated.
+ */
+bool requirements_met(
+    const Check& check,
+    const std::map<std::string, CheckResult>& all_results_map) {
+    if (!check.required_defines().has_value()) {
+        return true;
+    }
+    std::string check_name =
+        check.define().has_value() ? *check.define() : check.name();
+    for (const std::string& req : *check.required_defines()) {
+        ConditionEvaluator evaluator(req);
+        try {
+            if (!evaluator.compute(all_results_map)) {
+                AUTOCONF_TRACE_WARN("Requirement not satisfied, skipping",
+                                    {"check", check_name}, {"requires", req});
+                return false;
             }
+        } catch (const std::exception& ex) {
+            throw std::runtime_error("Check '" + check_name + "' requires '" +
+                                     req +
+                                     "' but evaluation failed: " + ex.what());
         }
+    }
+    return true;
+}
 
-        CheckRunner runner(*config);
+/**
+ * @brief Result of a check whose requirements are not met.
+ *
+ * The value is nullopt (not "0") so the resolver produces an `#undef`.
+ */
+CheckResult unmet_result(const Check& check) {
+    std::string define_name =
+        check.define().has_value() ? *check.define() : check.name();
+    return CheckResult(define_name, std::nullopt, false);
+}
 
-        // Derive source file ID and directory from the check JSON path.
-        // E.g., "config/ac_cv_header_stdio_h.check.json" produces:
-        //   source_id  = "ac_cv_header_stdio_h.check.conftest"
-        //   source_dir = "config/"
-        // So the conftest file "ac_cv_header_stdio_h.check.conftest.c" is
-        // written next to the check JSON, with a globally unique name.
-        runner.set_source_id(check_path.stem().string() + ".conftest",
-                             check_path.parent_path());
-
-        // Extract AC_DEFINE defines from dependent checks to include in
-        // compilation tests Since dep_results_map now has multiple entries per
-        // result (by name, define, subst), we need to process each unique
-        // result only once
-        std::map<std::string, std::string> compile_defines_map;
-        std::set<std::string> processed_results;
-        for (const auto& [key, info] : dep_results_map) {
-            // Only process each result once (use cache variable name as unique
-            // identifier)
-            if (processed_results.find(info.name) != processed_results.end()) {
-                continue;
+/**
+ * @brief Evaluate a conditional define/subst check.
+ *
+ * Picks define_value or define_value_fail depending on the condition.
+ */
+CheckResult evaluate_condition(
+    const Check& check,
+    const std::map<std::string, CheckResult>& all_results_map) {
+    ConditionEvaluator evaluator(*check.condition());
+    bool cond_true = evaluator.compute(all_results_map);
+
+    std::optional<std::string> value;
+    if (cond_true) {
+        // For conditional checks, define_value is always set in JSON (even if
+        // None/null) This matches behavior of direct value parameter - if_true
+        // behaves like value
+        if (check.define_value().has_value()) {
+            value = *check.define_value();
+        } else {
+            // Field exists in JSON but is null/None - use empty string to
+            // create /**/ This matches check_define behavior for direct
+            // AC_DEFINE with value=None
+            value = std::optional<std::string>("");
+        }
+    } else {
+        // When condition fails: if define_value_fail has a value (including
+        // ""), create define with it. If define_value_fail is null
+        // (if_false=None meaning "don't define when fail"), don't create
+        // define.
+        if (check.define_value_fail().has_value()) {
+            value = *check.define_value_fail();
+        } else {
+            // define_value_fail is null (if_false=None) -> don't define when
+            // condition fails (/* #undef */)
+            value = std::nullopt;
+        }
+    }
+
+    bool should_create_define = false;
+    if (value.has_value() && value->empty()) {
+        should_create_define = (check.type() == CheckType::kDefine);
+    }
+
+    // A value was assigned (from either if_true or if_false branch), so the
+    // check succeeded.
+    bool success =
+        value.has_value() && (!value->empty() || should_create_define);
+    return CheckResult(check.name(), success ? value : std::nullopt, success,
+                       check_type_is_define(check.type()),
+                       check.subst().has_value(), check.type(), check.define(),
+                       check.subst(), check.unquote());
+}
+
+/**
+ * @brief Serialize a check result in the flat result file format.
+ */
+nlohmann::json result_to_json(const CheckResult& result) {
+    // Flat result format: {success, value, type} only.
+    // Consumer metadata is tracked in Starlark providers and written
+    // to a manifest at rendering time.
+    nlohmann::json value_json;
+    if (result.value.has_value()) {
+        if (result.value->empty()) {
+            value_json = "";
+        } else {
+            try {
+                value_json = nlohmann::json::parse(*result.value);
+            } catch (const nlohmann::json::parse_error&) {
+                value_json = *result.value;
             }
-            processed_results.insert(info.name);
-
-            if (info.is_define && info.success && info.value.has_value() &&
-                !info.value->empty()) {
-                // Use define name if available, otherwise use cache variable
-                // name
-                std::string define_name =
-                    info.define.has_value() ? *info.define : info.name;
-                compile_defines_map[define_name] = *info.value;
+        }
+    } else {
+        value_json = nullptr;
+    }
+    return {
+        {"success", result.success},
+        {"type", check_type_to_string(result.type)},
+        {"value", value_json},
+    };
+}
+
+/**
+ * @brief Write a check result file.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void write_result(const CheckResult& result,
+                  const std::filesystem::path& results_path) {
+    std::ofstream results_file = open_ofstream(results_path);
+    if (!results_file.is_open()) {
+        throw std::runtime_error("Failed to open results file: " +
+                                 results_path.string());
+    }
+    results_file << result_to_json(result).dump(4) << std::endl;
+    results_file.close();
+}
+
+/**
+ * @brief Make a result of this run visible to later conditions.
+ *
+ * The result is indexed by the check's cache variable, define and subst
+ * names, exactly as a `--dep` on its result file would be.
+ */
+void add_local_result(const Check& check, const CheckResult& result,
+                      std::map<std::string, CheckResult>& all_results_map) {
+    nlohmann::json j = result_to_json(result);
+    std::vector<std::string> names = {check.name()};
+    if (check.define().has_value()) names.push_back(*check.define());
+    if (check.subst().has_value()) names.push_back(*check.subst());
+    for (const std::string& name : names) {
+        std::optional<CheckResult> loaded = CheckResult::from_json(name, &j);
+        all_results_map.insert_or_assign(name, *loaded);
+    }
+}
+
+/**
+ * @brief Write a JSON diagnostics file.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void write_json(const nlohmann::json& j, const std::filesystem::path& path) {
+    std::ofstream file = open_ofstream(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open output file: " +
+                                 path.string());
+    }
+    file << j.dump(4) << std::endl;
+}
+
+/**
+ * @brief The per-check path of check `index`, or empty.
+ * @throws std::runtime_error if `paths` is neither empty nor one per check.
+ */
+std::filesystem::path check_path_at(
+    const std::vector<std::filesystem::path>& paths, size_t index,
+    size_t checks) {
+    if (paths.empty()) {
+        return {};
+    }
+    if (paths.size() != checks) {
+        throw std::runtime_error(
+            "Per-check outputs must be given once per check");
+    }
+    return paths[index];
+}
+
+/**
+ * @brief Fail if an `--output` names no derived output of the checks.
+ * @throws std::runtime_error naming the output.
+ */
+void validate_output_paths(
+    const std::vector<Check>& checks,
+    const std::map<std::string, std::filesystem::path>& output_paths) {
+    for (const auto& [name, path] : output_paths) {
+        bool declared = false;
+        for (const Check& check : checks) {
+            for (const Check& output : check.outputs()) {
+                declared = declared || output.name() == name;
             }
         }
-        runner.set_required_defines(compile_defines_map);
-        runner.set_dep_results(dep_results_map);
+        if (!declared) {
+            throw std::runtime_error(
+                (checks.size() == 1 ? "Check '" + checks.front().name() + "'"
+                                    : std::string("No check")) +
+                " has no output named '" + name + "'");
+        }
+    }
+}
+
+/**
+ * @brief State shared by the checks of one checker run.
+ *
+ * The config and the symbol index are only read once a check probes, so a
+ * run whose requirements are all unmet never touches the toolchain. Probes
+ * of all checks share one coalescer and one job server.
+ */
+class CheckSession {
+   public:
+    CheckSession(std::filesystem::path config_path,
+                 const std::vector<DepMapping>& dep_mappings,
+                 const CheckRunOptions& options)
+        : config_path_(std::move(config_path)),
+          options_(options),
+          dep_results_(load_dep_results(dep_mappings)),
+          coalescer_(options.probe_socket_path),
+          job_server_(JobServer::from_environment(options.jobs)) {}
+
+    /**
+     * @brief Run check `index` of `count` and write its result, its derived
+     * outputs and its per-check outputs (see CheckRunOptions).
+     *
+     * Thread-safe.
+     *
+     * @throws std::runtime_error on error.
+     */
+    void run(const Check& check, const std::filesystem::path& check_path,
+             const std::filesystem::path& results_path, size_t index,
+             size_t count) {
+        const std::filesystem::path prologue_profile_path =
+            check_path_at(options_.prologue_profile_paths, index, count);
+        const std::filesystem::path config_log_path =
+            check_path_at(options_.config_log_paths, index, count);
+        const std::filesystem::path probe_record_path =
+            check_path_at(options_.probe_record_paths, index, count);
+
+        ProbeLog probe_log;
+        ProbeRecorder probe_recorder;
+        std::optional<CheckRunner> runner;
+        auto probe = [&](const Check& target) {
+            if (options_.no_toolchain) {
+                throw std::runtime_error("Check '" + target.name() +
+                                         "' needs the toolchain, which "
+                                         "--no-toolchain left out");
+            }
+            if (!runner.has_value()) {
+                runner.emplace(config());
+
+                // Derive source file ID and directory from the check JSON
+                // path. E.g., "config/ac_cv_header_stdio_h.check.json"
+                // produces:
+                //   source_id  = "ac_cv_header_stdio_h.check.conftest"
+                //   source_dir = "config/"
+                // The conftest file "ac_cv_header_stdio_h.check.conftest.c"
+                // goes to the scratch space (see ScratchSpace): a private tmp
+                // directory by default, or next to the check JSON with
+                // RULES_CC_AUTOCONF_SCRATCH=output, where its unique name
+                // matters.
+                runner->set_source_id(check_path.stem().string() + ".conftest",
+                                      check_path.parent_path());
+                set_runner_deps(*runner, dep_results_);
+                runner->set_profile_prologue(!prologue_profile_path.empty());
+                runner->set_probe_coalescer(&coalescer_);
+                runner->set_job_server(&job_server_);
+                runner->set_probe_log(&probe_log);
+                if (!probe_record_path.empty()) {
+                    runner->set_probe_recorder(&probe_recorder);
+                }
+                if (check.symbol().has_value()) {
+                    runner->set_symbol_index(symbol_index());
+                }
+            }
+            return runner->run_check(target);
+        };
 
         // Create a combined results map that includes both dependency results
         // and results from the current target (as they're processed)
-        std::map<std::string, CheckResult> all_results_map = dep_results_map;
-
-        // Check if all required defines are successful
-        bool requirements_met = true;
-
-        // Get the condition name if this is a conditional check
-        std::string condition_name;
-        if (check.condition().has_value()) {
-            condition_name = *check.condition();
-        }
-
-        if (check.required_defines().has_value()) {
-            std::string check_name =
-                check.define().has_value() ? *check.define() : check.name();
-            for (const std::string& req : *check.required_defines()) {
-                ConditionEvaluator evaluator(req);
-                try {
-                    if (!evaluator.compute(all_results_map)) {
-                        requirements_met = false;
-                        DebugLogger::warn("Check '" + check_name +
-                                          "' requires '" + req +
-                                          "' which is not satisfied, skipping");
-                        break;
-                    }
-                } catch (const std::exception& ex) {
-                    throw std::runtime_error(
-                        "Check '" + check_name + "' requires '" + req +
-                        "' but evaluation failed: " + ex.what());
-                }
+        std::map<std::string, CheckResult> all_results_map = dep_results_;
+
+        CheckResult result = unmet_result(check);
+        if (requirements_met(check, all_results_map)) {
+            if (check.condition().has_value()) {
+                result = evaluate_condition(check, all_results_map);
+            } else {
+                result = probe(check);
             }
         }
 
-        std::string define_name =
-            check.define().has_value() ? *check.define() : check.name();
-        // When requires fails, create result with nullopt value (not "0") so
-        // resolver produces /* #undef */
-        CheckResult result(define_name, std::nullopt, false);
-        if (requirements_met) {
-            if (check.condition().has_value()) {
-                // Handle conditional subst/define checks
-                ConditionEvaluator evaluator(*check.condition());
-                bool cond_true = evaluator.compute(all_results_map);
-
-                std::optional<std::string> value;
-                if (cond_true) {
-                    // For conditional checks, define_value is always set in
-                    // JSON (even if None/null) This matches behavior of direct
-                    // value parameter - if_true behaves like value
-                    if (check.define_value().has_value()) {
-                        value = *check.define_value();
-                    } else {
-                        // Field exists in JSON but is null/None - use empty
-                        // string to create /**/ This matches check_define
-                        // behavior for direct AC_DEFINE with value=None
-                        value = std::optional<std::string>("");
-                    }
-                } else {
-                    // When condition fails: if define_value_fail has a value
-                    // (including ""), create define with it. If
-                    // define_value_fail is null (if_false=None meaning "don't
-                    // define when fail"), don't create define.
-                    if (check.define_value_fail().has_value()) {
-                        value = *check.define_value_fail();
-                    } else {
-                        // define_value_fail is null (if_false=None) -> don't
-                        // define when condition fails (/* #undef */)
-                        value = std::nullopt;
-                    }
-                }
+        write_result(result, results_path);
 
-                bool should_create_define = false;
-                if (value.has_value() && value->empty()) {
-                    should_create_define = (check.type() == CheckType::kDefine);
-                }
+        // Derived outputs read the result in-process. Outputs without a path
+        // are produced elsewhere (e.g. reused from a dependency).
+        add_local_result(check, result, all_results_map);
+        for (const Check& output : check.outputs()) {
+            std::map<std::string, std::filesystem::path>::const_iterator path =
+                options_.output_paths.find(output.name());
+            if (path == options_.output_paths.end()) {
+                continue;
+            }
+            CheckResult output_result = unmet_result(output);
+            if (requirements_met(output, all_results_map)) {
+                output_result =
+                    output.condition().has_value()
+                        ? evaluate_condition(output, all_results_map)
+                        : probe(output);
+            }
+            write_result(output_result, path->second);
+            add_local_result(output, output_result, all_results_map);
+        }
 
-                std::string result_name = check.name();
-                if (value.has_value() &&
-                    (!value->empty() || should_create_define)) {
-                    // A value was assigned (from either if_true or
-                    // if_false branch), so the check succeeded.
-                    result = CheckResult(result_name, value, true,
-                                         check_type_is_define(check.type()),
-                                         check.subst().has_value(),
-                                         check.type(), check.define(),
-                                         check.subst(), check.unquote());
-                } else {
-                    result = CheckResult(result_name, std::nullopt, false,
-                                         check_type_is_define(check.type()),
-                                         check.subst().has_value(),
-                                         check.type(), check.define(),
-                                         check.subst(), check.unquote());
-                }
-            } else {
-                result = runner.run_check(check);
+        if (!prologue_profile_path.empty()) {
+            nlohmann::json profile;
+            if (runner.has_value() && runner->prologue_profile().has_value()) {
+                profile = runner->prologue_profile()->to_json();
             }
+            write_json({{"name", check.name()}, {"profile", profile}},
+                       prologue_profile_path);
         }
+        if (!config_log_path.empty()) {
+            std::ofstream log(config_log_path);
+            if (!log.is_open()) {
+                throw std::runtime_error("Failed to open output file: " +
+                                         config_log_path.string());
+            }
+            log << probe_log.render(check.name() + ": " +
+                                    result_to_json(result).dump());
+        }
+        if (!probe_record_path.empty()) {
+            nlohmann::json probes = nlohmann::json::array();
+            for (const ProbeRecord& record : probe_recorder.records()) {
+                probes.push_back(record.to_json());
+            }
+            write_json({{"name", check.name()}, {"probes", probes}},
+                       probe_record_path);
+        }
+    }
 
-        // Flat result format: {success, value, type} only.
-        // Consumer metadata is tracked in Starlark providers and written
-        // to a manifest at rendering time.
-        nlohmann::json value_json;
-        if (result.value.has_value()) {
-            if (result.value->empty()) {
-                value_json = "";
-            } else {
-                try {
-                    value_json = nlohmann::json::parse(*result.value);
-                } catch (const nlohmann::json::parse_error&) {
-                    value_json = *result.value;
-                }
+   private:
+    const std::filesystem::path config_path_;
+    const CheckRunOptions& options_;
+    const std::map<std::string, CheckResult> dep_results_;
+    ProbeCoalescer coalescer_;
+    JobServer job_server_;
+    std::once_flag config_once_{};
+    std::unique_ptr<Config> config_{};  ///< Loaded by config()
+    std::once_flag symbol_index_once_{};
+    std::optional<SymbolIndex> symbol_index_{};  ///< Loaded by symbol_index()
+
+    /** @brief The toolchain, read on first use. */
+    const Config& config() {
+        std::call_once(config_once_,
+                       [&]() { config_ = Config::from_file(config_path_); });
+        return *config_;
+    }
+
+    /** @brief The symbol index, read on first use, or nullptr. */
+    const SymbolIndex* symbol_index() {
+        std::call_once(symbol_index_once_, [&]() {
+            if (options_.symbol_index_path.empty()) {
+                return;
+            }
+            // The index only saves work, so an unreadable one is not fatal.
+            try {
+                symbol_index_ = SymbolIndex::read(options_.symbol_index_path);
+            } catch (const std::exception& ex) {
+                AUTOCONF_TRACE_WARN("Ignoring symbol index",
+                                    {"error", ex.what()});
+            }
+        });
+        return symbol_index_.has_value() ? &*symbol_index_ : nullptr;
+    }
+};
+
+}  // namespace
+
+int Checker::run_check_from_file(const std::filesystem::path& check_path,
+                                 const std::filesystem::path& config_path,
+                                 const std::filesystem::path& results_path,
+                                 const std::vector<DepMapping>& dep_mappings,
+                                 const CheckRunOptions& options) {
+    try {
+        const Check check = load_check(check_path);
+        validate_output_paths({check}, options.output_paths);
+
+        CheckSession session(config_path, dep_mappings, options);
+        session.run(check, check_path, results_path, 0, 1);
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
+
+int Checker::run_flag_checks_from_files(
+    const std::vector<std::filesystem::path>& check_paths,
+    const std::filesystem::path& config_path,
+    const std::vector<std::filesystem::path>& results_paths,
+    const std::vector<DepMapping>& dep_mappings) {
+    try {
+        if (check_paths.size() != results_paths.size()) {
+            throw std::runtime_error(
+                "Each --check requires a matching --results");
+        }
+
+        std::unique_ptr<Config> config = Config::from_file(config_path);
+
+        std::vector<Check> checks;
+        checks.reserve(check_paths.size());
+        for (const std::filesystem::path& check_path : check_paths) {
+            checks.push_back(load_check(check_path));
+            const Check& check = checks.back();
+            if (check.type() != CheckType::kCompile ||
+                !check.flag().has_value() || check.condition().has_value()) {
+                throw std::runtime_error(
+                    "Only compiler flag checks can be batched: " +
+                    check_path.string());
             }
-        } else {
-            value_json = nullptr;
         }
-        nlohmann::json j = {
-            {"success", result.success},
-            {"type", check_type_to_string(result.type)},
-            {"value", value_json},
+        std::map<std::string, CheckResult> dep_results_map =
+            load_dep_results(dep_mappings);
+
+        // Conftest files are named after the first check of the batch.
+        CheckRunner runner(*config);
+        runner.set_source_id(check_paths.front().stem().string() + ".conftest",
+                             check_paths.front().parent_path());
+        set_runner_deps(runner, dep_results_map);
+
+        std::vector<CheckResult> results;
+        std::vector<const Check*> runnable;
+        std::vector<size_t> runnable_index;
+        for (size_t i = 0; i < checks.size(); ++i) {
+            results.push_back(unmet_result(checks[i]));
+            if (requirements_met(checks[i], dep_results_map)) {
+                runnable.push_back(&checks[i]);
+                runnable_index.push_back(i);
+            }
+        }
+
+        std::vector<CheckResult> flag_results =
+            runner.run_flag_checks(runnable);
+        for (size_t i = 0; i < flag_results.size(); ++i) {
+            results[runnable_index[i]] = flag_results[i];
+        }
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            write_result(results[i], results_paths[i]);
+        }
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
+
+int Checker::write_prologue_report(
+    const std::vector<std::filesystem::path>& profile_paths,
+    const std::filesystem::path& report_path) {
+    try {
+        std::vector<std::pair<std::string, std::optional<PrologueProfile>>>
+            profiles;
+        for (const std::filesystem::path& path : profile_paths) {
+            std::ifstream file = open_ifstream(path);
+            if (!file.is_open()) {
+                throw std::runtime_error("Failed to open prologue profile: " +
+                                         path.string());
+            }
+            nlohmann::json j;
+            file >> j;
+            nlohmann::json profile = j.value("profile", nlohmann::json());
+            profiles.emplace_back(j.at("name").get<std::string>(),
+                                  PrologueProfile::from_json(profile));
+        }
+        write_json(summarize_prologues(profiles), report_path);
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
+
+int Checker::build_symbol_index(const std::filesystem::path& config_path,
+                                const std::filesystem::path& index_path) {
+    try {
+        std::unique_ptr<Config> config = Config::from_file(config_path);
+
+        CheckRunner runner(*config);
+        runner.set_source_id(index_path.stem().string() + ".conftest",
+                             index_path.parent_path());
+        runner.build_symbol_index().write(index_path);
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
+
+int Checker::replay_probes(
+    const std::vector<std::filesystem::path>& record_paths,
+    const std::filesystem::path& config_path,
+    const std::filesystem::path& report_path, size_t jobs) {
+    try {
+        std::unique_ptr<Config> config = Config::from_file(config_path);
+
+        std::vector<std::pair<std::string, ProbeRecord>> recorded;
+        for (const std::filesystem::path& path : record_paths) {
+            std::ifstream file = open_ifstream(path);
+            if (!file.is_open()) {
+                throw std::runtime_error("Failed to open probe record: " +
+                                         path.string());
+            }
+            nlohmann::json j;
+            file >> j;
+            std::string name = j.at("name").get<std::string>();
+            for (const nlohmann::json& probe : j.at("probes")) {
+                recorded.emplace_back(name, ProbeRecord::from_json(probe));
+            }
+        }
+
+        // Each worker has its own runner, so their scratch files never
+        // collide.
+        std::vector<ProbeReplay> replayed(recorded.size());
+        std::atomic<size_t> next{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto worker = [&](size_t id) {
+            try {
+                CheckRunner runner(*config);
+                runner.set_source_id(
+                    report_path.stem().string() + ".replay" +
+                        std::to_string(id) + ".conftest",
+                    report_path.parent_path());
+                for (size_t i = next++; i < recorded.size(); i = next++) {
+                    std::chrono::steady_clock::time_point start =
+                        std::chrono::steady_clock::now();
+                    replayed[i].success =
+                        runner.replay_probe(recorded[i].second);
+                    replayed[i].duration_us =
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next = recorded.size();
+            }
         };
 
-        std::ofstream results_file = open_ofstream(results_path);
-        if (!results_file.is_open()) {
-            std::cerr << "Error: Failed to open results file: " << results_path
-                      << std::endl;
-            return 1;
+        size_t workers = std::max<size_t>(
+            1, std::min<size_t>(jobs, recorded.size()));
+        std::vector<std::thread> threads;
+        for (size_t id = 1; id < workers; ++id) {
+            threads.emplace_back(worker, id);
+        }
+        worker(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
         }
-        results_file << j.dump(4) << std::endl;
-        results_file.close();
 
+        nlohmann::json report = summarize_probe_replay(recorded, replayed);
+        AUTOCONF_TRACE_INFO("Replayed probes", {"probes", recorded.size()},
+                            {"changed", report["changed_probes"].get<size_t>()},
+                            {"jobs", workers});
+        write_json(report, report_path);
         return 0;
     } catch (const std::exception& ex) {
         std::cerr << "Error: " << ex.what() << std::endl;
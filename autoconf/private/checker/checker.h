@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -25,6 +26,39 @@ struct DepMapping {
     std::filesystem::path file_path;
 };
 
+/**
+ * @brief Settings of a check run beyond its inputs and results.
+ *
+ * The per-check paths are parallel to the checks run; each is empty to skip
+ * that output for every check.
+ */
+struct CheckRunOptions {
+    ///< Toolchain symbol index consulted by link-based checks before
+    ///< linking (empty to always link)
+    std::filesystem::path symbol_index_path{};
+    ///< Probe daemon socket (see ProbeCoalescer); empty to coalesce probes
+    ///< within this process only
+    std::filesystem::path probe_socket_path{};
+    ///< Probes run concurrently when `MAKEFLAGS` advertises no make
+    ///< jobserver (see JobServer)
+    size_t jobs = 1;
+    ///< The action stages no toolchain, as its checks are known not to
+    ///< probe: a check that would probe fails instead
+    bool no_toolchain = false;
+    ///< Where the prologue profile of each check is written (see
+    ///< CheckRunner::set_profile_prologue())
+    std::vector<std::filesystem::path> prologue_profile_paths{};
+    ///< Where the failed probe commands of each check, with their output,
+    ///< are written (see ProbeLog)
+    std::vector<std::filesystem::path> config_log_paths{};
+    ///< Where every probe of each check is recorded for replay_probes()
+    ///< (see ProbeRecord)
+    std::vector<std::filesystem::path> probe_record_paths{};
+    ///< Output name -> path of the result of that derived output (see
+    ///< Check::outputs()); outputs absent from the map are skipped
+    std::map<std::string, std::filesystem::path> output_paths{};
+};
+
 /**
  * @brief Library for running autoconf checks.
  *
@@ -39,12 +73,74 @@ class Checker {
      * @param results_path Path where results JSON will be written.
      * @param dep_mappings Vector of name->file mappings for dependent check
      * results.
+     * @param options Optional inputs and outputs of the run.
+     * @return 0 on success, 1 on error.
+     */
+    static int run_check_from_file(
+        const std::filesystem::path& check_path,
+        const std::filesystem::path& config_path,
+        const std::filesystem::path& results_path,
+        const std::vector<DepMapping>& dep_mappings,
+        const CheckRunOptions& options = {});
+
+    /**
+     * @brief Run several compiler flag checks from JSON files as one batch.
+     *
+     * Flag checks sharing a language and test program are answered by a
+     * single compile; flags the compiler rejects are identified from its
+     * diagnostics, falling back to bisection.
+     *
+     * @param check_paths Paths to JSON files, each holding one flag check.
+     * @param config_path Path to JSON config file (for compiler info).
+     * @param results_paths Result paths, parallel to `check_paths`.
+     * @param dep_mappings Name->file mappings for the dependent check results
+     * of every check in the batch.
+     * @return 0 on success, 1 on error.
+     */
+    static int run_flag_checks_from_files(
+        const std::vector<std::filesystem::path>& check_paths,
+        const std::filesystem::path& config_path,
+        const std::vector<std::filesystem::path>& results_paths,
+        const std::vector<DepMapping>& dep_mappings);
+
+    /**
+     * @brief Summarize the prologue profiles of a target's checks.
+     * @param profile_paths Profiles written by run_check_from_file().
+     * @param report_path Path where the report (see summarize_prologues())
+     * will be written.
+     * @return 0 on success, 1 on error.
+     */
+    static int write_prologue_report(
+        const std::vector<std::filesystem::path>& profile_paths,
+        const std::filesystem::path& report_path);
+
+    /**
+     * @brief Build the symbol index for the toolchain described by a config.
+     * @param config_path Path to JSON config file (for compiler info).
+     * @param index_path Path where the index will be written.
+     * @return 0 on success, 1 on error.
+     */
+    static int build_symbol_index(const std::filesystem::path& config_path,
+                                  const std::filesystem::path& index_path);
+
+    /**
+     * @brief Replay recorded probes against another toolchain.
+     *
+     * Runs every probe recorded by run_check_from_file() with the compiler
+     * and flags of `config_path`, outside of any build, and compares the
+     * outcomes and latencies with the recording (see
+     * summarize_probe_replay()).
+     *
+     * @param record_paths Probe records written by run_check_from_file().
+     * @param config_path Path to JSON config file of the toolchain to try.
+     * @param report_path Path where the report will be written.
+     * @param jobs Probes replayed concurrently.
      * @return 0 on success, 1 on error.
      */
-    static int run_check_from_file(const std::filesystem::path& check_path,
-                                   const std::filesystem::path& config_path,
-                                   const std::filesystem::path& results_path,
-                                   const std::vector<DepMapping>& dep_mappings);
+    static int replay_probes(
+        const std::vector<std::filesystem::path>& record_paths,
+        const std::filesystem::path& config_path,
+        const std::filesystem::path& report_path, size_t jobs);
 };
 
 }  // namespace rules_cc_autoconf
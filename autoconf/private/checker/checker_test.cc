@@ -0,0 +1,283 @@
+#include "autoconf/private/checker/checker.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tools/json/json.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using rules_cc_autoconf::Checker;
+using rules_cc_autoconf::CheckRunOptions;
+using rules_cc_autoconf::DepMapping;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+/** A scratch directory removed on destruction. */
+class TestDir {
+   public:
+    explicit TestDir(const std::string& name)
+        : path_(std::filesystem::temp_directory_path() /
+                ("checker_test_" + name + "_" +
+#ifndef _WIN32
+                 std::to_string(getpid())
+#else
+                 std::string("0")
+#endif
+                     )) {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+    }
+    ~TestDir() { std::filesystem::remove_all(path_); }
+
+    /** @brief Write `content` to `name` and return its path. */
+    std::filesystem::path write(const std::string& name,
+                                const std::string& content) const {
+        std::filesystem::path file = path_ / name;
+        std::ofstream(file) << content;
+        return file;
+    }
+
+    std::filesystem::path path(const std::string& name) const {
+        return path_ / name;
+    }
+
+   private:
+    std::filesystem::path path_;
+};
+
+static std::string read_file(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+static nlohmann::json read_json(const std::filesystem::path& path) {
+    return nlohmann::json::parse(read_file(path));
+}
+
+/** An AC_DEFINE of `define` to `value`, gated on `requires`. */
+static std::string gated_define(const std::string& define,
+                                const std::string& value,
+                                const std::string& requires) {
+    return nlohmann::json({
+                              {"type", "define"},
+                              {"name", "ac_cv_define_" + define},
+                              {"define", define},
+                              {"language", "c"},
+                              {"code", ""},
+                              {"define_value", value},
+                              {"define_value_fail", value},
+                              {"requires", {requires}},
+                          })
+        .dump();
+}
+
+/** Dependency results: HAVE_OPEN succeeded, HAVE_CLOSED did not. */
+static std::vector<DepMapping> gate_deps(const TestDir& dir) {
+    return {
+        {"HAVE_OPEN",
+         dir.write("open.json",
+                   R"({"success": true, "type": "define", "value": 1})")},
+        {"HAVE_CLOSED",
+         dir.write("closed.json",
+                   R"({"success": false, "type": "define", "value": null})")},
+    };
+}
+
+/** Run gated_define() with `options` and return the checker's status. */
+static int run_gated_define(const TestDir& dir, const std::string& define,
+                            const std::string& value,
+                            const std::string& requires,
+                            const std::filesystem::path& config,
+                            const CheckRunOptions& options = {}) {
+    return Checker::run_check_from_file(
+        dir.write(define + ".check.json",
+                  gated_define(define, value, requires)),
+        config, dir.path(define + ".json"), gate_deps(dir), options);
+}
+
+static bool test_gated_define_outputs() {
+    TestDir dir("outputs");
+    // Defines never compile, so the compiler is only named.
+    std::filesystem::path config = dir.write("config.json", R"({
+        "c_compiler": "cc", "cpp_compiler": "c++", "linker": "",
+        "c_flags": [], "cpp_flags": [], "c_link_flags": [],
+        "cpp_link_flags": [], "compiler_type": "gcc"
+    })");
+    for (const std::string define : {"A", "B", "C"}) {
+        CheckRunOptions options;
+        options.config_log_paths = {dir.path(define + ".log")};
+        options.probe_record_paths = {dir.path(define + ".probes.json")};
+        const std::string requires = define == "A"   ? "HAVE_OPEN"
+                                     : define == "B" ? "HAVE_CLOSED"
+                                                     : "!HAVE_CLOSED";
+        if (run_gated_define(dir, define, define == "C" ? "2" : "1", requires,
+                             config, options) != 0) {
+            return false;
+        }
+    }
+
+    nlohmann::json a = read_json(dir.path("A.json"));
+    nlohmann::json b = read_json(dir.path("B.json"));
+    nlohmann::json c = read_json(dir.path("C.json"));
+    return a["success"] == true && a["value"] == "1" &&
+           b["success"] == false && b["value"].is_null() &&
+           c["success"] == true && c["value"] == "2" &&
+           read_file(dir.path("A.log")).rfind("## ac_cv_define_A: ", 0) == 0 &&
+           read_file(dir.path("B.log")).rfind("## ac_cv_define_B: ", 0) == 0 &&
+           read_json(dir.path("C.probes.json"))["name"] == "ac_cv_define_C";
+}
+
+static bool test_closed_gate_skips_config() {
+    TestDir dir("closed");
+    // The config does not exist: neither check may need it.
+    std::filesystem::path config = dir.path("missing.json");
+    return run_gated_define(dir, "A", "1", "HAVE_CLOSED", config) == 0 &&
+           run_gated_define(dir, "B", "1", "!HAVE_OPEN", config) == 0 &&
+           read_json(dir.path("A.json"))["success"] == false &&
+           read_json(dir.path("B.json"))["success"] == false;
+}
+
+static bool test_no_toolchain_rejects_open_gate() {
+    TestDir dir("no_toolchain");
+    std::filesystem::path config = dir.path("missing.json");
+    CheckRunOptions options;
+    options.no_toolchain = true;
+    return run_gated_define(dir, "A", "1", "HAVE_CLOSED", config, options) ==
+               0 &&
+           run_gated_define(dir, "B", "1", "HAVE_OPEN", config, options) == 1;
+}
+
+static bool test_per_check_outputs_once_per_check() {
+    TestDir dir("per_check");
+    CheckRunOptions options;
+    options.config_log_paths = {dir.path("a.log"), dir.path("b.log")};
+    return run_gated_define(dir, "A", "1", "HAVE_CLOSED",
+                            dir.path("missing.json"), options) == 1;
+}
+
+#ifndef _WIN32
+/**
+ * A compiler that knows one type of `size` bytes (0 when undeclared). It
+ * answers the `<= N` tests of the value search and counts its runs.
+ */
+static std::filesystem::path fake_compiler(const TestDir& dir, int size) {
+    std::filesystem::path count = dir.path("compiles");
+    std::filesystem::path compiler = dir.write(
+        "cc.sh", "#!/bin/sh\n"
+                 "echo >> '" + count.string() + "'\n"
+                 "while [ $# -gt 0 ]; do\n"
+                 "  if [ \"$1\" = -c ]; then src=\"$2\"; fi\n"
+                 "  shift\n"
+                 "done\n"
+                 "[ " + std::to_string(size) + " -ne 0 ] || exit 1\n"
+                 "bound=$(sed -n 's/.*<= \\([0-9]*\\).*/\\1/p' \"$src\")\n"
+                 "[ -z \"$bound\" ] || [ " + std::to_string(size) +
+                 " -le \"$bound\" ]\n");
+    std::filesystem::permissions(compiler,
+                                 std::filesystem::perms::owner_all);
+    return compiler;
+}
+
+/**
+ * Run a sizeof check against fake_compiler(). Returns the result value,
+ * and sets `compiles` to the number of compiles it took.
+ */
+static nlohmann::json search_value(const std::string& type, int size,
+                                   size_t& compiles) {
+    TestDir dir("sizeof_" + std::to_string(size));
+    std::filesystem::path config = dir.write(
+        "config.json",
+        nlohmann::json({
+                           {"c_compiler", fake_compiler(dir, size).string()},
+                           {"cpp_compiler", ""},
+                           {"linker", ""},
+                           {"c_flags", nlohmann::json::array()},
+                           {"cpp_flags", nlohmann::json::array()},
+                           {"c_link_flags", nlohmann::json::array()},
+                           {"cpp_link_flags", nlohmann::json::array()},
+                           {"compiler_type", "gcc"},
+                       })
+            .dump());
+    std::filesystem::path check = dir.write(
+        "check.json",
+        nlohmann::json({
+                           {"type", "sizeof"},
+                           {"name", "ac_cv_sizeof_t"},
+                           {"define", "SIZEOF_T"},
+                           {"language", "c"},
+                           {"code", "typedef int t_check[sizeof(" + type +
+                                        ") == {value} ? 1 : -1];\n"},
+                       })
+            .dump());
+    if (Checker::run_check_from_file(check, config, dir.path("result.json"),
+                                     {}) != 0) {
+        return nullptr;
+    }
+    std::istringstream lines(read_file(dir.path("compiles")));
+    std::string line;
+    for (compiles = 0; std::getline(lines, line); ++compiles) {
+    }
+    return read_json(dir.path("result.json"))["value"];
+}
+
+/** Galloping then bisecting takes at most 2 * ceil(log2(size)) + 2. */
+static bool test_sizeof_search() {
+    struct Case {
+        int size;
+        size_t max_compiles;
+    };
+    for (const Case& c : {Case{8, 8}, Case{12, 10}, Case{24, 12},
+                          Case{48, 14}, Case{5000, 28}}) {
+        size_t compiles = 0;
+        if (search_value("char[" + std::to_string(c.size) + "]", c.size,
+                         compiles) != c.size ||
+            compiles > c.max_compiles) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool test_sizeof_undeclared_type_compiles_once() {
+    size_t compiles = 0;
+    nlohmann::json value = search_value("undeclared_t", 0, compiles);
+    return value == 0 && compiles == 1;
+}
+#endif
+
+int main() {
+    std::cout << "checker_test:" << std::endl;
+    TEST(gated_define_outputs)
+    TEST(closed_gate_skips_config)
+    TEST(no_toolchain_rejects_open_gate)
+    TEST(per_check_outputs_once_per_check)
+#ifndef _WIN32
+    TEST(sizeof_search)
+    TEST(sizeof_undeclared_type_compiles_once)
+#endif
+
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
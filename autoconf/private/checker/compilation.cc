@@ -1,8 +1,15 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 #include <system_error>
+#include <thread>
+#include <utility>
 
 #ifndef _WIN32
 #include <sys/wait.h>
@@ -11,8 +18,10 @@
 #endif
 
 #include "autoconf/private/checker/check_runner.h"
-#include "autoconf/private/checker/debug_logger.h"
+#include "autoconf/private/checker/probe_log.h"
+#include "autoconf/private/checker/scratch_space.h"
 #include "autoconf/private/common/file_util.h"
+#include "autoconf/private/common/trace.h"
 
 namespace rules_cc_autoconf {
 
@@ -127,97 +136,166 @@ std::string build_command_string(const std::vector<std::string>& cmd) {
 }
 
 /**
- * @brief Execute a shell command, optionally suppressing output.
+ * @brief Execute a shell command, capturing its output.
  *
- * If verbose debug is not enabled, stdout and stderr are redirected to
- * /dev/null (or NUL on Windows).
+ * The combined stdout/stderr is kept in a bounded buffer. It is recorded in
+ * `log` if the command fails and otherwise discarded; at debug level it is
+ * also traced.
  *
  * @param label A label for debug logging (e.g., "compile", "link").
  * @param cmd Vector of command parts.
- * @return The process exit code (already WEXITSTATUS-unwrapped on Unix).
+ * @param log Receives the command if it fails, or nullptr.
+ * @param source The probe source compiled by `cmd`, for `log`.
+ * @param scratch_paths Action-specific paths in `cmd`, logged as
+ * placeholders (see normalize_probe_argv()), also in its output.
+ * @return The process exit code (already WEXITSTATUS-unwrapped on Unix), or
+ * -1 if the command could not be started.
  */
-int run_command(const std::string& label, const std::vector<std::string>& cmd) {
-    std::string full_cmd = build_command_string(cmd);
-
-    if (!DebugLogger::is_verbose_debug_enabled()) {
+int run_command(const std::string& label, const std::vector<std::string>& cmd,
+                ProbeLog* log = nullptr, const std::string& source = "",
+                const std::vector<std::string>& scratch_paths = {}) {
+    std::string full_cmd = build_command_string(cmd) + " 2>&1";
+    AUTOCONF_TRACE_DEBUG("Executing command", {"label", label},
+                         {"argv", cmd});
+    trace::Span span(trace::Level::kDebug, "run_command");
+
+    OutputCapture capture(ProbeLog::kMaxOutputBytes);
 #ifdef _WIN32
-        full_cmd += " >NUL 2>&1";
+    FILE* pipe = _popen(full_cmd.c_str(), "r");
 #else
-        full_cmd += " >/dev/null 2>&1";
+    FILE* pipe = popen(full_cmd.c_str(), "r");
 #endif
+    int result = -1;
+    if (pipe != nullptr) {
+        char buffer[4096];
+        size_t n = 0;
+        while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+            capture.append(buffer, n);
+        }
+#ifdef _WIN32
+        result = _pclose(pipe);
+#else
+        int status = pclose(pipe);
+        result = status == -1 ? -1 : WEXITSTATUS(status);
+#endif
+    }
+
+    AUTOCONF_TRACE_DEBUG("Command finished", {"label", label},
+                         {"exit_code", result}, {"output", capture.text()});
+    if (result != 0 && log != nullptr) {
+        // The output names the same paths, e.g. in diagnostics.
+        std::string output =
+            normalize_probe_argv({capture.text()}, scratch_paths).front();
+        log->record(ProbeFailure{label,
+                                 normalize_probe_argv(cmd, scratch_paths),
+                                 result, std::move(output), capture.dropped(),
+                                 source});
     }
+    return result;
+}
 
-    DebugLogger::debug("Executing " + label + " command: " + full_cmd);
+/**
+ * @brief Execute a shell command and capture its combined stdout/stderr.
+ *
+ * @param label A label for debug logging (e.g., "link trace").
+ * @param cmd Vector of command parts.
+ * @param output Receives everything the command printed.
+ * @return The process exit code, or -1 if the command could not be started.
+ */
+int run_command_capture(const std::string& label,
+                        const std::vector<std::string>& cmd,
+                        std::string& output) {
+    std::string full_cmd = build_command_string(cmd) + " 2>&1";
+    AUTOCONF_TRACE_DEBUG("Executing command", {"label", label},
+                         {"argv", cmd});
 
-    int result = std::system(full_cmd.c_str());
 #ifdef _WIN32
-    return result;
+    FILE* pipe = _popen(full_cmd.c_str(), "r");
 #else
-    return WEXITSTATUS(result);
+    FILE* pipe = popen(full_cmd.c_str(), "r");
+#endif
+    if (pipe == nullptr) {
+        return -1;
+    }
+    char buffer[4096];
+    size_t n = 0;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        output.append(buffer, n);
+    }
+#ifdef _WIN32
+    return _pclose(pipe);
+#else
+    int status = pclose(pipe);
+    return status == -1 ? -1 : WEXITSTATUS(status);
 #endif
 }
 
 /**
  * @brief RAII helper for managing build artifacts (source, object, executable).
  *
- * Files are written into the provided directory (next to the check JSON file)
- * using a globally unique name derived from the check JSON filename. Build
- * artifacts are cleaned up on destruction.
+ * Files are written into the action's scratch space using a globally unique
+ * name derived from the check JSON filename. Build artifacts are cleaned up on
+ * destruction.
  */
 struct BuildDir {
-    std::filesystem::path dir;
+    ScratchSpace& scratch;
     std::string safe_id;
+    std::optional<ScratchFile> source{};
 
     /**
      * @brief Create a build dir context.
+     * @param scratch_space Scratch space that receives the artifacts.
      * @param unique_id An identifier used in filenames (derived from check JSON
      *                  filename, e.g. "ac_cv_header_stdio_h.check.conftest").
-     * @param base_dir Directory to write files into (parent of the check JSON).
      */
-    BuildDir(const std::string& unique_id,
-             const std::filesystem::path& base_dir)
-        : dir(base_dir), safe_id(sanitize_for_filename(unique_id)) {}
+    BuildDir(ScratchSpace& scratch_space, const std::string& unique_id)
+        : scratch(scratch_space), safe_id(sanitize_for_filename(unique_id)) {}
 
     ~BuildDir() {
+        source.reset();
         std::error_code ec;
-        file_remove(dir / (safe_id + ".c"), ec);
-        file_remove(dir / (safe_id + ".cpp"), ec);
-        file_remove(dir / (safe_id + ".o"), ec);
-        file_remove(dir / (safe_id + ".obj"), ec);
-        file_remove(dir / (safe_id + ".exe"), ec);
-        file_remove(dir / safe_id, ec);
+        file_remove(scratch.dir() / (safe_id + ".o"), ec);
+        file_remove(scratch.dir() / (safe_id + ".obj"), ec);
+        file_remove(scratch.dir() / (safe_id + ".exe"), ec);
+        file_remove(scratch.dir() / safe_id, ec);
     }
 
     /**
-     * @brief Write source code to a file inside the build directory.
+     * @brief Write source code into scratch space.
      * @param code The source code to write.
      * @param extension The file extension (e.g., ".c" or ".cpp").
-     * @return The path to the written source file, or nullopt on failure.
+     * @return The written source file, or nullptr on failure.
      */
-    std::optional<std::filesystem::path> write_source(
-        const std::string& code, const std::string& extension) {
-        std::filesystem::path source_file = dir / (safe_id + extension);
-        std::ofstream source = open_ofstream(source_file);
-        if (!source.is_open()) {
-            DebugLogger::warn("Failed to create source file");
-            return std::nullopt;
-        }
-        source << code;
-        source.close();
-        return source_file;
+    const ScratchFile* write_source(const std::string& code,
+                                    const std::string& extension) {
+        source = scratch.write_source(safe_id + extension, code);
+        return source.has_value() ? &*source : nullptr;
     }
 
     /** @brief Get the path for an object file. */
     std::filesystem::path object_path(bool msvc) const {
-        return dir / (safe_id + (msvc ? ".obj" : ".o"));
+        return scratch.artifact_path(safe_id + (msvc ? ".obj" : ".o"));
+    }
+
+    /**
+     * @brief Paths specific to this build, for probe_key() and logs.
+     * @return The source path, then the common prefix of all artifacts.
+     */
+    std::vector<std::string> scratch_paths() const {
+        std::vector<std::string> paths;
+        if (source.has_value()) {
+            paths.push_back(source->path().string());
+        }
+        paths.push_back((scratch.dir() / safe_id).string());
+        return paths;
     }
 
     /** @brief Get the path for an executable. */
     std::filesystem::path executable_path() const {
 #ifdef _WIN32
-        return dir / (safe_id + ".exe");
+        return scratch.artifact_path(safe_id + ".exe");
 #else
-        return dir / safe_id;
+        return scratch.artifact_path(safe_id);
 #endif
     }
 
@@ -226,6 +304,38 @@ struct BuildDir {
     BuildDir& operator=(const BuildDir&) = delete;
 };
 
+/**
+ * @brief Append a source file to a GCC/Clang command line.
+ *
+ * memfd-backed sources are passed as `/proc/self/fd/N`, which has no
+ * extension, so the language is given explicitly with `-x` and reset
+ * afterwards so later inputs keep their usual interpretation.
+ */
+void append_source(std::vector<std::string>& cmd, const ScratchFile& source,
+                   const std::string& language) {
+    if (source.in_memory()) {
+        cmd.push_back("-x");
+        cmd.push_back(is_cpp(language) ? "c++" : "c");
+        cmd.push_back(source.path().string());
+        cmd.push_back("-x");
+        cmd.push_back("none");
+        return;
+    }
+    cmd.push_back(source.path().string());
+}
+
+/**
+ * @brief Describe a probe for CheckRunner::run_probe().
+ */
+ProbeRecord make_record(ProbeKind kind, const std::string& code,
+                        const std::string& language) {
+    ProbeRecord record;
+    record.kind = kind;
+    record.code = code;
+    record.language = language;
+    return record;
+}
+
 }  // namespace
 
 std::vector<std::string> CheckRunner::filter_error_flags(
@@ -250,13 +360,13 @@ std::vector<std::string> CheckRunner::get_compiler_and_flags(
     const std::string& language) {
     std::vector<std::string> cmd;
     if (is_cpp(language)) {
-        DebugLogger::debug("C++ compiler path: [" + config_.cpp_compiler + "]");
+        AUTOCONF_TRACE_DEBUG("C++ compiler", {"path", config_.cpp_compiler});
         cmd.push_back(config_.cpp_compiler);
         std::vector<std::string> filtered =
             filter_error_flags(config_.cpp_flags);
         cmd.insert(cmd.end(), filtered.begin(), filtered.end());
     } else {
-        DebugLogger::debug("C compiler path: [" + config_.c_compiler + "]");
+        AUTOCONF_TRACE_DEBUG("C compiler", {"path", config_.c_compiler});
         cmd.push_back(config_.c_compiler);
         std::vector<std::string> filtered = filter_error_flags(config_.c_flags);
         cmd.insert(cmd.end(), filtered.begin(), filtered.end());
@@ -268,8 +378,8 @@ std::vector<std::string> CheckRunner::get_compiler_and_link_flags(
     const std::string& language) {
     std::vector<std::string> cmd;
     if (is_cpp(language)) {
-        DebugLogger::debug("C++ compiler path (for linking): [" +
-                           config_.cpp_compiler + "]");
+        AUTOCONF_TRACE_DEBUG("C++ compiler (for linking)",
+                             {"path", config_.cpp_compiler});
         cmd.push_back(config_.cpp_compiler);
         std::vector<std::string> filtered =
             filter_error_flags(config_.cpp_flags);
@@ -278,8 +388,8 @@ std::vector<std::string> CheckRunner::get_compiler_and_link_flags(
             filter_error_flags(config_.cpp_link_flags);
         cmd.insert(cmd.end(), link_filtered.begin(), link_filtered.end());
     } else {
-        DebugLogger::debug("C compiler path (for linking): [" +
-                           config_.c_compiler + "]");
+        AUTOCONF_TRACE_DEBUG("C compiler (for linking)",
+                             {"path", config_.c_compiler});
         cmd.push_back(config_.c_compiler);
         std::vector<std::string> filtered = filter_error_flags(config_.c_flags);
         cmd.insert(cmd.end(), filtered.begin(), filtered.end());
@@ -296,10 +406,11 @@ std::string CheckRunner::get_file_extension(const std::string& language) {
 
 bool CheckRunner::try_compile(const std::string& code,
                               const std::string& language) {
-    BuildDir tmp(source_id_, source_dir_);
-    std::optional<std::filesystem::path> source_file =
+    BuildDir tmp(scratch(), source_id_);
+    const ScratchFile* source_file =
         tmp.write_source(code, get_file_extension(language));
-    if (!source_file) return false;
+    if (source_file == nullptr) return false;
+    record_prologue(*source_file, language);
 
     std::vector<std::string> cmd = get_compiler_and_flags(language);
     bool msvc = config_.compiler_type.rfind("msvc", 0) == 0;
@@ -307,26 +418,65 @@ bool CheckRunner::try_compile(const std::string& code,
     if (msvc) {
         cmd.push_back("/c");
         cmd.push_back("/Fo" + tmp.object_path(true).string());
-        cmd.push_back(source_file->string());
+        cmd.push_back(source_file->path().string());
     } else {
         cmd.push_back("-c");
-        cmd.push_back(source_file->string());
+        append_source(cmd, *source_file, language);
         cmd.push_back("-o");
         cmd.push_back(tmp.object_path(false).string());
     }
 
-    return run_command("compile", cmd) == 0;
+    return run_probe(make_record(ProbeKind::kCompile, code, language), {cmd},
+                     tmp.scratch_paths(), [&]() {
+                         return run_command("compile", cmd, probe_log_,
+                                            code, tmp.scratch_paths()) == 0;
+                     });
 }
 
-bool CheckRunner::try_link(const std::filesystem::path& object_file,
-                           const std::filesystem::path& executable,
-                           const std::string& language) {
+bool CheckRunner::try_compile_with_flags(
+    const std::string& code, const std::string& language,
+    const std::vector<std::string>& flags, std::string& output) {
+    BuildDir tmp(scratch(), source_id_);
+    const ScratchFile* source_file =
+        tmp.write_source(code, get_file_extension(language));
+    if (source_file == nullptr) return false;
+
+    std::vector<std::string> cmd = get_compiler_and_flags(language);
+    cmd.insert(cmd.end(), flags.begin(), flags.end());
+    bool msvc = config_.compiler_type.rfind("msvc", 0) == 0;
+
+    if (msvc) {
+        cmd.push_back("/c");
+        cmd.push_back("/Fo" + tmp.object_path(true).string());
+        cmd.push_back(source_file->path().string());
+    } else {
+        cmd.push_back("-c");
+        append_source(cmd, *source_file, language);
+        cmd.push_back("-o");
+        cmd.push_back(tmp.object_path(false).string());
+    }
+
+    ProbeRecord record =
+        make_record(ProbeKind::kCompileWithFlags, code, language);
+    record.flags = flags;
+    // The caller reads the diagnostics, so an identical probe cannot answer.
+    return run_probe(
+        std::move(record), {cmd}, tmp.scratch_paths(),
+        [&]() {
+            return run_command_capture("compile flags", cmd, output) == 0;
+        },
+        /*coalesce=*/false);
+}
+
+std::vector<std::string> CheckRunner::link_command(
+    const std::filesystem::path& object_file,
+    const std::filesystem::path& executable, const std::string& language) {
     std::vector<std::string> cmd;
     bool msvc = config_.compiler_type.rfind("msvc", 0) == 0;
 
     if (msvc) {
         cmd.push_back(config_.linker);
-        DebugLogger::debug("Linker tool path: [" + config_.linker + "]");
+        AUTOCONF_TRACE_DEBUG("Linker tool", {"path", config_.linker});
         std::vector<std::string> link_flags = filter_error_flags(
             is_cpp(language) ? config_.cpp_link_flags : config_.c_link_flags);
         cmd.insert(cmd.end(), link_flags.begin(), link_flags.end());
@@ -338,9 +488,10 @@ bool CheckRunner::try_link(const std::filesystem::path& object_file,
                 ? (is_cpp(language) ? config_.cpp_compiler : config_.c_compiler)
                 : config_.linker;
         if (!config_.linker.empty()) {
-            DebugLogger::debug("Linker tool path: [" + config_.linker + "]");
+            AUTOCONF_TRACE_DEBUG("Linker tool", {"path", config_.linker});
         } else {
-            DebugLogger::debug("Using compiler as linker: [" + link_tool + "]");
+            AUTOCONF_TRACE_DEBUG("Using compiler as linker",
+                                 {"path", link_tool});
         }
         cmd.push_back(link_tool);
         std::vector<std::string> link_flags = filter_error_flags(
@@ -351,15 +502,16 @@ bool CheckRunner::try_link(const std::filesystem::path& object_file,
         cmd.push_back(executable.string());
     }
 
-    return run_command("link", cmd) == 0;
+    return cmd;
 }
 
 bool CheckRunner::try_compile_and_link(const std::string& code,
                                        const std::string& language) {
-    BuildDir tmp(source_id_, source_dir_);
-    std::optional<std::filesystem::path> source_file =
+    BuildDir tmp(scratch(), source_id_);
+    const ScratchFile* source_file =
         tmp.write_source(code, get_file_extension(language));
-    if (!source_file) return false;
+    if (source_file == nullptr) return false;
+    record_prologue(*source_file, language);
 
     bool msvc = config_.compiler_type.rfind("msvc", 0) == 0;
 
@@ -371,8 +523,15 @@ bool CheckRunner::try_compile_and_link(const std::string& code,
         std::vector<std::string> cmd = get_compiler_and_link_flags(language);
         std::filesystem::path exe = tmp.executable_path();
         cmd.push_back("/Fe" + exe.string());
-        cmd.push_back(source_file->string());
-        return run_command("compile and link", cmd) == 0;
+        cmd.push_back(source_file->path().string());
+        return run_probe(
+            make_record(ProbeKind::kCompileAndLink, code, language), {cmd},
+            tmp.scratch_paths(), [&]() {
+                int status = run_command("compile and link", cmd,
+                                         probe_log_, code,
+                                         tmp.scratch_paths());
+                return status == 0;
+            });
     }
 
     // GCC/Clang: compile then link separately
@@ -380,44 +539,276 @@ bool CheckRunner::try_compile_and_link(const std::string& code,
     std::filesystem::path obj = tmp.object_path(false);
 
     cmd.push_back("-c");
-    cmd.push_back(source_file->string());
+    append_source(cmd, *source_file, language);
     cmd.push_back("-o");
     cmd.push_back(obj.string());
 
-    if (run_command("compile", cmd) != 0) {
-        DebugLogger::warn("Compilation failed");
-        return false;
-    }
-
-    // Step 2: Link
     std::filesystem::path exe = tmp.executable_path();
-    return try_link(obj, exe, language);
+    std::vector<std::string> link_cmd = link_command(obj, exe, language);
+
+    ProbeRecord record =
+        make_record(ProbeKind::kCompileAndLink, code, language);
+    return run_probe(std::move(record), {cmd, link_cmd}, tmp.scratch_paths(),
+                     [&]() {
+                         if (run_command("compile", cmd, probe_log_, code,
+                                         tmp.scratch_paths()) != 0) {
+                             AUTOCONF_TRACE_WARN("Compilation failed");
+                             return false;
+                         }
+
+                         // Step 2: Link
+                         return run_command("link", link_cmd, probe_log_,
+                                            code, tmp.scratch_paths()) == 0;
+                     });
 }
 
 bool CheckRunner::try_compile_and_link_with_lib(const std::string& code,
                                                 const std::string& library,
                                                 const std::string& language) {
-    BuildDir tmp(source_id_, source_dir_);
-    std::optional<std::filesystem::path> source_file =
+    // Named per library: search_libs may probe several libraries at once.
+    BuildDir tmp(scratch(), source_id_ + "." + library);
+    const ScratchFile* source_file =
         tmp.write_source(code, get_file_extension(language));
-    if (!source_file) return false;
+    if (source_file == nullptr) return false;
+    record_prologue(*source_file, language);
 
     std::vector<std::string> cmd = get_compiler_and_link_flags(language);
     bool msvc = config_.compiler_type.rfind("msvc", 0) == 0;
 
     if (msvc) {
-        std::filesystem::path exe = tmp.dir / (tmp.safe_id + ".exe");
+        std::filesystem::path exe = tmp.executable_path();
         cmd.push_back("/Fe" + exe.string());
-        cmd.push_back(source_file->string());
+        cmd.push_back(source_file->path().string());
         cmd.push_back(library + ".lib");
     } else {
-        cmd.push_back(source_file->string());
+        append_source(cmd, *source_file, language);
         cmd.push_back("-o");
-        cmd.push_back((tmp.dir / tmp.safe_id).string());
+        cmd.push_back(tmp.executable_path().string());
         cmd.push_back("-l" + library);
     }
 
-    return run_command("compile and link", cmd) == 0;
+    ProbeRecord record =
+        make_record(ProbeKind::kCompileAndLinkWithLib, code, language);
+    record.library = library;
+    return run_probe(std::move(record), {cmd}, tmp.scratch_paths(), [&]() {
+        return run_command("compile and link", cmd, probe_log_, code,
+                           tmp.scratch_paths()) == 0;
+    });
+}
+
+bool CheckRunner::run_probe(
+    ProbeRecord record, const std::vector<std::vector<std::string>>& commands,
+    const std::vector<std::string>& scratch_paths,
+    const std::function<bool()>& probe, bool coalesce) {
+    // Only timed when the commands run here, not when another checker
+    // answers.
+    int64_t duration_us = -1;
+    std::function<bool()> timed = [&]() {
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        bool success = probe();
+        duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+        return success;
+    };
+    bool success = false;
+    if (coalesce && probe_coalescer_ != nullptr) {
+        std::error_code ec;
+        std::filesystem::path cwd = std::filesystem::current_path(ec);
+        success = probe_coalescer_->run(
+            probe_key(commands, scratch_paths, record.code, cwd), timed);
+    } else {
+        success = timed();
+    }
+
+    // The commands of a probe answered by another checker never reach
+    // run_command(), so its failure is noted here instead.
+    if (duration_us < 0 && !success && probe_log_ != nullptr &&
+        !commands.empty()) {
+        probe_log_->record(ProbeFailure{
+            "coalesced probe", normalize_probe_argv(commands.back(),
+                                                    scratch_paths),
+            -1,
+            "not run in this action: an identical probe run by another "
+            "checker failed; see that checker's config.log\n",
+            0, record.code});
+    }
+
+    if (probe_recorder_ != nullptr) {
+        for (const std::vector<std::string>& command : commands) {
+            record.commands.push_back(
+                normalize_probe_argv(command, scratch_paths));
+        }
+        record.success = success;
+        record.duration_us = duration_us;
+        probe_recorder_->record(std::move(record));
+    }
+    return success;
+}
+
+bool CheckRunner::replay_probe(const ProbeRecord& record) {
+    switch (record.kind) {
+        case ProbeKind::kCompile:
+            return try_compile(record.code, record.language);
+        case ProbeKind::kCompileAndLink:
+            return try_compile_and_link(record.code, record.language);
+        case ProbeKind::kCompileAndLinkWithLib:
+            return try_compile_and_link_with_lib(record.code, record.library,
+                                                 record.language);
+        case ProbeKind::kCompileWithFlags: {
+            std::string output;
+            return try_compile_with_flags(record.code, record.language,
+                                          record.flags, output);
+        }
+    }
+    return false;
+}
+
+std::optional<size_t> CheckRunner::first_success(
+    const std::vector<std::function<bool()>>& probes) {
+    // The prologue profile is recorded by whichever probe compiles first,
+    // which is only well defined sequentially.
+    bool profiling = profile_prologue_ && !prologue_profile_.has_value();
+    if (job_server_ == nullptr || !job_server_->parallel() || profiling ||
+        probes.size() < 2) {
+        for (size_t i = 0; i < probes.size(); ++i) {
+            if (probes[i]()) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Created before the workers, which only share it.
+    scratch();
+
+    // Workers take probes in order once they hold a job slot, so earlier
+    // probes start first and later ones can be skipped.
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> first{probes.size()};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    std::vector<std::thread> workers;
+    workers.reserve(probes.size());
+    for (size_t w = 0; w < probes.size(); ++w) {
+        workers.emplace_back([&]() {
+            JobServer::Token token = job_server_->acquire();
+            size_t i = next++;
+            if (first.load() < i) {
+                return;
+            }
+            try {
+                if (probes[i]()) {
+                    size_t current = first.load();
+                    while (i < current &&
+                           !first.compare_exchange_weak(current, i)) {
+                    }
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (first.load() == probes.size()) {
+        return std::nullopt;
+    }
+    return first.load();
+}
+
+void CheckRunner::record_prologue(const ScratchFile& source,
+                                  const std::string& language) {
+    if (!profile_prologue_ || prologue_profile_.has_value()) {
+        return;
+    }
+    bool msvc = config_.compiler_type.rfind("msvc", 0) == 0;
+    PrologueProfile profile;
+
+    // Frontend time: a syntax-only compile, which also traces includes.
+    std::vector<std::string> cmd = get_compiler_and_flags(language);
+    if (msvc) {
+        cmd.push_back("/Zs");
+        cmd.push_back("/showIncludes");
+        cmd.push_back(source.path().string());
+    } else {
+        cmd.push_back("-fsyntax-only");
+        cmd.push_back("-H");
+        append_source(cmd, source, language);
+    }
+    std::string trace;
+    auto start = std::chrono::steady_clock::now();
+    run_command_capture("prologue trace", cmd, trace);
+    profile.frontend_ms = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+    if (msvc) {
+        parse_msvc_include_trace(trace, profile);
+    } else {
+        parse_gcc_include_trace(trace, profile);
+    }
+
+    // Bytes the frontend has to tokenize after preprocessing.
+    std::vector<std::string> pp_cmd = get_compiler_and_flags(language);
+    if (msvc) {
+        pp_cmd.push_back("/EP");
+        pp_cmd.push_back(source.path().string());
+    } else {
+        pp_cmd.push_back("-E");
+        append_source(pp_cmd, source, language);
+    }
+    std::string preprocessed;
+    run_command_capture("preprocess", pp_cmd, preprocessed);
+    profile.preprocessed_bytes = preprocessed.size();
+
+    prologue_profile_ = std::move(profile);
+}
+
+std::optional<std::string> CheckRunner::link_trace(
+    const std::string& language) {
+    BuildDir tmp(scratch(), source_id_);
+    const ScratchFile* source_file = tmp.write_source(
+        "int main(void) { return 0; }\n", get_file_extension(language));
+    if (source_file == nullptr) return std::nullopt;
+
+    std::vector<std::string> cmd = get_compiler_and_flags(language);
+    std::filesystem::path obj = tmp.object_path(false);
+    cmd.push_back("-c");
+    append_source(cmd, *source_file, language);
+    cmd.push_back("-o");
+    cmd.push_back(obj.string());
+    if (run_command("compile", cmd) != 0) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> link_cmd;
+    link_cmd.push_back(
+        config_.linker.empty()
+            ? (is_cpp(language) ? config_.cpp_compiler : config_.c_compiler)
+            : config_.linker);
+    std::vector<std::string> link_flags = filter_error_flags(
+        is_cpp(language) ? config_.cpp_link_flags : config_.c_link_flags);
+    link_cmd.insert(link_cmd.end(), link_flags.begin(), link_flags.end());
+    link_cmd.push_back(obj.string());
+    link_cmd.push_back("-o");
+    link_cmd.push_back(tmp.executable_path().string());
+    // Have the linker list every input file it opens.
+    link_cmd.push_back("-Wl,-t");
+
+    std::string output;
+    if (run_command_capture("link trace", link_cmd, output) != 0) {
+        AUTOCONF_TRACE_DEBUG("Link trace failed", {"output", output});
+        return std::nullopt;
+    }
+    return output;
 }
 
 }  // namespace rules_cc_autoconf
@@ -0,0 +1,152 @@
+#include "autoconf/private/checker/compiler_flags.h"
+
+#include <algorithm>
+#include <cctype>
+#include <set>
+#include <sstream>
+
+namespace rules_cc_autoconf {
+
+namespace {
+
+/** Phrases GCC, Clang and MSVC use when refusing an option. */
+constexpr const char* kRejectionMarkers[] = {
+    "unrecognized", "unrecognised",  "unknown",      "unsupported",
+    "not supported", "bad value",    "out of range",
+};
+
+/**
+ * Phrases that may also describe an accepted option, e.g. one that has no
+ * effect on a compile-only run.
+ */
+constexpr const char* kSuspectMarkers[] = {
+    "unused",
+    "ignoring",
+    "invalid",
+    "argument to",
+};
+
+/** @brief How strongly a diagnostic line blames the option it quotes. */
+enum class Blame { kNone, kSuspected, kRejected };
+
+/**
+ * @brief Classify a diagnostic line.
+ */
+Blame classify_line(const std::string& line) {
+    std::string lower;
+    lower.reserve(line.size());
+    for (char c : line) {
+        lower.push_back(static_cast<char>(
+            std::tolower(static_cast<unsigned char>(c))));
+    }
+    // GCC accepts unknown `-Wno-*` options and only mentions them when some
+    // other diagnostic fails the compile; they are not rejected on their own.
+    if (lower.find("may have been intended to silence") != std::string::npos) {
+        return Blame::kNone;
+    }
+    for (const char* marker : kRejectionMarkers) {
+        if (lower.find(marker) != std::string::npos) {
+            return Blame::kRejected;
+        }
+    }
+    for (const char* marker : kSuspectMarkers) {
+        if (lower.find(marker) != std::string::npos) {
+            return Blame::kSuspected;
+        }
+    }
+    return Blame::kNone;
+}
+
+/**
+ * @brief Collect the quoted tokens of a diagnostic line.
+ *
+ * Handles ASCII quotes ('x', "x", `x') and the UTF-8 typographic quotes
+ * GCC uses in UTF-8 locales.
+ */
+std::vector<std::string> quoted_tokens(const std::string& line) {
+    static const std::string kOpenUtf8 = "\xE2\x80\x98";
+    static const std::string kCloseUtf8 = "\xE2\x80\x99";
+
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    while (i < line.size()) {
+        size_t close = std::string::npos;
+        size_t begin = 0;
+        if (line.compare(i, kOpenUtf8.size(), kOpenUtf8) == 0) {
+            begin = i + kOpenUtf8.size();
+            close = line.find(kCloseUtf8, begin);
+        } else if (line[i] == '\'' || line[i] == '"' || line[i] == '`') {
+            begin = i + 1;
+            close = line.find(line[i] == '"' ? '"' : '\'', begin);
+        } else {
+            ++i;
+            continue;
+        }
+        if (close == std::string::npos) {
+            break;
+        }
+        tokens.push_back(line.substr(begin, close - begin));
+        i = close + (line[close] == '\xE2' ? kCloseUtf8.size() : 1);
+    }
+    return tokens;
+}
+
+}  // namespace
+
+FlagDiagnostics find_rejected_flags(const std::string& output,
+                                    const std::vector<std::string>& flags) {
+    std::set<size_t> rejected;
+    std::set<size_t> suspected;
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        Blame blame = classify_line(line);
+        if (blame == Blame::kNone) continue;
+        std::set<size_t>& blamed =
+            blame == Blame::kRejected ? rejected : suspected;
+
+        // The rejected option is the first quoted flag on the line; later
+        // quotes are suggestions ("did you mean '-Wfloat'?") or values.
+        for (const std::string& token : quoted_tokens(line)) {
+            if (token.empty()) continue;
+
+            std::vector<size_t> exact;
+            std::vector<size_t> prefix;
+            for (size_t i = 0; i < flags.size(); ++i) {
+                const std::string& flag = flags[i];
+                if (flag == token) {
+                    exact.push_back(i);
+                    continue;
+                }
+                // `-fsanitize=bogus` -> "unrecognized argument to
+                // '-fsanitize=' option".
+                size_t eq = flag.find('=');
+                if (eq != std::string::npos && token.back() == '=' &&
+                    flag.compare(0, eq + 1, token) == 0) {
+                    prefix.push_back(i);
+                }
+            }
+            if (!exact.empty()) {
+                blamed.insert(exact.begin(), exact.end());
+                break;
+            }
+            if (prefix.size() == 1) {
+                blamed.insert(prefix.front());
+            }
+            if (!prefix.empty()) {
+                break;
+            }
+        }
+    }
+
+    FlagDiagnostics diagnostics;
+    diagnostics.rejected.assign(rejected.begin(), rejected.end());
+    for (size_t i : suspected) {
+        if (rejected.count(i) == 0) {
+            diagnostics.suspected.push_back(i);
+        }
+    }
+    return diagnostics;
+}
+
+}  // namespace rules_cc_autoconf
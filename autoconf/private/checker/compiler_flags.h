@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace rules_cc_autoconf {
+
+/**
+ * @brief Flags named by compiler diagnostics, as indices into the tested
+ * flags (ascending).
+ */
+struct FlagDiagnostics {
+    ///< Flags the compiler refused as unrecognized or unknown
+    std::vector<size_t> rejected{};
+    ///< Flags only named by a weaker diagnostic ("unused", "ignoring",
+    ///< "invalid", "argument to"); they may merely be inert for this compile
+    std::vector<size_t> suspected{};
+};
+
+/**
+ * @brief Find the flags a compiler rejected, from its diagnostics.
+ *
+ * GCC, Clang and MSVC name each rejected option in a diagnostic such as
+ * `unrecognized command-line option '-Wfoo'`, `unknown argument: '-ffoo'`
+ * or `ignoring unknown option '/foo'`. Diagnostics such as clang's
+ * `argument unused during compilation: '-ffoo'` do not prove the flag is
+ * unsupported, so those flags are only suspected; the caller confirms them
+ * with a compile of their own. A flag is attributed when a diagnostic
+ * quotes it exactly, or quotes its `-opt=` prefix and no other tested flag
+ * shares that prefix. Lines that cannot be attributed are ignored; the
+ * caller bisects when the compile failed without naming a flag.
+ *
+ * @param output Combined stdout/stderr of the compiler.
+ * @param flags The flags passed to the compiler.
+ * @return The rejected and suspected flags.
+ */
+FlagDiagnostics find_rejected_flags(const std::string& output,
+                                    const std::vector<std::string>& flags);
+
+}  // namespace rules_cc_autoconf
@@ -0,0 +1,135 @@
+#include "autoconf/private/checker/compiler_flags.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using rules_cc_autoconf::find_rejected_flags;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+static bool test_gcc_unrecognized() {
+    std::vector<std::string> flags = {"-Wall", "-Wfoo", "-std=c99x", "-O2"};
+    std::string output =
+        "gcc: error: unrecognized command-line option '-Wfoo'\n"
+        "gcc: error: unrecognized command-line option '-std=c99x'; did you "
+        "mean '-std=c99'?\n";
+    return find_rejected_flags(output, flags).rejected ==
+           std::vector<size_t>{1, 2};
+}
+
+static bool test_gcc_utf8_quotes() {
+    std::vector<std::string> flags = {"-Wfoo", "-Wextra"};
+    std::string output =
+        "gcc: error: unrecognized command-line option "
+        "\xE2\x80\x98-Wfoo\xE2\x80\x99\n";
+    return find_rejected_flags(output, flags).rejected ==
+           std::vector<size_t>{0};
+}
+
+static bool test_suggestion_not_rejected() {
+    // The suggestion names an accepted flag that is also being tested.
+    std::vector<std::string> flags = {"-Wfloat", "-Wflaot"};
+    std::string output =
+        "cc1: error: unrecognized command-line option '-Wflaot'; did you "
+        "mean '-Wfloat'?\n";
+    return find_rejected_flags(output, flags).rejected ==
+           std::vector<size_t>{1};
+}
+
+static bool test_gcc_wno_note() {
+    std::vector<std::string> flags = {"-Wno-such", "-Wfoo"};
+    std::string output =
+        "gcc: error: unrecognized command-line option '-Wfoo'\n"
+        "cc1: note: unrecognized command-line option '-Wno-such' may have "
+        "been intended to silence earlier diagnostics\n";
+    return find_rejected_flags(output, flags).rejected ==
+           std::vector<size_t>{1};
+}
+
+static bool test_value_prefix() {
+    std::vector<std::string> flags = {"-fsanitize=bogus", "-Wall"};
+    std::string output =
+        "gcc: error: unrecognized argument to '-fsanitize=' option: "
+        "'bogus'\n";
+    return find_rejected_flags(output, flags).rejected ==
+           std::vector<size_t>{0};
+}
+
+static bool test_ambiguous_prefix() {
+    // Two flags share the prefix: neither is blamed, the caller bisects.
+    std::vector<std::string> flags = {"-fsanitize=bogus", "-fsanitize=address"};
+    std::string output =
+        "gcc: error: unrecognized argument to '-fsanitize=' option: "
+        "'bogus'\n";
+    return find_rejected_flags(output, flags).rejected.empty();
+}
+
+static bool test_clang_formats() {
+    std::vector<std::string> flags = {"-ffoo", "-Wall", "-Wbaz"};
+    std::string output =
+        "clang: error: unknown argument: '-ffoo'\n"
+        "warning: unknown warning option '-Wbaz' [-Wunknown-warning-option]\n";
+    return find_rejected_flags(output, flags).rejected ==
+           std::vector<size_t>{0, 2};
+}
+
+static bool test_unused_only_suspected() {
+    // Inert with -c, but not unsupported: confirmed by a compile of its own.
+    std::vector<std::string> flags = {"-Wall", "-fbar", "-ffoo"};
+    std::string output =
+        "clang: warning: argument unused during compilation: '-fbar' "
+        "[-Wunused-command-line-argument]\n"
+        "clang: error: unknown argument: '-ffoo'\n"
+        "clang: warning: argument unused during compilation: '-ffoo'\n";
+    rules_cc_autoconf::FlagDiagnostics diagnostics =
+        find_rejected_flags(output, flags);
+    return diagnostics.rejected == std::vector<size_t>{2} &&
+           diagnostics.suspected == std::vector<size_t>{1};
+}
+
+static bool test_msvc_format() {
+    std::vector<std::string> flags = {"/W4", "/foo"};
+    std::string output =
+        "cl : Command line warning D9002 : ignoring unknown option '/foo'\n";
+    return find_rejected_flags(output, flags).rejected ==
+           std::vector<size_t>{1};
+}
+
+static bool test_unrelated_diagnostics() {
+    std::vector<std::string> flags = {"-Wall", "-O2"};
+    std::string output =
+        "conftest.c:1:1: error: unknown type name 'foo'\n"
+        "conftest.c:3:5: warning: unused variable 'x'\n";
+    return find_rejected_flags(output, flags).rejected.empty();
+}
+
+int main() {
+    std::cout << "compiler_flags_test:" << std::endl;
+    TEST(gcc_unrecognized)
+    TEST(gcc_utf8_quotes)
+    TEST(suggestion_not_rejected)
+    TEST(gcc_wno_note)
+    TEST(value_prefix)
+    TEST(ambiguous_prefix)
+    TEST(clang_formats)
+    TEST(unused_only_suspected)
+    TEST(msvc_format)
+    TEST(unrelated_diagnostics)
+
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
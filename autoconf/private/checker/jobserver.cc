@@ -0,0 +1,234 @@
+#include "autoconf/private/checker/jobserver.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+#include "autoconf/private/common/trace.h"
+
+namespace rules_cc_autoconf {
+
+namespace {
+
+#ifndef _WIN32
+/** How long a waiting job polls the jobserver before rechecking local slots */
+constexpr int kTokenPollMs = 50;
+#endif
+
+/**
+ * @brief Parse `R,W` into two non-negative descriptors.
+ */
+bool parse_fd_pair(const std::string& value, JobServerAuth& auth) {
+    size_t comma = value.find(',');
+    if (comma == std::string::npos) {
+        return false;
+    }
+    char* end = nullptr;
+    std::string read_str = value.substr(0, comma);
+    std::string write_str = value.substr(comma + 1);
+    long read_fd = std::strtol(read_str.c_str(), &end, 10);
+    if (read_str.empty() || *end != '\0') {
+        return false;
+    }
+    long write_fd = std::strtol(write_str.c_str(), &end, 10);
+    if (write_str.empty() || *end != '\0') {
+        return false;
+    }
+    if (read_fd < 0 || write_fd < 0) {
+        return false;
+    }
+    auth.read_fd = static_cast<int>(read_fd);
+    auth.write_fd = static_cast<int>(write_fd);
+    return true;
+}
+
+}  // namespace
+
+std::optional<JobServerAuth> parse_jobserver_auth(
+    const std::string& makeflags) {
+    static const std::string kAuth = "--jobserver-auth=";
+    static const std::string kFds = "--jobserver-fds=";
+
+    std::optional<std::string> value;
+    std::istringstream words(makeflags);
+    std::string word;
+    while (words >> word) {
+        if (word == "--") {
+            break;
+        }
+        if (word.rfind(kAuth, 0) == 0) {
+            value = word.substr(kAuth.size());
+        } else if (word.rfind(kFds, 0) == 0) {
+            value = word.substr(kFds.size());
+        }
+    }
+    if (!value.has_value()) {
+        return std::nullopt;
+    }
+
+    JobServerAuth auth;
+    if (value->rfind("fifo:", 0) == 0) {
+        auth.fifo = value->substr(5);
+        if (auth.fifo.empty()) {
+            return std::nullopt;
+        }
+        return auth;
+    }
+    if (!parse_fd_pair(*value, auth)) {
+        return std::nullopt;
+    }
+    return auth;
+}
+
+JobServer::Token::Token(JobServer* owner, std::optional<char> byte)
+    : owner_(owner), byte_(byte) {}
+
+JobServer::Token::Token(Token&& other) noexcept
+    : owner_(std::exchange(other.owner_, nullptr)), byte_(other.byte_) {}
+
+JobServer::Token::~Token() {
+    if (owner_ != nullptr) {
+        owner_->release(byte_);
+    }
+}
+
+JobServer::JobServer(const std::optional<JobServerAuth>& auth,
+                     size_t fallback_jobs) {
+#ifndef _WIN32
+    if (auth.has_value() && !auth->fifo.empty()) {
+        int fd = open(auth->fifo.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd >= 0) {
+            read_fd_ = fd;
+            write_fd_ = fd;
+            owns_fds_ = true;
+        } else {
+            AUTOCONF_TRACE_DEBUG("Ignoring unusable jobserver fifo",
+                                 {"fifo", auth->fifo});
+        }
+    } else if (auth.has_value()) {
+        // make only passes the descriptors to recipes it knows run make
+        // (`+` lines, $(MAKE)); anywhere else they are closed or reused.
+        if (fcntl(auth->read_fd, F_GETFD) != -1 &&
+            fcntl(auth->write_fd, F_GETFD) != -1) {
+            read_fd_ = auth->read_fd;
+            write_fd_ = auth->write_fd;
+        } else {
+            AUTOCONF_TRACE_DEBUG(
+                "Ignoring jobserver descriptors not inherited from make",
+                {"read_fd", auth->read_fd}, {"write_fd", auth->write_fd});
+        }
+    }
+#else
+    (void)auth;
+#endif
+
+    if (read_fd_ >= 0) {
+        AUTOCONF_TRACE_DEBUG("Using the make jobserver for probe concurrency");
+        local_slots_ = 1;
+        parallel_ = true;
+    } else {
+        local_slots_ = std::max<size_t>(1, fallback_jobs);
+        parallel_ = local_slots_ > 1;
+    }
+}
+
+JobServer JobServer::from_environment(size_t fallback_jobs) {
+    const char* makeflags = std::getenv("MAKEFLAGS");
+    return JobServer(makeflags == nullptr
+                         ? std::nullopt
+                         : parse_jobserver_auth(makeflags),
+                     fallback_jobs);
+}
+
+JobServer::~JobServer() {
+#ifndef _WIN32
+    if (owns_fds_) {
+        close(read_fd_);
+    }
+#endif
+}
+
+bool JobServer::parallel() const { return parallel_; }
+
+JobServer::Token JobServer::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        if (local_slots_ > 0) {
+            --local_slots_;
+            return Token(this, std::nullopt);
+        }
+        if (read_fd_ < 0 || failed_) {
+            released_.wait(lock);
+            continue;
+        }
+
+        // Poll the jobserver in short rounds so a local slot freed in the
+        // meantime is noticed.
+        lock.unlock();
+        char byte = 0;
+        ReadResult result = read_token(byte);
+        lock.lock();
+        if (result == ReadResult::kToken) {
+            return Token(this, byte);
+        }
+        if (result == ReadResult::kFailed && !failed_) {
+            AUTOCONF_TRACE_WARN(
+                "The make jobserver stopped answering, running probes on "
+                "the implicit job slot only");
+            failed_ = true;
+        }
+    }
+}
+
+JobServer::ReadResult JobServer::read_token(char& byte) {
+#ifdef _WIN32
+    (void)byte;
+    return ReadResult::kFailed;
+#else
+    pollfd fds = {read_fd_, POLLIN, 0};
+    int ready = poll(&fds, 1, kTokenPollMs);
+    if (ready < 0) {
+        return errno == EINTR ? ReadResult::kTimeout : ReadResult::kFailed;
+    }
+    if (ready == 0) {
+        return ReadResult::kTimeout;
+    }
+    // Another client may take the token between poll() and read(); with a
+    // blocking descriptor that read would stall until the next token, which
+    // is still correct.
+    ssize_t n = read(read_fd_, &byte, 1);
+    if (n == 1) {
+        return ReadResult::kToken;
+    }
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return ReadResult::kTimeout;
+    }
+    return ReadResult::kFailed;
+#endif
+}
+
+void JobServer::release(const std::optional<char>& byte) {
+#ifndef _WIN32
+    if (byte.has_value()) {
+        while (write(write_fd_, &*byte, 1) < 0 && errno == EINTR) {
+        }
+        return;
+    }
+#else
+    (void)byte;
+#endif
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++local_slots_;
+    released_.notify_one();
+}
+
+}  // namespace rules_cc_autoconf
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace rules_cc_autoconf {
+
+/**
+ * @brief Where a GNU make jobserver hands out tokens.
+ */
+struct JobServerAuth {
+    std::string fifo{};  ///< Named pipe (`fifo:PATH`), or empty
+    int read_fd = -1;    ///< Inherited read end (`R,W`), or -1
+    int write_fd = -1;   ///< Inherited write end (`R,W`), or -1
+};
+
+/**
+ * @brief Find the jobserver advertised in a MAKEFLAGS value.
+ *
+ * Understands `--jobserver-auth=fifo:PATH` (make 4.4) and
+ * `--jobserver-auth=R,W` / `--jobserver-fds=R,W` (older makes); the last
+ * option wins. Variable assignments after `--` are ignored.
+ *
+ * @param makeflags The MAKEFLAGS value.
+ * @return The jobserver, or std::nullopt if none is advertised (or it is
+ * the Windows semaphore form).
+ */
+std::optional<JobServerAuth> parse_jobserver_auth(const std::string& makeflags);
+
+/**
+ * @brief Bounds the checker's concurrent probes.
+ *
+ * As a GNU make jobserver client, every job beyond the first (which runs on
+ * the token make implicitly granted this process) reads a token from the
+ * jobserver and writes it back when done, so compilers started by all
+ * actions sharing the jobserver stay within the parent's `-j`. Without a
+ * usable jobserver, at most `fallback_jobs` jobs run at once.
+ */
+class JobServer {
+   public:
+    /**
+     * @brief A job slot, returned on destruction.
+     */
+    class Token {
+       public:
+        Token(Token&& other) noexcept;
+        Token& operator=(Token&&) = delete;
+        Token(const Token&) = delete;
+        Token& operator=(const Token&) = delete;
+        ~Token();
+
+       private:
+        friend class JobServer;
+        Token(JobServer* owner, std::optional<char> byte);
+
+        JobServer* owner_;  ///< nullptr once moved from
+        ///< Byte read from the jobserver, or std::nullopt for a local slot
+        std::optional<char> byte_;
+    };
+
+    /**
+     * @param auth The jobserver to join, or std::nullopt.
+     * @param fallback_jobs Concurrent jobs without a usable jobserver
+     *                      (at least 1).
+     */
+    JobServer(const std::optional<JobServerAuth>& auth, size_t fallback_jobs);
+
+    /**
+     * @brief Join the jobserver advertised in `MAKEFLAGS`, if any.
+     * @param fallback_jobs Concurrent jobs without a usable jobserver.
+     */
+    static JobServer from_environment(size_t fallback_jobs);
+
+    ~JobServer();
+    JobServer(const JobServer&) = delete;
+    JobServer& operator=(const JobServer&) = delete;
+
+    /** @brief Whether more than one job can ever run at once. */
+    bool parallel() const;
+
+    /**
+     * @brief Wait for a job slot.
+     *
+     * Thread-safe. A jobserver that fails mid-build is abandoned; jobs then
+     * only run on the implicit slot.
+     */
+    Token acquire();
+
+   private:
+    int read_fd_ = -1;        ///< Jobserver read end, or -1
+    int write_fd_ = -1;       ///< Jobserver write end, or -1
+    bool owns_fds_ = false;   ///< Whether the fds were opened here (fifo)
+    bool failed_ = false;     ///< Whether the jobserver stopped answering
+    bool parallel_ = false;   ///< See parallel()
+    size_t local_slots_ = 1;  ///< Free slots not backed by the jobserver
+    std::mutex mutex_{};
+    std::condition_variable released_{};
+
+    /** Outcome of one attempt to read a jobserver token. */
+    enum class ReadResult { kToken, kTimeout, kFailed };
+
+    /**
+     * @brief Wait briefly for a jobserver token.
+     * @param byte Receives the token.
+     */
+    ReadResult read_token(char& byte);
+
+    /** @brief Return a slot. */
+    void release(const std::optional<char>& byte);
+};
+
+}  // namespace rules_cc_autoconf
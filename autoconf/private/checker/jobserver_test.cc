@@ -0,0 +1,142 @@
+#include "autoconf/private/checker/jobserver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using rules_cc_autoconf::JobServer;
+using rules_cc_autoconf::JobServerAuth;
+using rules_cc_autoconf::parse_jobserver_auth;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+static bool test_parse_fifo() {
+    std::optional<JobServerAuth> auth =
+        parse_jobserver_auth("-j8 --jobserver-auth=fifo:/tmp/GMfifo42");
+    return auth.has_value() && auth->fifo == "/tmp/GMfifo42" &&
+           auth->read_fd == -1;
+}
+
+static bool test_parse_fds() {
+    std::optional<JobServerAuth> old_make =
+        parse_jobserver_auth(" --jobserver-fds=3,4 -j");
+    std::optional<JobServerAuth> last_wins =
+        parse_jobserver_auth("--jobserver-auth=3,4 --jobserver-auth=5,6");
+    return old_make.has_value() && old_make->read_fd == 3 &&
+           old_make->write_fd == 4 && last_wins.has_value() &&
+           last_wins->read_fd == 5 && last_wins->write_fd == 6;
+}
+
+static bool test_parse_ignores_others() {
+    return !parse_jobserver_auth("").has_value() &&
+           !parse_jobserver_auth("-j4 -k").has_value() &&
+           !parse_jobserver_auth("--jobserver-auth=gmake_semaphore_1")
+                .has_value() &&
+           !parse_jobserver_auth("-- X=--jobserver-auth=3,4").has_value();
+}
+
+static bool test_fallback_caps_jobs() {
+    JobServer sequential(std::nullopt, 1);
+    JobServer server(std::nullopt, 2);
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 6; ++i) {
+        threads.emplace_back([&]() {
+            JobServer::Token token = server.acquire();
+            int now = ++running;
+            max_running = std::max(max_running.load(), now);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            --running;
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return !sequential.parallel() && server.parallel() && max_running == 2;
+}
+
+#ifndef _WIN32
+static bool test_pipe_tokens() {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    if (write(fds[1], "ab", 2) != 2) {
+        return false;
+    }
+
+    JobServerAuth auth;
+    auth.read_fd = fds[0];
+    auth.write_fd = fds[1];
+    bool ok = true;
+    {
+        JobServer server(auth, 8);
+        ok = ok && server.parallel();
+
+        // The implicit slot plus both tokens.
+        std::vector<JobServer::Token> tokens;
+        for (int i = 0; i < 3; ++i) {
+            tokens.push_back(server.acquire());
+        }
+        char byte = 0;
+        ok = ok && read(fds[0], &byte, 1) < 0;
+    }
+
+    // Every token went back.
+    char bytes[4] = {};
+    ssize_t n = read(fds[0], bytes, sizeof(bytes));
+    std::string returned(bytes, n > 0 ? static_cast<size_t>(n) : 0);
+    std::sort(returned.begin(), returned.end());
+    close(fds[0]);
+    close(fds[1]);
+    return ok && returned == "ab";
+}
+
+static bool test_closed_fds_fall_back() {
+    JobServerAuth auth;
+    auth.read_fd = 1000;
+    auth.write_fd = 1001;
+    JobServer server(auth, 1);
+    return !server.parallel();
+}
+#endif
+
+int main() {
+    std::cout << "jobserver_test:" << std::endl;
+    TEST(parse_fifo)
+    TEST(parse_fds)
+    TEST(parse_ignores_others)
+    TEST(fallback_caps_jobs)
+#ifndef _WIN32
+    TEST(pipe_tokens)
+    TEST(closed_fds_fall_back)
+#endif
+
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
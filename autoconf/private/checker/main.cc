@@ -5,11 +5,14 @@
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <optional>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 #include "autoconf/private/checker/checker.h"
+#include "autoconf/private/checker/probe_coalescer.h"
 #include "autoconf/private/common/action_args.h"
 
 using namespace rules_cc_autoconf;
@@ -23,16 +26,60 @@ struct CheckerArgs {
     /** Path to JSON config file (required if --check is not provided) */
     std::filesystem::path config_path{};
 
-    /** Path to JSON file containing a single check to run (required if --config
-     * is not provided) */
-    std::filesystem::path check_path{};
+    /** Paths to JSON files each containing a single check to run (required
+     * if --config is not provided). More than one batches compiler flag
+     * checks. */
+    std::vector<std::filesystem::path> check_paths{};
 
-    /** Path to JSON results file to write */
-    std::filesystem::path results_path{};
+    /** Paths to JSON results files to write, parallel to check_paths */
+    std::vector<std::filesystem::path> results_paths{};
 
     /** Optional: name->file mappings for dependent check results */
     std::vector<DepMapping> dep_mappings{};
 
+    /** Optional: output name->file mappings for derived check outputs */
+    std::map<std::string, std::filesystem::path> output_paths{};
+
+    /** Optional: toolchain symbol index consulted before linking */
+    std::filesystem::path symbol_index_path{};
+
+    /** Optional: where to write the prologue profile of each check; inputs
+     * of --prologue-report */
+    std::vector<std::filesystem::path> prologue_profile_paths{};
+
+    /** Summarize --prologue-profile files here instead of running a check */
+    std::filesystem::path prologue_report_path{};
+
+    /** Build a symbol index here instead of running a check */
+    std::filesystem::path build_symbol_index_path{};
+
+    /** Optional: socket of the daemon coalescing identical probes */
+    std::filesystem::path probe_socket_path{};
+
+    /** Serve probe coalescing on this socket instead of running a check */
+    std::filesystem::path probe_daemon_path{};
+
+    /** Settings of --probe-daemon */
+    ProbeDaemonOptions probe_daemon_options{};
+
+    /** Concurrent probes per check without a make jobserver */
+    size_t jobs = 1;
+
+    /** Optional: where to write the failed probe commands of the check */
+    std::vector<std::filesystem::path> config_log_paths{};
+
+    /** Optional: where to record every probe of the check; inputs of
+     * --replay-report */
+    std::vector<std::filesystem::path> probe_record_paths{};
+
+    /** Replay --probe-record files against --config and report here
+     * instead of running a check */
+    std::filesystem::path replay_report_path{};
+
+    /** Whether the action stages no toolchain, so the check must not
+     * probe */
+    bool no_toolchain = false;
+
     /** Whether to show help */
     bool show_help = false;
 };
@@ -44,12 +91,47 @@ void print_usage(const char* program_name) {
                  "if --check is not provided)\n";
     std::cout << "  --check <file>         Path to JSON file containing a "
                  "single check to run (required if --config is not provided)\n";
+    std::cout << "                         Repeat --check/--results pairs to "
+                 "batch compiler flag checks\n";
     std::cout << "  --results <file>       Path to JSON results file to write "
                  "(required)\n";
     std::cout << "  --dep <name>=<file>    Mapping of lookup name to result "
                  "file (can be repeated)\n";
     std::cout << "                         Example: "
                  "--dep=HAVE_FOO=/path/to/result.json\n";
+    std::cout << "  --output <name>=<file> Result file for a derived output "
+                 "of the check (can be repeated)\n";
+    std::cout << "  --config-log <file>    Write the failed probe commands "
+                 "of the check and their output\n";
+    std::cout << "  --symbol-index <file>  Toolchain symbol index consulted "
+                 "by function/lib checks before linking\n";
+    std::cout << "  --build-symbol-index <file>\n";
+    std::cout << "                         Write the symbol index for the "
+                 "--config toolchain instead of running a check\n";
+    std::cout << "  --prologue-profile <file>\n";
+    std::cout << "                         Write the include set, preprocessed "
+                 "size and frontend time of the check's probe\n";
+    std::cout << "  --prologue-report <file>\n";
+    std::cout << "                         Summarize the --prologue-profile "
+                 "files by include set instead of running a check\n";
+    std::cout << "  --probe-record <file>  Record every probe of the check "
+                 "with its outcome and duration\n";
+    std::cout << "  --replay-report <file>\n";
+    std::cout << "                         Replay the --probe-record files "
+                 "against --config instead of running a check\n";
+    std::cout << "  --jobs <n>             Probes a check (or --replay-report) "
+                 "may run at once when MAKEFLAGS has no jobserver (default: "
+                 "1)\n";
+    std::cout << "  --no-toolchain         Fail instead of probing: the "
+                 "action stages no toolchain\n";
+    std::cout << "  --probe-socket <file>  Coalesce identical probes with "
+                 "other checkers through the daemon on this socket\n";
+    std::cout << "                         (started on demand)\n";
+    std::cout << "  --probe-daemon <file>  Serve probe coalescing on this "
+                 "socket instead of running a check\n";
+    std::cout << "  --probe-daemon-jobs <n>\n";
+    std::cout << "                         Probes the daemon lets run at once "
+                 "(default: number of CPUs)\n";
     std::cout << "  --help                 Show this help message\n";
 }
 
@@ -73,6 +155,8 @@ std::optional<CheckerArgs> parse_args(int argc, char* argv[]) {
         if (arg == "--help" || arg == "-h") {
             args.show_help = true;
             return args;
+        } else if (arg == "--no-toolchain") {
+            args.no_toolchain = true;
         } else if (arg == "--config") {
             if (i + 1 < expanded_argc) {
                 args.config_path = std::string(expanded_argv_ptr[++i]);
@@ -83,19 +167,130 @@ std::optional<CheckerArgs> parse_args(int argc, char* argv[]) {
             }
         } else if (arg == "--check") {
             if (i + 1 < expanded_argc) {
-                args.check_path = std::string(expanded_argv_ptr[++i]);
+                args.check_paths.push_back(expanded_argv_ptr[++i]);
             } else {
                 std::cerr << "Error: --check requires a file path" << std::endl;
                 return std::nullopt;
             }
         } else if (arg == "--results") {
             if (i + 1 < expanded_argc) {
-                args.results_path = std::string(expanded_argv_ptr[++i]);
+                args.results_paths.push_back(expanded_argv_ptr[++i]);
             } else {
                 std::cerr << "Error: --results requires a file path"
                           << std::endl;
                 return std::nullopt;
             }
+        } else if (arg == "--output") {
+            if (i + 1 >= expanded_argc) {
+                std::cerr << "Error: --output requires a name=path pair"
+                          << std::endl;
+                return std::nullopt;
+            }
+            std::string value = expanded_argv_ptr[++i];
+            size_t eq_pos = value.find('=');
+            if (eq_pos == std::string::npos || eq_pos == 0 ||
+                eq_pos + 1 == value.size()) {
+                std::cerr << "Error: --output requires name=path format, got: "
+                          << value << std::endl;
+                return std::nullopt;
+            }
+            args.output_paths[value.substr(0, eq_pos)] =
+                value.substr(eq_pos + 1);
+        } else if (arg == "--config-log") {
+            if (i + 1 < expanded_argc) {
+                args.config_log_paths.push_back(expanded_argv_ptr[++i]);
+            } else {
+                std::cerr << "Error: --config-log requires a file path"
+                          << std::endl;
+                return std::nullopt;
+            }
+        } else if (arg == "--probe-record") {
+            if (i + 1 < expanded_argc) {
+                args.probe_record_paths.push_back(expanded_argv_ptr[++i]);
+            } else {
+                std::cerr << "Error: --probe-record requires a file path"
+                          << std::endl;
+                return std::nullopt;
+            }
+        } else if (arg == "--replay-report") {
+            if (i + 1 < expanded_argc) {
+                args.replay_report_path = std::string(expanded_argv_ptr[++i]);
+            } else {
+                std::cerr << "Error: --replay-report requires a file path"
+                          << std::endl;
+                return std::nullopt;
+            }
+        } else if (arg == "--symbol-index") {
+            if (i + 1 < expanded_argc) {
+                args.symbol_index_path = std::string(expanded_argv_ptr[++i]);
+            } else {
+                std::cerr << "Error: --symbol-index requires a file path"
+                          << std::endl;
+                return std::nullopt;
+            }
+        } else if (arg == "--build-symbol-index") {
+            if (i + 1 < expanded_argc) {
+                args.build_symbol_index_path =
+                    std::string(expanded_argv_ptr[++i]);
+            } else {
+                std::cerr << "Error: --build-symbol-index requires a file path"
+                          << std::endl;
+                return std::nullopt;
+            }
+        } else if (arg == "--prologue-profile") {
+            if (i + 1 < expanded_argc) {
+                args.prologue_profile_paths.push_back(expanded_argv_ptr[++i]);
+            } else {
+                std::cerr << "Error: --prologue-profile requires a file path"
+                          << std::endl;
+                return std::nullopt;
+            }
+        } else if (arg == "--prologue-report") {
+            if (i + 1 < expanded_argc) {
+                args.prologue_report_path = std::string(expanded_argv_ptr[++i]);
+            } else {
+                std::cerr << "Error: --prologue-report requires a file path"
+                          << std::endl;
+                return std::nullopt;
+            }
+        } else if (arg == "--probe-socket") {
+            if (i + 1 < expanded_argc) {
+                args.probe_socket_path = std::string(expanded_argv_ptr[++i]);
+            } else {
+                std::cerr << "Error: --probe-socket requires a file path"
+                          << std::endl;
+                return std::nullopt;
+            }
+        } else if (arg == "--probe-daemon") {
+            if (i + 1 < expanded_argc) {
+                args.probe_daemon_path = std::string(expanded_argv_ptr[++i]);
+            } else {
+                std::cerr << "Error: --probe-daemon requires a file path"
+                          << std::endl;
+                return std::nullopt;
+            }
+        } else if (arg == "--jobs") {
+            std::string value =
+                i + 1 < expanded_argc ? expanded_argv_ptr[++i] : "";
+            char* end = nullptr;
+            unsigned long jobs = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || jobs == 0) {
+                std::cerr << "Error: --jobs requires a positive number"
+                          << std::endl;
+                return std::nullopt;
+            }
+            args.jobs = jobs;
+        } else if (arg == "--probe-daemon-jobs") {
+            std::string value =
+                i + 1 < expanded_argc ? expanded_argv_ptr[++i] : "";
+            char* end = nullptr;
+            unsigned long jobs = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0') {
+                std::cerr << "Error: --probe-daemon-jobs requires a number"
+                          << std::endl;
+                return std::nullopt;
+            }
+            args.probe_daemon_options.jobs = jobs;
         } else if (arg == "--dep" || arg.rfind("--dep=", 0) == 0) {
             std::string value;
             if (arg == "--dep") {
@@ -134,29 +329,119 @@ std::optional<CheckerArgs> parse_args(int argc, char* argv[]) {
         }
     }
 
+    // --probe-daemon only serves its socket
+    if (!args.probe_daemon_path.empty()) {
+        return args;
+    }
+
+    // --prologue-report only reads the profiles
+    if (!args.prologue_report_path.empty()) {
+        return args;
+    }
+
+    // --replay-report runs the recorded probes with the toolchain config
+    if (!args.replay_report_path.empty()) {
+        if (args.config_path.empty()) {
+            std::cerr << "Error: --config is required when using "
+                         "--replay-report"
+                      << std::endl;
+            return std::nullopt;
+        }
+        return args;
+    }
+
+    // --build-symbol-index only needs the toolchain config
+    if (!args.build_symbol_index_path.empty()) {
+        if (args.config_path.empty()) {
+            std::cerr << "Error: --config is required when using "
+                         "--build-symbol-index"
+                      << std::endl;
+            return std::nullopt;
+        }
+        return args;
+    }
+
     // Validate required arguments
     // --check requires --config (config provides compiler info, check provides
     // the check to run)
-    if (args.check_path.empty() && args.config_path.empty()) {
+    if (args.check_paths.empty() && args.config_path.empty()) {
         std::cerr << "Error: --check is required to specify which check to run"
                   << std::endl;
         return std::nullopt;
     }
 
-    if (!args.check_path.empty() && args.config_path.empty()) {
+    if (!args.check_paths.empty() && args.config_path.empty()) {
         std::cerr << "Error: --config is required when using --check (provides "
                      "compiler information)"
                   << std::endl;
         return std::nullopt;
     }
 
-    if (args.results_path.empty()) {
+    if (args.results_paths.empty()) {
         std::cerr << "Error: --results is required" << std::endl;
         return std::nullopt;
     }
 
+    if (args.results_paths.size() != args.check_paths.size()) {
+        std::cerr << "Error: each --check requires a matching --results"
+                  << std::endl;
+        return std::nullopt;
+    }
+
+    // Flag batches have no per-check outputs.
+    bool per_check_outputs = args.check_paths.size() == 1;
+    if (!args.output_paths.empty() && !per_check_outputs) {
+        std::cerr << "Error: --output requires a single --check" << std::endl;
+        return std::nullopt;
+    }
+
+    if (args.no_toolchain && !per_check_outputs) {
+        std::cerr << "Error: --no-toolchain requires a single --check"
+                  << std::endl;
+        return std::nullopt;
+    }
+
+    const std::vector<std::pair<const char*,
+                                const std::vector<std::filesystem::path>*>>
+        per_check_paths = {
+            {"--config-log", &args.config_log_paths},
+            {"--probe-record", &args.probe_record_paths},
+            {"--prologue-profile", &args.prologue_profile_paths},
+        };
+    for (const auto& [flag, paths] : per_check_paths) {
+        if (paths->empty()) {
+            continue;
+        }
+        if (!per_check_outputs) {
+            std::cerr << "Error: " << flag << " requires a single --check"
+                      << std::endl;
+            return std::nullopt;
+        }
+        if (paths->size() != args.check_paths.size()) {
+            std::cerr << "Error: " << flag << " must be given once per --check"
+                      << std::endl;
+            return std::nullopt;
+        }
+    }
+
     return args;
 }
+
+/**
+ * @brief The settings of a check run given on the command line.
+ */
+CheckRunOptions run_options(const CheckerArgs& args) {
+    CheckRunOptions options;
+    options.symbol_index_path = args.symbol_index_path;
+    options.probe_socket_path = args.probe_socket_path;
+    options.jobs = args.jobs;
+    options.no_toolchain = args.no_toolchain;
+    options.prologue_profile_paths = args.prologue_profile_paths;
+    options.config_log_paths = args.config_log_paths;
+    options.probe_record_paths = args.probe_record_paths;
+    options.output_paths = args.output_paths;
+    return options;
+}
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -173,11 +458,39 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
+    if (!args.probe_daemon_path.empty()) {
+        return run_probe_daemon(args.probe_daemon_path,
+                                args.probe_daemon_options);
+    }
+
+    if (!args.prologue_report_path.empty()) {
+        return Checker::write_prologue_report(args.prologue_profile_paths,
+                                              args.prologue_report_path);
+    }
+
+    if (!args.replay_report_path.empty()) {
+        return Checker::replay_probes(args.probe_record_paths,
+                                      args.config_path,
+                                      args.replay_report_path, args.jobs);
+    }
+
+    if (!args.build_symbol_index_path.empty()) {
+        return Checker::build_symbol_index(args.config_path,
+                                           args.build_symbol_index_path);
+    }
+
+    // Several --check arguments form a batch of compiler flag checks
+    if (args.check_paths.size() > 1) {
+        return Checker::run_flag_checks_from_files(
+            args.check_paths, args.config_path, args.results_paths,
+            args.dep_mappings);
+    }
+
     // If --check is provided, run a single check from file
-    if (!args.check_path.empty()) {
-        return Checker::run_check_from_file(args.check_path, args.config_path,
-                                            args.results_path,
-                                            args.dep_mappings);
+    if (!args.check_paths.empty()) {
+        return Checker::run_check_from_file(
+            args.check_paths.front(), args.config_path,
+            args.results_paths.front(), args.dep_mappings, run_options(args));
     }
 
     // --check is required
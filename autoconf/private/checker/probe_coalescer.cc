@@ -0,0 +1,631 @@
+#include "autoconf/private/checker/probe_coalescer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#endif
+
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+#include "autoconf/private/common/trace.h"
+
+// Protocol: one line-based exchange per connection.
+//
+//   client: PROBE <key>
+//   daemon: HIT <0|1>     outcome of an identical running probe; closed
+//   daemon: RUN           the client runs the probe, then reports
+//   client: DONE <0|1>
+//
+// Clients asking for a key that is already running wait for the outcome of
+// the running probe.
+
+namespace rules_cc_autoconf {
+
+namespace {
+
+/**
+ * @brief FNV-1a, 64 bit, from the given offset basis.
+ */
+uint64_t fnv1a(const std::string& data, uint64_t hash) {
+    for (char c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Replace every occurrence of `from` in `s` with `to`.
+ */
+void replace_all(std::string& s, const std::string& from,
+                 const std::string& to) {
+    if (from.empty()) {
+        return;
+    }
+    size_t pos = 0;
+    while ((pos = s.find(from, pos)) != std::string::npos) {
+        s.replace(pos, from.size(), to);
+        pos += to.size();
+    }
+}
+
+#ifndef _WIN32
+
+/** How long a client waits for a daemon it started to accept connections. */
+constexpr int kDaemonStartAttempts = 50;
+constexpr std::chrono::milliseconds kDaemonStartInterval{20};
+
+/**
+ * @brief Fill a unix socket address.
+ * @return false if the path does not fit.
+ */
+bool make_address(const std::filesystem::path& path, sockaddr_un& address) {
+    std::string s = path.string();
+    address = {};
+    address.sun_family = AF_UNIX;
+    if (s.empty() || s.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    s.copy(address.sun_path, s.size());
+    return true;
+}
+
+/**
+ * @brief Send a whole line, without raising SIGPIPE.
+ */
+bool send_line(int fd, const std::string& line) {
+#ifdef MSG_NOSIGNAL
+    constexpr int kFlags = MSG_NOSIGNAL;
+#else
+    constexpr int kFlags = 0;
+#endif
+    std::string data = line + "\n";
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, kFlags);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * @brief Read one line from a blocking socket.
+ */
+std::optional<std::string> read_line(int fd) {
+    std::string line;
+    char c = 0;
+    while (true) {
+        ssize_t n = recv(fd, &c, 1, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return std::nullopt;
+        }
+        if (c == '\n') {
+            return line;
+        }
+        line.push_back(c);
+    }
+}
+
+/**
+ * @brief Path of the running executable.
+ */
+std::optional<std::string> self_executable() {
+#ifdef __APPLE__
+    uint32_t size = 0;
+    _NSGetExecutablePath(nullptr, &size);
+    std::string path(size, '\0');
+    if (_NSGetExecutablePath(path.data(), &size) != 0) {
+        return std::nullopt;
+    }
+    path.resize(path.find('\0'));
+    return path;
+#else
+    char buffer[PATH_MAX];
+    ssize_t n = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+    if (n <= 0) {
+        return std::nullopt;
+    }
+    return std::string(buffer, static_cast<size_t>(n));
+#endif
+}
+
+/**
+ * @brief Start `<self> --probe-daemon <socket>` detached from this process.
+ *
+ * The daemon is double-forked into its own session, with the standard
+ * streams on /dev/null, so the action running the checker neither waits for
+ * it nor shares its output.
+ */
+void spawn_daemon(const std::filesystem::path& socket_path) {
+    std::optional<std::string> self = self_executable();
+    if (!self.has_value()) {
+        return;
+    }
+    std::string socket = socket_path.string();
+
+    pid_t child = fork();
+    if (child < 0) {
+        return;
+    }
+    if (child == 0) {
+        setsid();
+        if (fork() != 0) {
+            _exit(0);
+        }
+        int null_fd = open("/dev/null", O_RDWR);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDIN_FILENO);
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+        }
+        long max_fd = sysconf(_SC_OPEN_MAX);
+        for (int fd = STDERR_FILENO + 1; fd < max_fd && fd < 1024; ++fd) {
+            close(fd);
+        }
+        if (chdir("/") != 0) {
+            _exit(1);
+        }
+        execl(self->c_str(), self->c_str(), "--probe-daemon", socket.c_str(),
+              static_cast<char*>(nullptr));
+        _exit(1);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+}
+
+/**
+ * @brief Connect to a unix socket.
+ * @return The connected socket, or -1.
+ */
+int connect_socket(const std::filesystem::path& path) {
+    sockaddr_un address;
+    if (!make_address(path, address)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) !=
+        0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Ask the daemon for the outcome of a probe, running it if elected.
+ * @return The outcome, or std::nullopt if the daemon failed before the
+ * probe ran (the caller then runs it).
+ */
+std::optional<bool> coalesce_with_daemon(int fd, const std::string& key,
+                                         const std::function<bool()>& probe) {
+    if (!send_line(fd, "PROBE " + key)) {
+        return std::nullopt;
+    }
+    std::optional<std::string> reply = read_line(fd);
+    if (!reply.has_value()) {
+        return std::nullopt;
+    }
+    if (*reply == "HIT 1" || *reply == "HIT 0") {
+        return *reply == "HIT 1";
+    }
+    if (*reply != "RUN") {
+        return std::nullopt;
+    }
+    bool outcome = probe();
+    send_line(fd, outcome ? "DONE 1" : "DONE 0");
+    return outcome;
+}
+
+/**
+ * @brief State of the daemon's event loop.
+ */
+class ProbeDaemon {
+   public:
+    ProbeDaemon(int listen_fd, const ProbeDaemonOptions& options)
+        : listen_fd_(listen_fd), options_(options) {
+        if (options_.jobs == 0) {
+            options_.jobs = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    /** @brief Serve until idle. */
+    void serve() {
+        Clock::time_point last_activity = Clock::now();
+        while (true) {
+            std::vector<pollfd> fds;
+            fds.push_back({listen_fd_, POLLIN, 0});
+            for (const auto& [fd, client] : clients_) {
+                fds.push_back({fd, POLLIN, 0});
+            }
+
+            int timeout = -1;
+            if (options_.idle_timeout.count() > 0 && clients_.empty()) {
+                auto idle =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        Clock::now() - last_activity);
+                if (idle >= options_.idle_timeout) {
+                    return;
+                }
+                timeout =
+                    static_cast<int>((options_.idle_timeout - idle).count());
+            }
+
+            int ready = poll(fds.data(), fds.size(), timeout);
+            if (ready < 0 && errno != EINTR) {
+                return;
+            }
+            if (ready <= 0) {
+                continue;
+            }
+            last_activity = Clock::now();
+
+            for (size_t i = 1; i < fds.size(); ++i) {
+                if (fds[i].revents != 0 && clients_.count(fds[i].fd) != 0) {
+                    read_client(fds[i].fd);
+                }
+            }
+            if ((fds[0].revents & POLLIN) != 0) {
+                int fd = accept(listen_fd_, nullptr, nullptr);
+                if (fd >= 0) {
+                    clients_[fd] = Client{};
+                }
+            }
+        }
+    }
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    /** What a connected client is doing. */
+    enum class State { kNew, kWaiting, kRunning };
+
+    struct Client {
+        std::string buffer{};
+        std::string key{};
+        State state = State::kNew;
+    };
+
+    /** A probe that is running or waiting for a slot. */
+    struct Flight {
+        int runner = -1;            ///< Client running the probe, or -1
+        std::deque<int> waiters{};  ///< Clients waiting for the outcome
+    };
+
+    int listen_fd_;
+    ProbeDaemonOptions options_;
+    std::map<int, Client> clients_{};
+    std::map<std::string, Flight> flights_{};
+    ///< Keys of flights without a runner, in arrival order
+    std::deque<std::string> pending_{};
+    size_t running_ = 0;
+
+    void read_client(int fd) {
+        char buffer[512];
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+                return;
+            }
+            close_client(fd);
+            return;
+        }
+        clients_[fd].buffer.append(buffer, static_cast<size_t>(n));
+
+        size_t newline = 0;
+        while (clients_.count(fd) != 0 &&
+               (newline = clients_[fd].buffer.find('\n')) !=
+                   std::string::npos) {
+            std::string line = clients_[fd].buffer.substr(0, newline);
+            clients_[fd].buffer.erase(0, newline + 1);
+            handle_line(fd, line);
+        }
+    }
+
+    void handle_line(int fd, const std::string& line) {
+        Client& client = clients_[fd];
+        if (client.state == State::kNew && line.rfind("PROBE ", 0) == 0) {
+            probe(fd, line.substr(6));
+        } else if (client.state == State::kRunning &&
+                   (line == "DONE 1" || line == "DONE 0")) {
+            done(fd, line == "DONE 1");
+        } else {
+            close_client(fd);
+        }
+    }
+
+    void probe(int fd, const std::string& key) {
+        Client& client = clients_[fd];
+        client.key = key;
+        client.state = State::kWaiting;
+        bool new_flight = flights_.count(key) == 0;
+        flights_[key].waiters.push_back(fd);
+        if (new_flight) {
+            pending_.push_back(key);
+            schedule();
+        }
+    }
+
+    void done(int fd, bool outcome) {
+        std::string key = clients_[fd].key;
+
+        Flight flight = std::move(flights_[key]);
+        flights_.erase(key);
+        for (int waiter : flight.waiters) {
+            send_line(waiter, outcome ? "HIT 1" : "HIT 0");
+            clients_[waiter].state = State::kNew;
+            close_client(waiter);
+        }
+        clients_[fd].state = State::kNew;
+        --running_;
+        close_client(fd);
+        schedule();
+    }
+
+    /** @brief Hand free slots to the oldest flights without a runner. */
+    void schedule() {
+        while (running_ < options_.jobs && !pending_.empty()) {
+            std::string key = pending_.front();
+            pending_.pop_front();
+            std::map<std::string, Flight>::iterator it = flights_.find(key);
+            if (it == flights_.end() || it->second.runner != -1) {
+                continue;
+            }
+            if (it->second.waiters.empty()) {
+                flights_.erase(it);
+                continue;
+            }
+            int fd = it->second.waiters.front();
+            it->second.waiters.pop_front();
+            it->second.runner = fd;
+            clients_[fd].state = State::kRunning;
+            ++running_;
+            if (!send_line(fd, "RUN")) {
+                close_client(fd);
+            }
+        }
+    }
+
+    void close_client(int fd) {
+        std::map<int, Client>::iterator it = clients_.find(fd);
+        if (it == clients_.end()) {
+            return;
+        }
+        Client client = std::move(it->second);
+        clients_.erase(it);
+        close(fd);
+
+        std::map<std::string, Flight>::iterator flight =
+            flights_.find(client.key);
+        if (client.state == State::kRunning && flight != flights_.end()) {
+            // The runner left without an outcome; the next waiter takes over.
+            --running_;
+            flight->second.runner = -1;
+            if (flight->second.waiters.empty()) {
+                flights_.erase(flight);
+            } else {
+                pending_.push_front(client.key);
+            }
+            schedule();
+        } else if (client.state == State::kWaiting &&
+                   flight != flights_.end()) {
+            std::deque<int>& waiters = flight->second.waiters;
+            for (std::deque<int>::iterator w = waiters.begin();
+                 w != waiters.end(); ++w) {
+                if (*w == fd) {
+                    waiters.erase(w);
+                    break;
+                }
+            }
+        }
+    }
+};
+
+#endif  // _WIN32
+
+}  // namespace
+
+std::string probe_key(const std::vector<std::vector<std::string>>& commands,
+                      const std::vector<std::string>& scratch_paths,
+                      const std::string& code,
+                      const std::filesystem::path& working_directory) {
+    std::string normalized = working_directory.string();
+    normalized.push_back('\n');
+    for (const std::vector<std::string>& command : commands) {
+        for (size_t i = 0; i < command.size(); ++i) {
+            std::string arg = command[i];
+            if (i == 0) {
+                std::error_code ec;
+                std::filesystem::path resolved =
+                    std::filesystem::canonical(arg, ec);
+                if (!ec) {
+                    arg = resolved.string();
+                }
+            }
+            for (size_t p = 0; p < scratch_paths.size(); ++p) {
+                replace_all(arg, scratch_paths[p],
+                            "@SCRATCH" + std::to_string(p) + "@");
+            }
+            normalized += arg;
+            normalized.push_back('\0');
+        }
+        normalized.push_back('\n');
+    }
+    normalized += code;
+
+    char buffer[33];
+    std::snprintf(
+        buffer, sizeof(buffer), "%016llx%016llx",
+        static_cast<unsigned long long>(
+            fnv1a(normalized, 14695981039346656037ULL)),
+        static_cast<unsigned long long>(
+            fnv1a(normalized, 0x84222325cbf29ce4ULL)));
+    return buffer;
+}
+
+int run_probe_daemon(const std::filesystem::path& socket_path,
+                     const ProbeDaemonOptions& options) {
+#ifdef _WIN32
+    (void)socket_path;
+    (void)options;
+    AUTOCONF_TRACE_WARN("The probe daemon is not supported on Windows");
+    return 1;
+#else
+    sockaddr_un address;
+    if (!make_address(socket_path, address)) {
+        AUTOCONF_TRACE_WARN("Probe daemon socket path is too long",
+                            {"socket", socket_path});
+        return 1;
+    }
+
+    // The lock decides which of several concurrently started daemons serves.
+    std::string lock_path = socket_path.string() + ".lock";
+    int lock_fd = open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (lock_fd < 0 || flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
+        if (lock_fd >= 0) {
+            close(lock_fd);
+        }
+        return 1;
+    }
+
+    unlink(socket_path.c_str());
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    mode_t previous_umask = umask(0077);
+    bool bound =
+        listen_fd >= 0 &&
+        bind(listen_fd, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) == 0 &&
+        listen(listen_fd, SOMAXCONN) == 0;
+    umask(previous_umask);
+    if (!bound) {
+        if (listen_fd >= 0) {
+            close(listen_fd);
+        }
+        close(lock_fd);
+        return 1;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    ProbeDaemon(listen_fd, options).serve();
+
+    unlink(socket_path.c_str());
+    close(listen_fd);
+    close(lock_fd);
+    return 0;
+#endif
+}
+
+ProbeCoalescer::ProbeCoalescer(std::filesystem::path socket_path)
+    : socket_path_(std::move(socket_path)) {
+    if (!socket_path_.empty()) {
+        std::error_code ec;
+        std::filesystem::path absolute =
+            std::filesystem::absolute(socket_path_, ec);
+        if (!ec) {
+            socket_path_ = absolute;
+        }
+    }
+}
+
+bool ProbeCoalescer::run(const std::string& key,
+                         const std::function<bool()>& probe) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::map<std::string, bool>::const_iterator local =
+            local_results_.find(key);
+        if (local != local_results_.end()) {
+            return local->second;
+        }
+    }
+    int fd = connect_daemon();
+
+    std::optional<bool> outcome;
+#ifndef _WIN32
+    if (fd >= 0) {
+        outcome = coalesce_with_daemon(fd, key, probe);
+        close(fd);
+    }
+#endif
+    if (!outcome.has_value()) {
+        outcome = probe();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    local_results_[key] = *outcome;
+    return *outcome;
+}
+
+int ProbeCoalescer::connect_daemon() {
+#ifdef _WIN32
+    return -1;
+#else
+    if (socket_path_.empty() || daemon_unavailable_) {
+        return -1;
+    }
+    int fd = connect_socket(socket_path_);
+    if (fd >= 0) {
+        return fd;
+    }
+
+    // Another thread may have started the daemon, or given up, meanwhile.
+    std::lock_guard<std::mutex> lock(start_mutex_);
+    if (daemon_unavailable_) {
+        return -1;
+    }
+    fd = connect_socket(socket_path_);
+    if (fd >= 0) {
+        return fd;
+    }
+
+    AUTOCONF_TRACE_DEBUG("Starting probe daemon", {"socket", socket_path_});
+    spawn_daemon(socket_path_);
+    for (int attempt = 0; attempt < kDaemonStartAttempts; ++attempt) {
+        std::this_thread::sleep_for(kDaemonStartInterval);
+        fd = connect_socket(socket_path_);
+        if (fd >= 0) {
+            return fd;
+        }
+    }
+    AUTOCONF_TRACE_WARN("Probe daemon unavailable, probing in-process",
+                        {"socket", socket_path_});
+    daemon_unavailable_ = true;
+    return -1;
+#endif
+}
+
+}  // namespace rules_cc_autoconf
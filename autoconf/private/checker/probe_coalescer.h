@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rules_cc_autoconf {
+
+/**
+ * @brief Identify a probe independently of the action that runs it.
+ *
+ * Scratch paths (sources, objects, executables) are replaced by their index
+ * and the compiler is taken by its resolved path, so the same probe run from
+ * two configurations of one workspace yields the same key. Relative paths in
+ * the flags (`-I`, `-include`, ...) resolve against the working directory,
+ * which is therefore part of the key.
+ *
+ * @param commands The commands the probe runs, in order.
+ * @param scratch_paths Action-specific paths appearing in `commands`.
+ * @param code The probe source.
+ * @param working_directory The directory the commands run in.
+ * @return 32 hex digits.
+ */
+std::string probe_key(const std::vector<std::vector<std::string>>& commands,
+                      const std::vector<std::string>& scratch_paths,
+                      const std::string& code,
+                      const std::filesystem::path& working_directory);
+
+/**
+ * @brief Settings of the probe coalescing daemon.
+ */
+struct ProbeDaemonOptions {
+    ///< Probes run at the same time host-wide (0 = hardware concurrency)
+    size_t jobs = 0;
+    ///< Exit after this long without clients (0 = never)
+    std::chrono::milliseconds idle_timeout{60000};
+};
+
+/**
+ * @brief Serve probe coalescing requests on a unix socket.
+ *
+ * The daemon never runs a compiler itself: it elects one client per probe
+ * key to run the probe, holds identical requests until that client reports
+ * the outcome, and caps the number of elected clients at `options.jobs`.
+ * Outcomes are not kept once reported: the key does not cover the headers
+ * and libraries a probe reads, so a later request runs the probe again. A
+ * client that disconnects without reporting hands the probe to the next
+ * waiting client.
+ *
+ * Only one daemon serves a socket; the socket is created owner-only.
+ *
+ * @param socket_path The socket to serve.
+ * @param options Daemon settings.
+ * @return 0 once the daemon has been idle for `options.idle_timeout`, 1 on
+ * error (including another daemon already serving `socket_path`).
+ */
+int run_probe_daemon(const std::filesystem::path& socket_path,
+                     const ProbeDaemonOptions& options);
+
+/**
+ * @brief Runs probes through the coalescing daemon.
+ *
+ * Identical probes in one process are only run once. With a socket, probes
+ * are also coalesced with other processes on the host; the daemon is
+ * started on demand, and whenever it cannot be reached the probe simply
+ * runs in-process.
+ */
+class ProbeCoalescer {
+   public:
+    /**
+     * @param socket_path The daemon socket, or empty to only coalesce within
+     * this process.
+     */
+    explicit ProbeCoalescer(std::filesystem::path socket_path);
+
+    /**
+     * @brief Run a probe, or take the outcome of an identical one.
+     *
+     * Thread-safe.
+     *
+     * @param key The probe key (see probe_key()).
+     * @param probe Runs the probe and returns whether it succeeded.
+     * @return The outcome.
+     */
+    bool run(const std::string& key, const std::function<bool()>& probe);
+
+   private:
+    std::filesystem::path socket_path_;  ///< Daemon socket, may be empty
+    std::map<std::string, bool> local_results_{};  ///< Outcomes by key
+    std::mutex mutex_{};  ///< Guards `local_results_`
+    ///< Stop trying after a failed start
+    std::atomic<bool> daemon_unavailable_{false};
+    ///< Lets one thread start the daemon while the others wait for it
+    std::mutex start_mutex_{};
+
+    /**
+     * @brief Connect to the daemon, starting it if needed.
+     *
+     * Called without `mutex_`, so a slow start does not hold up probes
+     * answered from `local_results_`.
+     *
+     * @return A connected socket, or -1.
+     */
+    int connect_daemon();
+};
+
+}  // namespace rules_cc_autoconf
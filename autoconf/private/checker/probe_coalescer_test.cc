@@ -0,0 +1,139 @@
+#include "autoconf/private/checker/probe_coalescer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using rules_cc_autoconf::probe_key;
+using rules_cc_autoconf::ProbeCoalescer;
+using rules_cc_autoconf::ProbeDaemonOptions;
+using rules_cc_autoconf::run_probe_daemon;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+static bool test_key_ignores_scratch_paths() {
+    std::string a = probe_key(
+        {{"cc", "-c", "/tmp/a/x.conftest.c", "-o", "/tmp/a/x.conftest.o"}},
+        {"/tmp/a/x.conftest.c", "/tmp/a/x.conftest"}, "int main(void){}",
+        "/w");
+    std::string b = probe_key(
+        {{"cc", "-c", "/tmp/b/y.conftest.c", "-o", "/tmp/b/y.conftest.o"}},
+        {"/tmp/b/y.conftest.c", "/tmp/b/y.conftest"}, "int main(void){}",
+        "/w");
+    return a == b && a.size() == 32;
+}
+
+static bool test_key_covers_flags_and_code() {
+    std::vector<std::string> paths = {"/s.c", "/s"};
+    std::string base =
+        probe_key({{"cc", "-c", "/s.c"}}, paths, "int x;", "/w");
+    return base != probe_key({{"cc", "-O2", "-c", "/s.c"}}, paths, "int x;",
+                             "/w") &&
+           base != probe_key({{"cc", "-c", "/s.c"}}, paths, "int y;", "/w") &&
+           base != probe_key({{"cc"}, {"-c", "/s.c"}}, paths, "int x;", "/w");
+}
+
+static bool test_key_covers_working_directory() {
+    // `-I include` names a different directory in each.
+    std::vector<std::vector<std::string>> commands = {
+        {"cc", "-I", "include", "-c", "/s.c"}};
+    return probe_key(commands, {"/s.c"}, "int x;", "/a/execroot") !=
+           probe_key(commands, {"/s.c"}, "int x;", "/b/execroot");
+}
+
+static bool test_in_process_memo() {
+    ProbeCoalescer coalescer("");
+    int runs = 0;
+    auto probe = [&]() {
+        ++runs;
+        return true;
+    };
+    return coalescer.run("k", probe) && coalescer.run("k", probe) &&
+           runs == 1;
+}
+
+#ifndef _WIN32
+static bool test_daemon_coalesces_clients() {
+    // Not under $TMPDIR, which may exceed the socket path limit.
+    std::filesystem::path socket =
+        "/tmp/probe_coalescer_test_" + std::to_string(getpid()) + ".sock";
+    ProbeDaemonOptions options;
+    options.jobs = 1;
+    options.idle_timeout = std::chrono::milliseconds(300);
+    std::thread daemon([&]() { run_probe_daemon(socket, options); });
+    while (!std::filesystem::exists(socket)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    // Identical probes run once; distinct ones run one at a time.
+    std::atomic<int> runs{0};
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+    auto client = [&](const std::string& key, bool outcome, bool& result) {
+        ProbeCoalescer coalescer(socket);
+        result = coalescer.run(key, [&]() {
+            ++runs;
+            int now = ++running;
+            max_running = std::max(max_running.load(), now);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            --running;
+            return outcome;
+        });
+    };
+    bool r1 = false;
+    bool r2 = false;
+    bool r3 = true;
+    std::thread c1(client, "same", true, std::ref(r1));
+    std::thread c2(client, "same", true, std::ref(r2));
+    std::thread c3(client, "other", false, std::ref(r3));
+    c1.join();
+    c2.join();
+    c3.join();
+
+    // Outcomes are not kept: a later client runs the probe again.
+    bool r4 = true;
+    client("same", false, r4);
+
+    daemon.join();
+    std::filesystem::remove(socket.string() + ".lock");
+    return r1 && r2 && !r3 && !r4 && runs == 3 && max_running == 1 &&
+           !std::filesystem::exists(socket);
+}
+#endif
+
+int main() {
+    std::cout << "probe_coalescer_test:" << std::endl;
+    TEST(key_ignores_scratch_paths)
+    TEST(key_covers_flags_and_code)
+    TEST(key_covers_working_directory)
+    TEST(in_process_memo)
+#ifndef _WIN32
+    TEST(daemon_coalesces_clients)
+#endif
+
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include "autoconf/private/checker/probe_log.h"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+namespace rules_cc_autoconf {
+
+namespace {
+
+/**
+ * @brief Quote an argument for display when a shell would split it.
+ */
+std::string display_arg(const std::string& arg) {
+    if (!arg.empty() &&
+        arg.find_first_of(" \t\n'\"\\$") == std::string::npos) {
+        return arg;
+    }
+    std::string quoted = "'";
+    for (char c : arg) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted.push_back(c);
+        }
+    }
+    return quoted + "'";
+}
+
+}  // namespace
+
+OutputCapture::OutputCapture(size_t limit) : limit_(limit) {}
+
+void OutputCapture::append(const char* data, size_t size) {
+    size_t kept = std::min(size, limit_ - std::min(limit_, text_.size()));
+    text_.append(data, kept);
+    dropped_ += size - kept;
+}
+
+void ProbeLog::record(ProbeFailure failure) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++failure_count_;
+    if (failures_.size() < kMaxFailures) {
+        failures_.push_back(std::move(failure));
+    }
+}
+
+size_t ProbeLog::failure_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failure_count_;
+}
+
+std::string ProbeLog::render(const std::string& title) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream log;
+    log << "## " << title << "\n";
+    if (failure_count_ == 0) {
+        log << "\nAll probe commands succeeded.\n";
+        return log.str();
+    }
+
+    for (const ProbeFailure& failure : failures_) {
+        log << "\n$";
+        for (const std::string& arg : failure.argv) {
+            log << " " << display_arg(arg);
+        }
+        log << "\n" << failure.output;
+        if (!failure.output.empty() && failure.output.back() != '\n') {
+            log << "\n";
+        }
+        if (failure.dropped_bytes > 0) {
+            log << "[" << failure.dropped_bytes << " more bytes of output]\n";
+        }
+        log << failure.label << ": exit status " << failure.exit_code << "\n";
+        if (!failure.source.empty()) {
+            log << "failed program was:\n";
+            std::istringstream lines(failure.source);
+            std::string line;
+            while (std::getline(lines, line)) {
+                log << "| " << line << "\n";
+            }
+        }
+    }
+    if (failure_count_ > failures_.size()) {
+        log << "\n[" << failure_count_ - failures_.size()
+            << " more failed commands]\n";
+    }
+    return log.str();
+}
+
+}  // namespace rules_cc_autoconf
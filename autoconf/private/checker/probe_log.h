@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rules_cc_autoconf {
+
+/**
+ * @brief Output of a command, kept up to a fixed size.
+ */
+class OutputCapture {
+   public:
+    /** @param limit Bytes kept; anything beyond is only counted. */
+    explicit OutputCapture(size_t limit);
+
+    /** @brief Append output. */
+    void append(const char* data, size_t size);
+
+    /** @brief The kept output. */
+    const std::string& text() const { return text_; }
+
+    /** @brief Bytes dropped beyond the limit. */
+    size_t dropped() const { return dropped_; }
+
+   private:
+    size_t limit_;        ///< Bytes kept
+    std::string text_{};  ///< The first `limit_` bytes
+    size_t dropped_ = 0;  ///< Bytes past `limit_`
+};
+
+/**
+ * @brief A probe command that failed, for the check's config.log.
+ */
+struct ProbeFailure {
+    std::string label{};              ///< What the command did ("compile")
+    std::vector<std::string> argv{};  ///< The exact command
+    int exit_code = 0;                ///< Exit status, or -1 if not started
+    std::string output{};             ///< Combined stdout/stderr, bounded
+    size_t dropped_bytes = 0;         ///< Output beyond the bound
+    std::string source{};             ///< The probe source, if known
+};
+
+/**
+ * @brief Failure-only diagnostics of the probes of one check.
+ *
+ * Probe output is captured for every command and discarded when the
+ * command succeeds; failed commands are kept (up to a bound) so a wrong
+ * answer can be investigated without re-running the check in debug mode.
+ */
+class ProbeLog {
+   public:
+    /** Output kept per failed command. */
+    static constexpr size_t kMaxOutputBytes = 16 * 1024;
+    /** Failed commands kept per check. */
+    static constexpr size_t kMaxFailures = 32;
+
+    /**
+     * @brief Keep a failed command. Thread-safe.
+     * @param failure The command, its output and the probe source.
+     */
+    void record(ProbeFailure failure);
+
+    /** @brief Number of failed commands, including those not kept. */
+    size_t failure_count() const;
+
+    /**
+     * @brief Render the log in the style of autoconf's config.log.
+     * @param title First line of the log, e.g. the check name and result.
+     * @return The log text.
+     */
+    std::string render(const std::string& title) const;
+
+   private:
+    mutable std::mutex mutex_{};
+    std::vector<ProbeFailure> failures_{};  ///< The first kMaxFailures
+    size_t failure_count_ = 0;              ///< All failures
+};
+
+}  // namespace rules_cc_autoconf
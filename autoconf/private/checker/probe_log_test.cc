@@ -0,0 +1,77 @@
+#include "autoconf/private/checker/probe_log.h"
+
+#include <iostream>
+#include <string>
+
+using rules_cc_autoconf::OutputCapture;
+using rules_cc_autoconf::ProbeFailure;
+using rules_cc_autoconf::ProbeLog;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+static bool test_capture_is_bounded() {
+    OutputCapture capture(8);
+    capture.append("hello ", 6);
+    capture.append("world!", 6);
+    capture.append("more", 4);
+    return capture.text() == "hello wo" && capture.dropped() == 8;
+}
+
+static bool test_empty_log() {
+    ProbeLog log;
+    std::string text = log.render("ac_cv_header_stdio_h");
+    return log.failure_count() == 0 &&
+           text.find("## ac_cv_header_stdio_h\n") == 0 &&
+           text.find("All probe commands succeeded.") != std::string::npos;
+}
+
+static bool test_failure_rendering() {
+    ProbeLog log;
+    log.record(ProbeFailure{"compile",
+                            {"cc", "-c", "my file.c"},
+                            1,
+                            "my file.c:1: error: no",
+                            10,
+                            "#include <nope.h>\nint x;\n"});
+    std::string text = log.render("ac_cv_header_nope_h");
+    return log.failure_count() == 1 &&
+           text.find("$ cc -c 'my file.c'\n") != std::string::npos &&
+           text.find("my file.c:1: error: no\n") != std::string::npos &&
+           text.find("[10 more bytes of output]") != std::string::npos &&
+           text.find("compile: exit status 1") != std::string::npos &&
+           text.find("| #include <nope.h>\n| int x;\n") != std::string::npos;
+}
+
+static bool test_failures_are_bounded() {
+    ProbeLog log;
+    for (size_t i = 0; i < ProbeLog::kMaxFailures + 3; ++i) {
+        log.record(ProbeFailure{"link", {"cc"}, 1, "", 0, ""});
+    }
+    std::string text = log.render("ac_cv_search_f");
+    return log.failure_count() == ProbeLog::kMaxFailures + 3 &&
+           text.find("[3 more failed commands]") != std::string::npos;
+}
+
+int main() {
+    std::cout << "probe_log_test:" << std::endl;
+    TEST(capture_is_bounded)
+    TEST(empty_log)
+    TEST(failure_rendering)
+    TEST(failures_are_bounded)
+
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
@@ -0,0 +1,235 @@
+#include "autoconf/private/checker/probe_record.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+namespace rules_cc_autoconf {
+
+namespace {
+
+/**
+ * @brief Replace every occurrence of `from` in `value` with `to`.
+ */
+void replace_all(std::string& value, const std::string& from,
+                 const std::string& to) {
+    if (from.empty()) {
+        return;
+    }
+    size_t pos = 0;
+    while ((pos = value.find(from, pos)) != std::string::npos) {
+        value.replace(pos, from.size(), to);
+        pos += to.size();
+    }
+}
+
+/**
+ * @brief Total, median, 90th percentile and maximum of durations.
+ * @param durations_us Durations in microseconds.
+ * @return Milliseconds, as a JSON object.
+ */
+nlohmann::json latency_stats(std::vector<int64_t> durations_us) {
+    std::sort(durations_us.begin(), durations_us.end());
+    auto ms = [](int64_t us) { return static_cast<double>(us) / 1000.0; };
+    // Nearest-rank percentile.
+    auto percentile = [&](double p) {
+        if (durations_us.empty()) {
+            return 0.0;
+        }
+        size_t rank = static_cast<size_t>(
+            std::ceil(p * static_cast<double>(durations_us.size())));
+        return ms(durations_us[std::max<size_t>(rank, 1) - 1]);
+    };
+    int64_t total = 0;
+    for (int64_t us : durations_us) {
+        total += us;
+    }
+    return {
+        {"max", durations_us.empty() ? 0.0 : ms(durations_us.back())},
+        {"p50", percentile(0.5)},
+        {"p90", percentile(0.9)},
+        {"total", ms(total)},
+    };
+}
+
+}  // namespace
+
+std::string probe_kind_to_string(ProbeKind kind) {
+    switch (kind) {
+        case ProbeKind::kCompile:
+            return "compile";
+        case ProbeKind::kCompileAndLink:
+            return "compile_and_link";
+        case ProbeKind::kCompileAndLinkWithLib:
+            return "compile_and_link_with_lib";
+        case ProbeKind::kCompileWithFlags:
+            return "compile_with_flags";
+    }
+    return "compile";
+}
+
+ProbeKind probe_kind_from_string(const std::string& name) {
+    for (ProbeKind kind :
+         {ProbeKind::kCompile, ProbeKind::kCompileAndLink,
+          ProbeKind::kCompileAndLinkWithLib, ProbeKind::kCompileWithFlags}) {
+        if (probe_kind_to_string(kind) == name) {
+            return kind;
+        }
+    }
+    throw std::runtime_error("Unknown probe kind: " + name);
+}
+
+nlohmann::json ProbeRecord::to_json() const {
+    nlohmann::json j = {
+        {"code", code},
+        {"commands", commands},
+        {"duration_us", duration_us},
+        {"kind", probe_kind_to_string(kind)},
+        {"language", language},
+        {"success", success},
+    };
+    if (!library.empty()) {
+        j["library"] = library;
+    }
+    if (!flags.empty()) {
+        j["flags"] = flags;
+    }
+    return j;
+}
+
+ProbeRecord ProbeRecord::from_json(const nlohmann::json& j) {
+    ProbeRecord record;
+    record.kind = probe_kind_from_string(j.at("kind").get<std::string>());
+    record.language = j.value("language", std::string("c"));
+    record.code = j.at("code").get<std::string>();
+    record.library = j.value("library", std::string());
+    record.flags = j.value("flags", std::vector<std::string>{});
+    record.commands =
+        j.value("commands", std::vector<std::vector<std::string>>{});
+    record.success = j.at("success").get<bool>();
+    record.duration_us = j.value("duration_us", int64_t{-1});
+    return record;
+}
+
+std::vector<std::string> normalize_probe_argv(
+    const std::vector<std::string>& argv,
+    const std::vector<std::string>& scratch_paths) {
+    std::vector<std::string> normalized = argv;
+    // The source path starts with the artifact prefix, so it goes first.
+    for (size_t i = 0; i < scratch_paths.size(); ++i) {
+        bool output = i + 1 == scratch_paths.size();
+        for (std::string& arg : normalized) {
+            replace_all(arg, scratch_paths[i],
+                        output ? "@OUTPUT@" : "@SOURCE@");
+        }
+    }
+    return normalized;
+}
+
+void ProbeRecorder::record(ProbeRecord record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.push_back(std::move(record));
+}
+
+std::vector<ProbeRecord> ProbeRecorder::records() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+nlohmann::json summarize_probe_replay(
+    const std::vector<std::pair<std::string, ProbeRecord>>& recorded,
+    const std::vector<ProbeReplay>& replayed) {
+    if (recorded.size() != replayed.size()) {
+        throw std::runtime_error("Replay does not match the recorded probes");
+    }
+
+    struct CheckSummary {
+        size_t probes = 0;
+        int64_t recorded_us = 0;
+        int64_t replayed_us = 0;
+        nlohmann::json changed = nlohmann::json::array();
+    };
+
+    std::map<std::string, CheckSummary> checks;
+    std::vector<std::string> order;
+    std::vector<int64_t> recorded_us;
+    std::vector<int64_t> replayed_us;
+    size_t changed = 0;
+    for (size_t i = 0; i < recorded.size(); ++i) {
+        const auto& [name, record] = recorded[i];
+        const ProbeReplay& replay = replayed[i];
+        auto [it, inserted] = checks.try_emplace(name);
+        if (inserted) {
+            order.push_back(name);
+        }
+        CheckSummary& check = it->second;
+
+        if (record.duration_us >= 0) {
+            recorded_us.push_back(record.duration_us);
+            replayed_us.push_back(replay.duration_us);
+            check.recorded_us += record.duration_us;
+            check.replayed_us += replay.duration_us;
+        }
+        if (record.success != replay.success) {
+            ++changed;
+            nlohmann::json probe = {
+                {"index", check.probes},
+                {"kind", probe_kind_to_string(record.kind)},
+                {"recorded", record.success},
+                {"replayed", replay.success},
+            };
+            if (!record.library.empty()) {
+                probe["library"] = record.library;
+            }
+            if (!record.flags.empty()) {
+                probe["flags"] = record.flags;
+            }
+            check.changed.push_back(std::move(probe));
+        }
+        ++check.probes;
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+                     [&](const std::string& a, const std::string& b) {
+                         return checks[a].replayed_us > checks[b].replayed_us;
+                     });
+
+    nlohmann::json check_list = nlohmann::json::array();
+    nlohmann::json changed_checks = nlohmann::json::array();
+    for (const std::string& name : order) {
+        const CheckSummary& check = checks[name];
+        if (!check.changed.empty()) {
+            changed_checks.push_back(name);
+        }
+        check_list.push_back({
+            {"changed", check.changed},
+            {"name", name},
+            {"probes", check.probes},
+            {"recorded_ms", static_cast<double>(check.recorded_us) / 1000.0},
+            {"replayed_ms", static_cast<double>(check.replayed_us) / 1000.0},
+        });
+    }
+
+    nlohmann::json recorded_stats = latency_stats(recorded_us);
+    nlohmann::json replayed_stats = latency_stats(replayed_us);
+    double replayed_total = replayed_stats["total"].get<double>();
+    return {
+        {"changed_checks", changed_checks},
+        {"changed_probes", changed},
+        {"checks", check_list},
+        {"latency",
+         {
+             {"recorded_ms", recorded_stats},
+             {"replayed_ms", replayed_stats},
+             {"speedup", replayed_total > 0.0
+                             ? recorded_stats["total"].get<double>() /
+                                   replayed_total
+                             : 0.0},
+             {"timed_probes", recorded_us.size()},
+         }},
+        {"probes", recorded.size()},
+    };
+}
+
+}  // namespace rules_cc_autoconf
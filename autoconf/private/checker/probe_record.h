@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tools/json/json.h"
+
+namespace rules_cc_autoconf {
+
+/**
+ * @brief Which CheckRunner primitive ran a probe.
+ */
+enum class ProbeKind {
+    kCompile,                ///< try_compile()
+    kCompileAndLink,         ///< try_compile_and_link()
+    kCompileAndLinkWithLib,  ///< try_compile_and_link_with_lib()
+    kCompileWithFlags,       ///< try_compile_with_flags()
+};
+
+/** @brief The name of a probe kind in records ("compile", ...). */
+std::string probe_kind_to_string(ProbeKind kind);
+
+/**
+ * @brief Parse the name of a probe kind.
+ * @throws std::runtime_error for an unknown name.
+ */
+ProbeKind probe_kind_from_string(const std::string& name);
+
+/**
+ * @brief One probe of a check, as recorded for offline replay.
+ *
+ * The kind, language, source and library or flags are enough to run the
+ * probe again against any Config; the commands are kept to show what the
+ * recording toolchain actually ran.
+ */
+struct ProbeRecord {
+    ProbeKind kind = ProbeKind::kCompile;
+    std::string language = "c";
+    std::string code{};
+    std::string library{};             ///< For kCompileAndLinkWithLib
+    std::vector<std::string> flags{};  ///< For kCompileWithFlags
+    ///< The commands, normalized by normalize_probe_argv()
+    std::vector<std::vector<std::string>> commands{};
+    bool success = false;
+    ///< Wall time of the commands, or -1 if another checker answered
+    int64_t duration_us = -1;
+
+    /** @brief Serialize to JSON. */
+    nlohmann::json to_json() const;
+
+    /** @brief Deserialize from JSON written by to_json(). */
+    static ProbeRecord from_json(const nlohmann::json& j);
+};
+
+/**
+ * @brief Replace the per-action scratch paths of a command.
+ *
+ * Scratch paths differ between actions and runs, so they are replaced by
+ * placeholders: the source file by `@SOURCE@` and the common prefix of the
+ * object and executable by `@OUTPUT@`.
+ *
+ * @param argv The command.
+ * @param scratch_paths The source path, if any, then the artifact prefix.
+ * @return The normalized command.
+ */
+std::vector<std::string> normalize_probe_argv(
+    const std::vector<std::string>& argv,
+    const std::vector<std::string>& scratch_paths);
+
+/**
+ * @brief Collects the probes of a check. Thread-safe.
+ */
+class ProbeRecorder {
+   public:
+    /** @brief Keep a probe. */
+    void record(ProbeRecord record);
+
+    /** @brief The probes, in the order they finished. */
+    std::vector<ProbeRecord> records() const;
+
+   private:
+    mutable std::mutex mutex_{};
+    std::vector<ProbeRecord> records_{};
+};
+
+/** @brief Outcome of replaying one recorded probe. */
+struct ProbeReplay {
+    bool success = false;
+    int64_t duration_us = 0;
+};
+
+/**
+ * @brief Compare a replay with the recording it ran.
+ *
+ * Checks are ordered by replayed time, slowest first. A probe whose
+ * outcome differs is listed under its check; since checks decide from
+ * their probes' outcomes, those are the checks whose result may change.
+ * Latencies only cover probes with a recorded duration.
+ *
+ * @param recorded Check name and probe pairs.
+ * @param replayed The replay of each probe, parallel to `recorded`.
+ * @return The report.
+ */
+nlohmann::json summarize_probe_replay(
+    const std::vector<std::pair<std::string, ProbeRecord>>& recorded,
+    const std::vector<ProbeReplay>& replayed);
+
+}  // namespace rules_cc_autoconf
@@ -0,0 +1,152 @@
+#include "autoconf/private/checker/probe_record.h"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using rules_cc_autoconf::normalize_probe_argv;
+using rules_cc_autoconf::ProbeKind;
+using rules_cc_autoconf::ProbeRecord;
+using rules_cc_autoconf::ProbeReplay;
+using rules_cc_autoconf::summarize_probe_replay;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+static ProbeRecord make(bool success, int64_t duration_us) {
+    ProbeRecord record;
+    record.code = "int main(void) { return 0; }\n";
+    record.success = success;
+    record.duration_us = duration_us;
+    return record;
+}
+
+static bool test_normalize_scratch_paths() {
+    std::vector<std::string> argv = {
+        "cc", "-c", "/tmp/s/x.conftest.c", "-o", "/tmp/s/x.conftest.o"};
+    std::vector<std::string> normalized = normalize_probe_argv(
+        argv, {"/tmp/s/x.conftest.c", "/tmp/s/x.conftest"});
+    std::vector<std::string> msvc = normalize_probe_argv(
+        {"cl", "/Fo/tmp/s/x.conftest.obj"}, {"/tmp/s/x.conftest"});
+    return normalized == std::vector<std::string>{"cc", "-c", "@SOURCE@",
+                                                  "-o", "@OUTPUT@.o"} &&
+           msvc == std::vector<std::string>{"cl", "/Fo@OUTPUT@.obj"};
+}
+
+static bool test_json_round_trip() {
+    ProbeRecord record = make(true, 1500);
+    record.kind = ProbeKind::kCompileAndLinkWithLib;
+    record.language = "cpp";
+    record.library = "m";
+    record.commands = {{"c++", "@SOURCE@", "-lm"}};
+
+    ProbeRecord flags = make(false, -1);
+    flags.kind = ProbeKind::kCompileWithFlags;
+    flags.flags = {"-Wall", "-Wbogus"};
+
+    ProbeRecord parsed = ProbeRecord::from_json(record.to_json());
+    ProbeRecord parsed_flags = ProbeRecord::from_json(flags.to_json());
+    return parsed.kind == ProbeKind::kCompileAndLinkWithLib &&
+           parsed.language == "cpp" && parsed.library == "m" &&
+           parsed.code == record.code && parsed.commands == record.commands &&
+           parsed.success && parsed.duration_us == 1500 &&
+           !record.to_json().contains("flags") &&
+           parsed_flags.kind == ProbeKind::kCompileWithFlags &&
+           parsed_flags.flags == flags.flags && !parsed_flags.success &&
+           parsed_flags.duration_us == -1;
+}
+
+static bool test_unknown_kind_throws() {
+    nlohmann::json j = make(true, 1).to_json();
+    j["kind"] = "run";
+    try {
+        ProbeRecord::from_json(j);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+static bool test_summary_reports_changed_outcomes() {
+    ProbeRecord lib = make(true, 4000);
+    lib.kind = ProbeKind::kCompileAndLinkWithLib;
+    lib.library = "m";
+    std::vector<std::pair<std::string, ProbeRecord>> recorded = {
+        {"HAVE_A", make(true, 1000)},
+        {"HAVE_A", make(false, 1000)},
+        {"LIBM", make(false, 2000)},
+        {"LIBM", lib},
+    };
+    std::vector<ProbeReplay> replayed = {
+        {true, 500}, {false, 500}, {false, 1000}, {false, 9000}};
+
+    nlohmann::json report = summarize_probe_replay(recorded, replayed);
+    const nlohmann::json& checks = report["checks"];
+    return report["probes"] == 4 && report["changed_probes"] == 1 &&
+           report["changed_checks"] == nlohmann::json::array({"LIBM"}) &&
+           checks.size() == 2 && checks[0]["name"] == "LIBM" &&
+           checks[0]["replayed_ms"] == 10.0 &&
+           checks[0]["recorded_ms"] == 6.0 &&
+           checks[0]["changed"].size() == 1 &&
+           checks[0]["changed"][0]["index"] == 1 &&
+           checks[0]["changed"][0]["library"] == "m" &&
+           checks[0]["changed"][0]["recorded"] == true &&
+           checks[0]["changed"][0]["replayed"] == false &&
+           checks[1]["name"] == "HAVE_A" && checks[1]["changed"].empty();
+}
+
+static bool test_summary_latency() {
+    std::vector<std::pair<std::string, ProbeRecord>> recorded = {
+        {"A", make(true, 1000)},
+        {"A", make(true, 3000)},
+        {"B", make(true, 2000)},
+        // Answered by another checker: no recorded latency to compare.
+        {"B", make(true, -1)},
+    };
+    std::vector<ProbeReplay> replayed = {
+        {true, 500}, {true, 1500}, {true, 1000}, {true, 7000}};
+
+    nlohmann::json latency =
+        summarize_probe_replay(recorded, replayed)["latency"];
+    return latency["timed_probes"] == 3 &&
+           latency["recorded_ms"]["total"] == 6.0 &&
+           latency["recorded_ms"]["p50"] == 2.0 &&
+           latency["recorded_ms"]["max"] == 3.0 &&
+           latency["replayed_ms"]["total"] == 3.0 &&
+           latency["replayed_ms"]["p90"] == 1.5 && latency["speedup"] == 2.0;
+}
+
+static bool test_summary_size_mismatch_throws() {
+    try {
+        summarize_probe_replay({{"A", make(true, 1)}}, {});
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    std::cout << "probe_record_test:" << std::endl;
+    TEST(normalize_scratch_paths)
+    TEST(json_round_trip)
+    TEST(unknown_kind_throws)
+    TEST(summary_reports_changed_outcomes)
+    TEST(summary_latency)
+    TEST(summary_size_mismatch_throws)
+
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+#include "autoconf/private/checker/prologue_profile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace rules_cc_autoconf {
+
+namespace {
+
+/**
+ * @brief Record one traced header at the given nesting depth (1 = direct).
+ */
+void add_header(PrologueProfile& profile, std::set<std::string>& seen,
+                size_t depth, std::string path) {
+    while (!path.empty() && (path.back() == '\r' || path.back() == ' ')) {
+        path.pop_back();
+    }
+    if (path.empty()) {
+        return;
+    }
+    if (depth == 1) {
+        profile.direct_includes.push_back(path);
+    }
+    if (seen.insert(path).second) {
+        profile.headers.push_back(std::move(path));
+    }
+}
+
+}  // namespace
+
+std::string PrologueProfile::fingerprint() const {
+    std::vector<std::string> sorted = headers;
+    std::sort(sorted.begin(), sorted.end());
+
+    // FNV-1a, 64 bit.
+    uint64_t hash = 14695981039346656037ULL;
+    for (const std::string& header : sorted) {
+        for (char c : header) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        hash ^= '\n';
+        hash *= 1099511628211ULL;
+    }
+
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx",
+                  static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+nlohmann::json PrologueProfile::to_json() const {
+    return {
+        {"direct_includes", direct_includes},
+        {"frontend_ms", frontend_ms},
+        {"headers", headers},
+        {"preprocessed_bytes", preprocessed_bytes},
+    };
+}
+
+std::optional<PrologueProfile> PrologueProfile::from_json(
+    const nlohmann::json& j) {
+    if (j.is_null()) {
+        return std::nullopt;
+    }
+    PrologueProfile profile;
+    profile.direct_includes =
+        j.value("direct_includes", std::vector<std::string>{});
+    profile.frontend_ms = j.value("frontend_ms", 0.0);
+    profile.headers = j.value("headers", std::vector<std::string>{});
+    profile.preprocessed_bytes = j.value("preprocessed_bytes", uint64_t{0});
+    return profile;
+}
+
+void parse_gcc_include_trace(const std::string& output,
+                             PrologueProfile& profile) {
+    std::set<std::string> seen(profile.headers.begin(), profile.headers.end());
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t depth = line.find_first_not_of('.');
+        if (depth == 0 || depth == std::string::npos || line[depth] != ' ') {
+            continue;
+        }
+        add_header(profile, seen, depth, line.substr(depth + 1));
+    }
+}
+
+void parse_msvc_include_trace(const std::string& output,
+                              PrologueProfile& profile) {
+    static const std::string kMarker = "Note: including file:";
+
+    std::set<std::string> seen(profile.headers.begin(), profile.headers.end());
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t marker = line.find(kMarker);
+        if (marker == std::string::npos) {
+            continue;
+        }
+        size_t start = marker + kMarker.size();
+        size_t path = line.find_first_not_of(' ', start);
+        if (path == std::string::npos) {
+            continue;
+        }
+        add_header(profile, seen, path - start, line.substr(path));
+    }
+}
+
+nlohmann::json summarize_prologues(
+    const std::vector<std::pair<std::string, std::optional<PrologueProfile>>>&
+        profiles) {
+    struct Group {
+        std::vector<std::string> checks{};
+        const PrologueProfile* first = nullptr;
+        uint64_t max_bytes = 0;
+        double total_ms = 0.0;
+    };
+
+    std::map<std::string, Group> groups;
+    size_t profiled = 0;
+    double total_ms = 0.0;
+    for (const auto& [name, profile] : profiles) {
+        if (!profile.has_value()) {
+            continue;
+        }
+        ++profiled;
+        total_ms += profile->frontend_ms;
+
+        Group& group = groups[profile->fingerprint()];
+        if (group.first == nullptr) {
+            group.first = &*profile;
+        }
+        group.checks.push_back(name);
+        group.max_bytes =
+            std::max(group.max_bytes, profile->preprocessed_bytes);
+        group.total_ms += profile->frontend_ms;
+    }
+
+    std::vector<std::pair<std::string, const Group*>> ordered;
+    for (const auto& [fingerprint, group] : groups) {
+        ordered.emplace_back(fingerprint, &group);
+    }
+    std::stable_sort(ordered.begin(), ordered.end(),
+                     [](const auto& a, const auto& b) {
+                         return a.second->total_ms > b.second->total_ms;
+                     });
+
+    nlohmann::json prologues = nlohmann::json::array();
+    for (const auto& [fingerprint, group] : ordered) {
+        prologues.push_back({
+            {"checks", group->checks},
+            {"direct_includes", group->first->direct_includes},
+            {"fingerprint", fingerprint},
+            {"frontend_ms",
+             {
+                 {"mean", group->total_ms /
+                              static_cast<double>(group->checks.size())},
+                 {"total", group->total_ms},
+             }},
+            {"headers", group->first->headers.size()},
+            {"preprocessed_bytes", group->max_bytes},
+        });
+    }
+
+    return {
+        {"checks", profiles.size()},
+        {"frontend_ms", total_ms},
+        {"profiled", profiled},
+        {"prologues", prologues},
+    };
+}
+
+}  // namespace rules_cc_autoconf
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tools/json/json.h"
+
+namespace rules_cc_autoconf {
+
+/**
+ * @brief Preprocessing cost of the prologue (include set) of one probe.
+ */
+struct PrologueProfile {
+    ///< Every header opened while compiling the probe, in first-seen order
+    std::vector<std::string> headers{};
+    ///< Headers included by the probe source itself
+    std::vector<std::string> direct_includes{};
+    uint64_t preprocessed_bytes = 0;  ///< Size of the `-E` / `/EP` output
+    double frontend_ms = 0.0;  ///< Wall time of a syntax-only compile
+
+    /**
+     * @brief Identify the include set.
+     *
+     * Hashes the sorted header list, so probes that pull in the same headers
+     * share a fingerprint regardless of their body.
+     *
+     * @return 16 hex digits.
+     */
+    std::string fingerprint() const;
+
+    /** @brief Serialize to JSON. */
+    nlohmann::json to_json() const;
+
+    /**
+     * @brief Deserialize from JSON written by to_json().
+     * @return The profile, or std::nullopt if `j` is null.
+     */
+    static std::optional<PrologueProfile> from_json(const nlohmann::json& j);
+};
+
+/**
+ * @brief Record the headers listed by a GCC/Clang `-H` include trace.
+ *
+ * `-H` prints one line per opened header, prefixed by one dot per nesting
+ * level (`. /usr/include/stdio.h`, `.. /usr/include/bits/types.h`). Other
+ * lines, such as the "Multiple include guards may be useful for:" list, are
+ * ignored.
+ *
+ * @param output Compiler output.
+ * @param profile Receives headers and direct_includes.
+ */
+void parse_gcc_include_trace(const std::string& output,
+                             PrologueProfile& profile);
+
+/**
+ * @brief Record the headers listed by an MSVC `/showIncludes` trace.
+ *
+ * Each line reads `Note: including file:` followed by one space per nesting
+ * level and the path.
+ *
+ * @param output Compiler output.
+ * @param profile Receives headers and direct_includes.
+ */
+void parse_msvc_include_trace(const std::string& output,
+                              PrologueProfile& profile);
+
+/**
+ * @brief Summarize the prologue profiles of a target's checks.
+ *
+ * Checks are grouped by include-set fingerprint; groups are ordered by
+ * their total frontend time, most expensive first, so the heaviest
+ * prologues lead the report.
+ *
+ * @param profiles Check name and profile pairs. Checks that compiled
+ * nothing carry std::nullopt and only count towards "checks".
+ * @return The report.
+ */
+nlohmann::json summarize_prologues(
+    const std::vector<std::pair<std::string, std::optional<PrologueProfile>>>&
+        profiles);
+
+}  // namespace rules_cc_autoconf
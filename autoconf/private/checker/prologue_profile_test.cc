@@ -0,0 +1,134 @@
+#include "autoconf/private/checker/prologue_profile.h"
+
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using rules_cc_autoconf::parse_gcc_include_trace;
+using rules_cc_autoconf::parse_msvc_include_trace;
+using rules_cc_autoconf::PrologueProfile;
+using rules_cc_autoconf::summarize_prologues;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+static bool test_gcc_trace() {
+    PrologueProfile profile;
+    parse_gcc_include_trace(
+        ". /usr/include/stdio.h\n"
+        ".. /usr/include/bits/types.h\n"
+        ". /usr/include/string.h\n"
+        ".. /usr/include/bits/types.h\n"
+        "Multiple include guards may be useful for:\n"
+        "/usr/include/bits/types.h\n"
+        "conftest.c:1:1: warning: something\n",
+        profile);
+    return profile.headers ==
+               std::vector<std::string>{"/usr/include/stdio.h",
+                                        "/usr/include/bits/types.h",
+                                        "/usr/include/string.h"} &&
+           profile.direct_includes ==
+               std::vector<std::string>{"/usr/include/stdio.h",
+                                        "/usr/include/string.h"};
+}
+
+static bool test_msvc_trace() {
+    PrologueProfile profile;
+    parse_msvc_include_trace(
+        "conftest.c\r\n"
+        "Note: including file: C:\\sdk\\stdio.h\r\n"
+        "Note: including file:  C:\\sdk\\corecrt.h\r\n"
+        "Note: including file: C:\\sdk\\stdlib.h\r\n",
+        profile);
+    return profile.headers ==
+               std::vector<std::string>{"C:\\sdk\\stdio.h",
+                                        "C:\\sdk\\corecrt.h",
+                                        "C:\\sdk\\stdlib.h"} &&
+           profile.direct_includes ==
+               std::vector<std::string>{"C:\\sdk\\stdio.h",
+                                        "C:\\sdk\\stdlib.h"};
+}
+
+static bool test_fingerprint_ignores_order() {
+    PrologueProfile a;
+    a.headers = {"/a.h", "/b.h"};
+    PrologueProfile b;
+    b.headers = {"/b.h", "/a.h"};
+    PrologueProfile c;
+    c.headers = {"/a.h"};
+    return a.fingerprint() == b.fingerprint() &&
+           a.fingerprint() != c.fingerprint() && a.fingerprint().size() == 16;
+}
+
+static bool test_json_round_trip() {
+    PrologueProfile profile;
+    profile.headers = {"/a.h", "/b.h"};
+    profile.direct_includes = {"/a.h"};
+    profile.preprocessed_bytes = 1234;
+    profile.frontend_ms = 5.5;
+    std::optional<PrologueProfile> copy =
+        PrologueProfile::from_json(profile.to_json());
+    return copy.has_value() && copy->headers == profile.headers &&
+           copy->direct_includes == profile.direct_includes &&
+           copy->preprocessed_bytes == 1234 && copy->frontend_ms == 5.5 &&
+           !PrologueProfile::from_json(nullptr).has_value();
+}
+
+static bool test_summary_groups_by_include_set() {
+    PrologueProfile light;
+    light.headers = {"/stdio.h"};
+    light.direct_includes = {"/stdio.h"};
+    light.preprocessed_bytes = 100;
+    light.frontend_ms = 1.0;
+
+    PrologueProfile heavy;
+    heavy.headers = {"/stdio.h", "/stdlib.h", "/string.h"};
+    heavy.direct_includes = {"/stdlib.h", "/string.h"};
+    heavy.preprocessed_bytes = 900;
+    heavy.frontend_ms = 4.0;
+
+    nlohmann::json report = summarize_prologues({
+        {"ac_cv_a", light},
+        {"ac_cv_b", heavy},
+        {"ac_cv_c", heavy},
+        {"ac_cv_d", std::nullopt},
+    });
+
+    const nlohmann::json& prologues = report["prologues"];
+    return report["checks"] == 4 && report["profiled"] == 3 &&
+           report["frontend_ms"] == 9.0 && prologues.size() == 2 &&
+           prologues[0]["fingerprint"] == heavy.fingerprint() &&
+           prologues[0]["checks"] ==
+               std::vector<std::string>{"ac_cv_b", "ac_cv_c"} &&
+           prologues[0]["headers"] == 3 &&
+           prologues[0]["preprocessed_bytes"] == 900 &&
+           prologues[0]["frontend_ms"]["total"] == 8.0 &&
+           prologues[0]["frontend_ms"]["mean"] == 4.0 &&
+           prologues[1]["checks"] == std::vector<std::string>{"ac_cv_a"};
+}
+
+int main() {
+    std::cout << "prologue_profile_test:" << std::endl;
+    TEST(gcc_trace)
+    TEST(msvc_trace)
+    TEST(fingerprint_ignores_order)
+    TEST(json_round_trip)
+    TEST(summary_groups_by_include_set)
+
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
@@ -0,0 +1,307 @@
+#include "autoconf/private/checker/scratch_space.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <system_error>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "autoconf/private/common/trace.h"
+#include "autoconf/private/common/file_util.h"
+
+namespace rules_cc_autoconf {
+
+namespace {
+
+/** Upper bound on artifacts tracked for signal-time cleanup. */
+constexpr size_t kMaxRegisteredArtifacts = 64;
+
+/** The instance cleaned up by the termination signal handler. */
+std::atomic<const ScratchSpace*> g_active_scratch{nullptr};
+
+#ifndef _WIN32
+/** Signals that trigger cleanup of the active scratch space. */
+constexpr int kCleanupSignals[] = {SIGHUP, SIGINT, SIGTERM};
+
+/** Signal actions replaced by the active instance, restored on teardown. */
+struct sigaction g_previous_actions[sizeof(kCleanupSignals) /
+                                    sizeof(kCleanupSignals[0])];
+#endif
+
+/**
+ * @brief Create a uniquely named private directory under `parent`.
+ * @return The new directory, or std::nullopt on failure.
+ */
+std::optional<std::filesystem::path> make_private_dir(
+    const std::filesystem::path& parent) {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(parent, ec)) {
+        return std::nullopt;
+    }
+#ifndef _WIN32
+    std::string tmpl = (parent / "rules_cc_autoconf.XXXXXX").string();
+    std::vector<char> buffer(tmpl.begin(), tmpl.end());
+    buffer.push_back('\0');
+    if (mkdtemp(buffer.data()) == nullptr) {
+        return std::nullopt;
+    }
+    return std::filesystem::path(buffer.data());
+#else
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        std::filesystem::path candidate =
+            parent / ("rcca." + std::to_string(gen() % 0xFFFFFFFFull));
+        if (std::filesystem::create_directory(candidate, ec)) {
+            return candidate;
+        }
+    }
+    return std::nullopt;
+#endif
+}
+
+}  // namespace
+
+std::optional<ScratchBackend> parse_scratch_backend(const std::string& value) {
+    std::string lower;
+    std::transform(value.begin(), value.end(), std::back_inserter(lower),
+                   ::tolower);
+    if (lower == "output") return ScratchBackend::kOutputTree;
+    if (lower == "tmp") return ScratchBackend::kTmpDir;
+    if (lower == "shm") return ScratchBackend::kShm;
+    if (lower == "memfd") return ScratchBackend::kMemfd;
+    return std::nullopt;
+}
+
+ScratchBackend scratch_backend_from_env() {
+    const char* env = std::getenv("RULES_CC_AUTOCONF_SCRATCH");
+    if (env == nullptr || *env == '\0') {
+        return ScratchBackend::kTmpDir;
+    }
+    std::optional<ScratchBackend> backend = parse_scratch_backend(env);
+    if (!backend.has_value()) {
+        AUTOCONF_TRACE_WARN("Unknown RULES_CC_AUTOCONF_SCRATCH value, using "
+                            "'tmp'",
+                            {"value", env});
+        return ScratchBackend::kTmpDir;
+    }
+    return *backend;
+}
+
+ScratchFile::ScratchFile(std::filesystem::path path, int fd)
+    : path_(std::move(path)), fd_(fd) {}
+
+ScratchFile::ScratchFile(ScratchFile&& other) noexcept
+    : path_(std::move(other.path_)), fd_(other.fd_) {
+    other.path_.clear();
+    other.fd_ = -1;
+}
+
+ScratchFile& ScratchFile::operator=(ScratchFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        path_ = std::move(other.path_);
+        fd_ = other.fd_;
+        other.path_.clear();
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+ScratchFile::~ScratchFile() { release(); }
+
+void ScratchFile::release() {
+#ifndef _WIN32
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+        path_.clear();
+        return;
+    }
+#endif
+    if (!path_.empty()) {
+        std::error_code ec;
+        file_remove(path_, ec);
+        path_.clear();
+    }
+}
+
+ScratchSpace::ScratchSpace(ScratchBackend backend,
+                           const std::filesystem::path& output_dir)
+    : backend_(backend), dir_(output_dir) {
+    registered_.reserve(kMaxRegisteredArtifacts);
+
+    if (backend_ != ScratchBackend::kOutputTree) {
+        std::error_code ec;
+        std::filesystem::path parent =
+            std::filesystem::temp_directory_path(ec);
+        if (backend_ == ScratchBackend::kShm) {
+            if (std::filesystem::is_directory("/dev/shm", ec)) {
+                parent = "/dev/shm";
+            } else {
+                AUTOCONF_TRACE_DEBUG("/dev/shm unavailable, using temp dir");
+            }
+        }
+        std::optional<std::filesystem::path> private_dir =
+            make_private_dir(parent);
+        if (private_dir.has_value()) {
+            dir_ = private_dir->make_preferred();
+            owns_dir_ = true;
+        } else {
+            AUTOCONF_TRACE_WARN(
+                "Failed to create scratch directory, writing conftest files "
+                "to the output tree",
+                {"parent", parent});
+            backend_ = ScratchBackend::kOutputTree;
+        }
+    }
+
+#if !defined(__linux__) || !defined(SYS_memfd_create)
+    if (backend_ == ScratchBackend::kMemfd) {
+        AUTOCONF_TRACE_DEBUG("memfd unsupported on this platform, using 'tmp'");
+        backend_ = ScratchBackend::kTmpDir;
+    }
+#else
+    std::error_code proc_ec;
+    if (backend_ == ScratchBackend::kMemfd &&
+        !std::filesystem::is_directory("/proc/self/fd", proc_ec)) {
+        AUTOCONF_TRACE_DEBUG("/proc/self/fd unavailable, using 'tmp'");
+        backend_ = ScratchBackend::kTmpDir;
+    }
+#endif
+
+    AUTOCONF_TRACE_DEBUG("Scratch space", {"dir", dir_});
+    install_signal_handlers();
+}
+
+ScratchSpace::~ScratchSpace() {
+    restore_signal_handlers();
+
+    std::error_code ec;
+    size_t count = registered_count_.load();
+    for (size_t i = 0; i < count; ++i) {
+        file_remove(registered_[i], ec);
+    }
+    if (owns_dir_) {
+        std::filesystem::remove_all(dir_, ec);
+        if (ec) {
+            AUTOCONF_TRACE_WARN("Failed to remove scratch directory",
+                                {"dir", dir_}, {"error", ec.message()});
+        }
+    }
+}
+
+std::filesystem::path ScratchSpace::artifact_path(
+    const std::string& file_name) {
+    std::filesystem::path path = dir_ / file_name;
+    std::string path_str = path.string();
+    std::lock_guard<std::mutex> lock(register_mutex_);
+    size_t count = registered_count_.load();
+    if (count < kMaxRegisteredArtifacts &&
+        std::find(registered_.begin(), registered_.begin() + count,
+                  path_str) == registered_.begin() + count) {
+        registered_.push_back(path_str);
+        registered_count_.store(count + 1);
+    }
+    return path;
+}
+
+std::optional<ScratchFile> ScratchSpace::write_source(
+    const std::string& file_name, const std::string& content) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+    if (backend_ == ScratchBackend::kMemfd) {
+        // No MFD_CLOEXEC: the compiler spawned through the shell must inherit
+        // the descriptor to open it via /proc/self/fd.
+        int fd = static_cast<int>(
+            syscall(SYS_memfd_create, file_name.c_str(), 0u));
+        if (fd >= 0) {
+            size_t written = 0;
+            while (written < content.size()) {
+                ssize_t n = write(fd, content.data() + written,
+                                  content.size() - written);
+                if (n <= 0) break;
+                written += static_cast<size_t>(n);
+            }
+            if (written == content.size()) {
+                return ScratchFile("/proc/self/fd/" + std::to_string(fd), fd);
+            }
+            close(fd);
+        }
+        AUTOCONF_TRACE_DEBUG("memfd_create failed, writing to the scratch "
+                             "directory",
+                             {"file", file_name}, {"dir", dir_});
+    }
+#endif
+
+    std::filesystem::path path = artifact_path(file_name);
+    std::ofstream source = open_ofstream(path);
+    if (!source.is_open()) {
+        AUTOCONF_TRACE_WARN("Failed to create source file", {"path", path});
+        return std::nullopt;
+    }
+    source << content;
+    source.close();
+    return ScratchFile(path, -1);
+}
+
+void ScratchSpace::install_signal_handlers() {
+#ifndef _WIN32
+    const ScratchSpace* expected = nullptr;
+    if (!g_active_scratch.compare_exchange_strong(expected, this)) {
+        // Another instance already owns the handlers; rely on RAII here.
+        return;
+    }
+    struct sigaction action {};
+    action.sa_handler = &ScratchSpace::handle_signal;
+    sigemptyset(&action.sa_mask);
+    for (size_t i = 0; i < std::size(kCleanupSignals); ++i) {
+        sigaction(kCleanupSignals[i], &action, &g_previous_actions[i]);
+    }
+#endif
+}
+
+void ScratchSpace::restore_signal_handlers() {
+#ifndef _WIN32
+    if (g_active_scratch.load() != this) {
+        return;
+    }
+    for (size_t i = 0; i < std::size(kCleanupSignals); ++i) {
+        sigaction(kCleanupSignals[i], &g_previous_actions[i], nullptr);
+    }
+    g_active_scratch.store(nullptr);
+#endif
+}
+
+void ScratchSpace::remove_registered_for_signal() const {
+#ifndef _WIN32
+    size_t count = registered_count_.load();
+    for (size_t i = 0; i < count; ++i) {
+        unlink(registered_[i].c_str());
+    }
+    if (owns_dir_) {
+        rmdir(dir_.c_str());
+    }
+#endif
+}
+
+void ScratchSpace::handle_signal(int signal_number) {
+#ifndef _WIN32
+    const ScratchSpace* active = g_active_scratch.load();
+    if (active != nullptr) {
+        active->remove_registered_for_signal();
+    }
+    signal(signal_number, SIG_DFL);
+    raise(signal_number);
+#else
+    (void)signal_number;
+#endif
+}
+
+}  // namespace rules_cc_autoconf
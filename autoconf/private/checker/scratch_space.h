@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rules_cc_autoconf {
+
+/**
+ * @brief Where conftest artifacts (sources, objects, executables, `.i`
+ * files) are written while a check runs.
+ */
+enum class ScratchBackend {
+    kOutputTree,  ///< Next to the check JSON inside the output tree (legacy)
+    kTmpDir,      ///< Private directory under `$TMPDIR` (default)
+    kShm,         ///< Private directory under `/dev/shm`
+    kMemfd,       ///< memfd-backed sources, private `$TMPDIR` dir for outputs
+};
+
+/**
+ * @brief Parse a scratch backend name.
+ *
+ * Accepted values are "output", "tmp", "shm" and "memfd".
+ *
+ * @param value The backend name.
+ * @return The backend, or std::nullopt if the name is not recognized.
+ */
+std::optional<ScratchBackend> parse_scratch_backend(const std::string& value);
+
+/**
+ * @brief Get the scratch backend from the RULES_CC_AUTOCONF_SCRATCH
+ * environment variable.
+ *
+ * Defaults to ScratchBackend::kTmpDir when the variable is unset or holds an
+ * unrecognized value.
+ *
+ * @return The configured scratch backend.
+ */
+ScratchBackend scratch_backend_from_env();
+
+/**
+ * @brief A single source file written into scratch space.
+ *
+ * When backed by a memfd the file has no on-disk name; `path()` is
+ * `/proc/self/fd/N` and the descriptor is inherited by the compiler process.
+ * Such paths carry no extension, so callers must tell the compiler the
+ * language explicitly (see `in_memory()`).
+ *
+ * The file is closed and removed on destruction.
+ */
+class ScratchFile {
+   public:
+    ScratchFile(std::filesystem::path path, int fd);
+    ~ScratchFile();
+
+    ScratchFile(ScratchFile&& other) noexcept;
+    ScratchFile& operator=(ScratchFile&& other) noexcept;
+    ScratchFile(const ScratchFile&) = delete;
+    ScratchFile& operator=(const ScratchFile&) = delete;
+
+    /** @brief Path to pass on the compiler command line. */
+    const std::filesystem::path& path() const { return path_; }
+
+    /** @brief Whether the file lives in memory (no extension on the path). */
+    bool in_memory() const { return fd_ >= 0; }
+
+   private:
+    std::filesystem::path path_;  ///< On-disk path or /proc/self/fd/N
+    int fd_ = -1;                 ///< memfd descriptor, -1 for on-disk files
+
+    /** @brief Close the descriptor or remove the on-disk file. */
+    void release();
+};
+
+/**
+ * @brief Per-action scratch space for conftest artifacts.
+ *
+ * Probes write many short-lived files. Keeping them out of the output tree
+ * avoids paying network/overlay filesystem costs for every create, write and
+ * unlink. Private directories are created with a unique name and removed
+ * recursively on destruction. On POSIX a termination signal handler also
+ * removes every registered artifact so a cancelled action leaves nothing
+ * behind.
+ */
+class ScratchSpace {
+   public:
+    /**
+     * @brief Create scratch space.
+     * @param backend The requested backend. Falls back to the output tree
+     *                if a private directory cannot be created.
+     * @param output_dir Directory used by ScratchBackend::kOutputTree (the
+     *                   parent of the check JSON file).
+     */
+    ScratchSpace(ScratchBackend backend,
+                 const std::filesystem::path& output_dir);
+    ~ScratchSpace();
+
+    ScratchSpace(const ScratchSpace&) = delete;
+    ScratchSpace& operator=(const ScratchSpace&) = delete;
+
+    /** @brief The backend actually in use (after any fallback). */
+    ScratchBackend backend() const { return backend_; }
+
+    /** @brief Directory that holds on-disk artifacts. */
+    const std::filesystem::path& dir() const { return dir_; }
+
+    /**
+     * @brief Get the path of an artifact and register it for cleanup.
+     *
+     * Thread-safe.
+     *
+     * @param file_name File name (no directory component).
+     * @return Path to the artifact inside `dir()`.
+     */
+    std::filesystem::path artifact_path(const std::string& file_name);
+
+    /**
+     * @brief Write a source file.
+     *
+     * Uses a memfd when the backend is ScratchBackend::kMemfd and the
+     * platform supports it, otherwise writes `file_name` into `dir()`.
+     *
+     * @param file_name File name used for on-disk sources (and as the memfd
+     *                  debug name).
+     * @param content The source code to write.
+     * @return The written file, or std::nullopt on failure.
+     */
+    std::optional<ScratchFile> write_source(const std::string& file_name,
+                                            const std::string& content);
+
+   private:
+    ScratchBackend backend_;     ///< Backend in use
+    std::filesystem::path dir_;  ///< Directory for on-disk artifacts
+    bool owns_dir_ = false;      ///< Whether `dir_` is ours to remove
+    ///< Artifacts to remove. Capacity is reserved up front and never grows so
+    ///< the signal handler can read it without racing a reallocation.
+    std::vector<std::string> registered_{};
+    ///< Number of entries in `registered_` visible to the signal handler
+    std::atomic<size_t> registered_count_{0};
+    ///< Serializes registration by concurrent probes
+    std::mutex register_mutex_{};
+
+    /** @brief Install termination signal handlers (POSIX only). */
+    void install_signal_handlers();
+
+    /** @brief Restore the signal handlers replaced by this instance. */
+    void restore_signal_handlers();
+
+    /**
+     * @brief Remove registered artifacts using only async-signal-safe calls.
+     */
+    void remove_registered_for_signal() const;
+
+    /** @brief Termination signal handler that cleans the active instance. */
+    static void handle_signal(int signal_number);
+};
+
+}  // namespace rules_cc_autoconf
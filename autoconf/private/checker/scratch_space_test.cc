@@ -0,0 +1,102 @@
+#include "autoconf/private/checker/scratch_space.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using rules_cc_autoconf::parse_scratch_backend;
+using rules_cc_autoconf::ScratchBackend;
+using rules_cc_autoconf::ScratchFile;
+using rules_cc_autoconf::ScratchSpace;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+static std::string read_all(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    std::ostringstream buf;
+    buf << file.rdbuf();
+    return buf.str();
+}
+
+static bool test_parse_backend() {
+    return parse_scratch_backend("output") == ScratchBackend::kOutputTree &&
+           parse_scratch_backend("TMP") == ScratchBackend::kTmpDir &&
+           parse_scratch_backend("shm") == ScratchBackend::kShm &&
+           parse_scratch_backend("memfd") == ScratchBackend::kMemfd &&
+           !parse_scratch_backend("bogus").has_value();
+}
+
+static bool test_private_dir_removed() {
+    std::filesystem::path output_dir = std::filesystem::temp_directory_path();
+    std::filesystem::path dir;
+    {
+        ScratchSpace scratch(ScratchBackend::kTmpDir, output_dir);
+        dir = scratch.dir();
+        if (dir == output_dir || !std::filesystem::is_directory(dir)) {
+            return false;
+        }
+        std::optional<ScratchFile> src =
+            scratch.write_source("conftest.c", "int x;\n");
+        if (!src.has_value() || src->in_memory()) return false;
+        if (src->path().parent_path() != dir) return false;
+        if (read_all(src->path()) != "int x;\n") return false;
+        std::ofstream(scratch.artifact_path("conftest.o")) << "obj";
+    }
+    return !std::filesystem::exists(dir);
+}
+
+static bool test_output_tree_leaves_dir() {
+    std::filesystem::path output_dir =
+        std::filesystem::temp_directory_path() / "scratch_space_test_out";
+    std::filesystem::create_directories(output_dir);
+    std::filesystem::path artifact;
+    {
+        ScratchSpace scratch(ScratchBackend::kOutputTree, output_dir);
+        if (scratch.dir() != output_dir) return false;
+        artifact = scratch.artifact_path("conftest.o");
+        std::ofstream(artifact) << "obj";
+    }
+    bool ok = std::filesystem::is_directory(output_dir) &&
+              !std::filesystem::exists(artifact);
+    std::filesystem::remove_all(output_dir);
+    return ok;
+}
+
+static bool test_memfd_source() {
+    ScratchSpace scratch(ScratchBackend::kMemfd,
+                         std::filesystem::temp_directory_path());
+    std::optional<ScratchFile> src =
+        scratch.write_source("conftest.c", "int y;\n");
+    if (!src.has_value()) return false;
+    if (scratch.backend() != ScratchBackend::kMemfd) {
+        // Platforms without memfd fall back to an on-disk file.
+        return !src->in_memory();
+    }
+    return src->in_memory() && read_all(src->path()) == "int y;\n";
+}
+
+int main() {
+    std::cout << "scratch_space_test:" << std::endl;
+    TEST(parse_backend)
+    TEST(private_dir_removed)
+    TEST(output_tree_leaves_dir)
+    TEST(memfd_source)
+
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
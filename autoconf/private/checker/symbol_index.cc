@@ -0,0 +1,606 @@
+#include "autoconf/private/checker/symbol_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace rules_cc_autoconf {
+
+namespace {
+
+/** File magic of a serialized index (includes a format version). */
+constexpr char kIndexMagic[] = "RCCASYM1";
+constexpr size_t kIndexMagicSize = sizeof(kIndexMagic) - 1;
+
+/** Maximum nesting of linker scripts (libc.so -> libc.so.6, ...). */
+constexpr int kMaxLinkerScriptDepth = 4;
+
+/** Refuse to read sections or symbol tables larger than this. */
+constexpr uint64_t kMaxSectionSize = uint64_t{256} << 20;
+
+/** Only the head of a candidate linker script is inspected. */
+constexpr size_t kMaxLinkerScriptSize = 64 * 1024;
+
+// ELF constants (kept local so the index builds without <elf.h>).
+constexpr unsigned char kElfClass32 = 1;
+constexpr unsigned char kElfClass64 = 2;
+constexpr unsigned char kElfDataMsb = 2;
+constexpr uint64_t kElfTypeDyn = 3;
+constexpr uint64_t kShtDynsym = 11;
+constexpr uint64_t kShtGnuVersym = 0x6fffffff;
+constexpr uint64_t kShnUndef = 0;
+constexpr unsigned kStbGlobal = 1;
+constexpr unsigned kStbWeak = 2;
+constexpr unsigned kStbGnuUnique = 10;
+constexpr unsigned kSttSection = 3;
+constexpr unsigned kSttFile = 4;
+constexpr unsigned kStvHidden = 2;
+constexpr unsigned kStvInternal = 1;
+constexpr uint64_t kVersymHidden = 0x8000;
+constexpr uint64_t kVersymLocal = 0;
+
+/**
+ * @brief FNV-1a hash of a symbol name.
+ */
+uint64_t hash_symbol(const char* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Read an unsigned integer of `size` bytes with the given byte order.
+ */
+uint64_t read_uint(const unsigned char* p, size_t size, bool big_endian) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        size_t shift = big_endian ? (size - 1 - i) : i;
+        value |= static_cast<uint64_t>(p[i]) << (8 * shift);
+    }
+    return value;
+}
+
+/**
+ * @brief Read `size` bytes at `offset` into `out`.
+ * @return false on a short read or an implausibly large request.
+ */
+bool read_at(std::ifstream& file, uint64_t offset, uint64_t size,
+             std::vector<unsigned char>& out) {
+    if (size > kMaxSectionSize) {
+        return false;
+    }
+    out.resize(static_cast<size_t>(size));
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char*>(out.data()),
+              static_cast<std::streamsize>(size));
+    return file.gcount() == static_cast<std::streamsize>(size);
+}
+
+/**
+ * @brief Collect exported dynamic symbols of an ELF shared object.
+ * @param file Stream positioned anywhere.
+ * @param header The first 64 bytes of the file.
+ * @param hashes Receives the symbol hashes.
+ * @return true if the file is an ELF shared object with a `.dynsym`.
+ */
+bool collect_elf_symbols(std::ifstream& file,
+                         const std::vector<unsigned char>& header,
+                         std::vector<uint64_t>& hashes) {
+    const bool is64 = header[4] == kElfClass64;
+    if (!is64 && header[4] != kElfClass32) {
+        return false;
+    }
+    const bool be = header[5] == kElfDataMsb;
+    const unsigned char* h = header.data();
+
+    if (read_uint(h + 16, 2, be) != kElfTypeDyn) {
+        return false;
+    }
+    uint64_t shoff =
+        is64 ? read_uint(h + 0x28, 8, be) : read_uint(h + 0x20, 4, be);
+    uint64_t shentsize = read_uint(h + (is64 ? 0x3A : 0x2E), 2, be);
+    uint64_t shnum = read_uint(h + (is64 ? 0x3C : 0x30), 2, be);
+    if (shoff == 0 || shnum == 0 || shentsize < (is64 ? 64u : 40u)) {
+        return false;
+    }
+
+    std::vector<unsigned char> sections;
+    if (!read_at(file, shoff, shnum * shentsize, sections)) {
+        return false;
+    }
+
+    struct Section {
+        uint64_t type = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint64_t link = 0;
+        uint64_t entsize = 0;
+    };
+    auto section_at = [&](uint64_t index) {
+        const unsigned char* s = sections.data() + index * shentsize;
+        Section section;
+        section.type = read_uint(s + 4, 4, be);
+        if (is64) {
+            section.offset = read_uint(s + 24, 8, be);
+            section.size = read_uint(s + 32, 8, be);
+            section.link = read_uint(s + 40, 4, be);
+            section.entsize = read_uint(s + 56, 8, be);
+        } else {
+            section.offset = read_uint(s + 16, 4, be);
+            section.size = read_uint(s + 20, 4, be);
+            section.link = read_uint(s + 24, 4, be);
+            section.entsize = read_uint(s + 36, 4, be);
+        }
+        return section;
+    };
+
+    std::optional<Section> dynsym;
+    std::optional<Section> versym;
+    for (uint64_t i = 0; i < shnum; ++i) {
+        Section section = section_at(i);
+        if (section.type == kShtDynsym) {
+            dynsym = section;
+        } else if (section.type == kShtGnuVersym) {
+            versym = section;
+        }
+    }
+    if (!dynsym.has_value() || dynsym->link >= shnum) {
+        return false;
+    }
+    const uint64_t symsize = is64 ? 24 : 16;
+    if (dynsym->entsize != 0 && dynsym->entsize != symsize) {
+        return false;
+    }
+
+    Section strtab = section_at(dynsym->link);
+    std::vector<unsigned char> symbols;
+    std::vector<unsigned char> strings;
+    std::vector<unsigned char> versions;
+    if (!read_at(file, dynsym->offset, dynsym->size, symbols) ||
+        !read_at(file, strtab.offset, strtab.size, strings)) {
+        return false;
+    }
+    if (versym.has_value() &&
+        !read_at(file, versym->offset, versym->size, versions)) {
+        versions.clear();
+    }
+
+    const uint64_t count = dynsym->size / symsize;
+    for (uint64_t i = 1; i < count; ++i) {
+        const unsigned char* sym = symbols.data() + i * symsize;
+        uint64_t name = read_uint(sym, 4, be);
+        unsigned info = is64 ? sym[4] : sym[12];
+        unsigned other = is64 ? sym[5] : sym[13];
+        uint64_t shndx = read_uint(sym + (is64 ? 6 : 14), 2, be);
+
+        unsigned bind = info >> 4;
+        unsigned type = info & 0xf;
+        unsigned visibility = other & 0x3;
+        if (shndx == kShnUndef) continue;
+        if (bind != kStbGlobal && bind != kStbWeak && bind != kStbGnuUnique) {
+            continue;
+        }
+        if (type == kSttSection || type == kSttFile) continue;
+        if (visibility == kStvHidden || visibility == kStvInternal) continue;
+        if (!versions.empty() && (i + 1) * 2 <= versions.size()) {
+            // New links only bind default versions; hidden (compat)
+            // versions exist purely for already-linked binaries.
+            uint64_t version = read_uint(versions.data() + i * 2, 2, be);
+            if (version == kVersymLocal || (version & kVersymHidden) != 0) {
+                continue;
+            }
+        }
+        if (name >= strings.size()) continue;
+        const char* begin =
+            reinterpret_cast<const char*>(strings.data()) + name;
+        const char* end = static_cast<const char*>(
+            std::memchr(begin, '\0', strings.size() - name));
+        if (end == nullptr || end == begin) continue;
+        hashes.push_back(hash_symbol(begin, static_cast<size_t>(end - begin)));
+    }
+    return true;
+}
+
+/**
+ * @brief Collect the symbol table of a GNU/SysV `ar` archive.
+ * @param file Stream positioned anywhere.
+ * @param hashes Receives the symbol hashes.
+ * @return true if the archive is empty or starts with a `/` or `/SYM64/`
+ * symbol table.
+ */
+bool collect_archive_symbols(std::ifstream& file,
+                             std::vector<uint64_t>& hashes) {
+    std::vector<unsigned char> member;
+    if (!read_at(file, 8, 60, member)) {
+        // An archive with no members is a valid, empty library (glibc 2.34+
+        // ships libpthread.a, librt.a, ... this way).
+        file.clear();
+        file.seekg(0, std::ios::end);
+        return file.tellg() == std::streampos(8);
+    }
+    std::string name(member.begin(), member.begin() + 16);
+    size_t word = 0;
+    if (name.rfind("/SYM64/", 0) == 0) {
+        word = 8;
+    } else if (name.find_first_not_of(' ', 1) == std::string::npos &&
+               name[0] == '/') {
+        word = 4;
+    } else {
+        // BSD (`__.SYMDEF`) tables and archives without an index are not
+        // understood; the library stays unknown and checks fall back to
+        // linking.
+        return false;
+    }
+    std::string size_field(member.begin() + 48, member.begin() + 58);
+    uint64_t size = 0;
+    try {
+        size = std::stoull(size_field);
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    std::vector<unsigned char> table;
+    if (size < word || !read_at(file, 68, size, table)) {
+        return false;
+    }
+    uint64_t count = read_uint(table.data(), word, true);
+    uint64_t names = word + count * word;
+    if (count > size / word || names > table.size()) {
+        return false;
+    }
+    const char* cursor = reinterpret_cast<const char*>(table.data()) + names;
+    const char* end =
+        reinterpret_cast<const char*>(table.data()) + table.size();
+    for (uint64_t i = 0; i < count && cursor < end; ++i) {
+        const char* terminator =
+            static_cast<const char*>(std::memchr(cursor, '\0', end - cursor));
+        if (terminator == nullptr) break;
+        hashes.push_back(
+            hash_symbol(cursor, static_cast<size_t>(terminator - cursor)));
+        cursor = terminator + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Extract the files referenced by `GROUP(...)`/`INPUT(...)` in a GNU
+ * linker script.
+ * @return std::nullopt if the text is not a linker script.
+ */
+std::optional<std::vector<std::string>> parse_linker_script(
+    const std::string& text) {
+    if (text.find('\0') != std::string::npos) {
+        return std::nullopt;
+    }
+
+    std::string stripped;
+    stripped.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text.compare(i, 2, "/*") == 0) {
+            size_t close = text.find("*/", i + 2);
+            if (close == std::string::npos) break;
+            i = close + 1;
+            stripped.push_back(' ');
+            continue;
+        }
+        char c = text[i];
+        if (c == '(' || c == ')') {
+            // Make parentheses separate tokens.
+            stripped += {' ', c, ' '};
+        } else {
+            stripped.push_back(c == ',' ? ' ' : c);
+        }
+    }
+
+    std::istringstream tokens(stripped);
+    std::string token;
+    std::vector<std::string> files;
+    bool saw_command = false;
+    std::string pending;
+    int depth = 0;
+    int capture_depth = -1;
+    while (tokens >> token) {
+        if (token == "(") {
+            ++depth;
+            if (capture_depth < 0 &&
+                (pending == "GROUP" || pending == "INPUT")) {
+                capture_depth = depth;
+                saw_command = true;
+            }
+        } else if (token == ")") {
+            if (depth == capture_depth) capture_depth = -1;
+            --depth;
+        } else if (capture_depth > 0 && token != "AS_NEEDED") {
+            files.push_back(token);
+        }
+        pending = token;
+    }
+    if (!saw_command) {
+        return std::nullopt;
+    }
+    return files;
+}
+
+/**
+ * @brief Whether a path names a relocatable object rather than a library.
+ */
+bool is_object_file(const std::filesystem::path& path) {
+    std::string ext = path.extension().string();
+    return ext == ".o" || ext == ".obj" || ext == ".oS" || ext == ".lo";
+}
+
+/**
+ * @brief Trim ASCII whitespace from both ends.
+ */
+std::string trim(const std::string& value) {
+    size_t begin = value.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = value.find_last_not_of(" \t\r\n");
+    return value.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Put an unsigned integer in little-endian byte order.
+ */
+void put_uint(std::string& out, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+/**
+ * @brief Bounds-checked little-endian reader over a serialized index.
+ */
+struct IndexReader {
+    const std::string& data;
+    size_t pos = 0;
+
+    uint64_t get(size_t size) {
+        if (data.size() - pos < size) {
+            throw std::runtime_error("Truncated symbol index");
+        }
+        uint64_t value = read_uint(
+            reinterpret_cast<const unsigned char*>(data.data()) + pos, size,
+            false);
+        pos += size;
+        return value;
+    }
+
+    std::string get_string(size_t size) {
+        if (data.size() - pos < size) {
+            throw std::runtime_error("Truncated symbol index");
+        }
+        std::string value = data.substr(pos, size);
+        pos += size;
+        return value;
+    }
+};
+
+}  // namespace
+
+std::string SymbolIndex::default_library(const std::string& language) {
+    return (language == "cpp" || language == "c++") ? "<default:cpp>"
+                                                     : "<default:c>";
+}
+
+bool SymbolIndex::collect_symbols(const std::filesystem::path& file,
+                                  int depth, std::vector<uint64_t>& hashes) {
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream.is_open()) {
+        return false;
+    }
+    std::vector<unsigned char> header(64);
+    stream.read(reinterpret_cast<char*>(header.data()), 64);
+    header.resize(static_cast<size_t>(stream.gcount()));
+
+    if (header.size() == 64 && header[0] == 0x7f && header[1] == 'E' &&
+        header[2] == 'L' && header[3] == 'F') {
+        return collect_elf_symbols(stream, header, hashes);
+    }
+    std::string magic(header.begin(),
+                      header.begin() + std::min<size_t>(header.size(), 8));
+    if (magic == "!<arch>\n" || magic == "!<thin>\n") {
+        return collect_archive_symbols(stream, hashes);
+    }
+    if (depth <= 0) {
+        return false;
+    }
+
+    std::string text(kMaxLinkerScriptSize, '\0');
+    stream.clear();
+    stream.seekg(0);
+    stream.read(text.data(), static_cast<std::streamsize>(text.size()));
+    text.resize(static_cast<size_t>(stream.gcount()));
+    std::optional<std::vector<std::string>> inputs = parse_linker_script(text);
+    if (!inputs.has_value()) {
+        return false;
+    }
+
+    bool found = false;
+    for (std::string input : *inputs) {
+        // `-l` references would need the search path; leaving them out only
+        // makes the index less complete, never wrong.
+        if (input.rfind("-l", 0) == 0) continue;
+        if (!input.empty() && input[0] == '=') input.erase(0, 1);
+        std::filesystem::path path(input);
+        if (path.is_relative()) {
+            path = file.parent_path() / path;
+        }
+        found = collect_symbols(path, depth - 1, hashes) || found;
+    }
+    return found;
+}
+
+bool SymbolIndex::add_file(const std::string& library,
+                           const std::filesystem::path& file) {
+    std::vector<uint64_t> hashes;
+    if (!collect_symbols(file, kMaxLinkerScriptDepth, hashes)) {
+        return false;
+    }
+
+    uint32_t id = 0;
+    std::map<std::string, uint32_t>::const_iterator it =
+        library_ids_.find(library);
+    if (it != library_ids_.end()) {
+        id = it->second;
+    } else {
+        id = static_cast<uint32_t>(libraries_.size());
+        libraries_.push_back(library);
+        library_ids_.emplace(library, id);
+    }
+
+    std::vector<Entry> added;
+    added.reserve(hashes.size());
+    for (uint64_t hash : hashes) {
+        added.push_back(Entry{hash, id});
+    }
+    std::sort(added.begin(), added.end());
+    added.erase(std::unique(added.begin(), added.end()), added.end());
+
+    size_t middle = entries_.size();
+    entries_.insert(entries_.end(), added.begin(), added.end());
+    std::inplace_merge(entries_.begin(), entries_.begin() + middle,
+                       entries_.end());
+    entries_.erase(std::unique(entries_.begin(), entries_.end()),
+                   entries_.end());
+    return true;
+}
+
+bool SymbolIndex::has_library(const std::string& library) const {
+    return library_ids_.count(library) != 0;
+}
+
+bool SymbolIndex::contains(const std::string& library,
+                           const std::string& symbol) const {
+    std::map<std::string, uint32_t>::const_iterator it =
+        library_ids_.find(library);
+    if (it == library_ids_.end()) {
+        return false;
+    }
+    Entry key{hash_symbol(symbol.data(), symbol.size()), it->second};
+    return std::binary_search(entries_.begin(), entries_.end(), key);
+}
+
+void SymbolIndex::write(const std::filesystem::path& path) const {
+    std::string data(kIndexMagic, kIndexMagicSize);
+    put_uint(data, libraries_.size(), 4);
+    for (const std::string& library : libraries_) {
+        put_uint(data, library.size(), 4);
+        data += library;
+    }
+    put_uint(data, entries_.size(), 8);
+    data.reserve(data.size() + entries_.size() * 12);
+    for (const Entry& entry : entries_) {
+        put_uint(data, entry.hash, 8);
+        put_uint(data, entry.library, 4);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open symbol index for writing: " +
+                                 path.string());
+    }
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!out) {
+        throw std::runtime_error("Failed to write symbol index: " +
+                                 path.string());
+    }
+}
+
+SymbolIndex SymbolIndex::read(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open symbol index: " +
+                                 path.string());
+    }
+    std::string data((std::istreambuf_iterator<char>(in)),
+                     std::istreambuf_iterator<char>());
+
+    IndexReader reader{data};
+    if (reader.get_string(kIndexMagicSize) != kIndexMagic) {
+        throw std::runtime_error("Not a symbol index: " + path.string());
+    }
+
+    SymbolIndex index;
+    uint64_t library_count = reader.get(4);
+    for (uint64_t i = 0; i < library_count; ++i) {
+        std::string library = reader.get_string(reader.get(4));
+        index.library_ids_.emplace(library, static_cast<uint32_t>(i));
+        index.libraries_.push_back(std::move(library));
+    }
+    uint64_t entry_count = reader.get(8);
+    if (entry_count > (data.size() - reader.pos) / 12) {
+        throw std::runtime_error("Truncated symbol index: " + path.string());
+    }
+    index.entries_.reserve(static_cast<size_t>(entry_count));
+    for (uint64_t i = 0; i < entry_count; ++i) {
+        Entry entry{};
+        entry.hash = reader.get(8);
+        entry.library = static_cast<uint32_t>(reader.get(4));
+        if (entry.library >= library_count) {
+            throw std::runtime_error("Corrupt symbol index: " + path.string());
+        }
+        index.entries_.push_back(entry);
+    }
+    if (!std::is_sorted(index.entries_.begin(), index.entries_.end())) {
+        std::sort(index.entries_.begin(), index.entries_.end());
+    }
+    return index;
+}
+
+std::vector<std::filesystem::path> parse_link_trace(const std::string& output) {
+    std::vector<std::filesystem::path> files;
+    std::set<std::string> seen;
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        line = trim(line);
+        if (line.empty()) continue;
+
+        std::vector<std::string> candidates;
+        size_t open = line.find('(');
+        size_t close = line.find(')', open == std::string::npos ? 0 : open);
+        if (open != std::string::npos && close != std::string::npos) {
+            if (open == 0 || line.rfind("-l", 0) == 0) {
+                // `(archive)member` (GNU ld) or `-lname (path)`.
+                candidates.push_back(line.substr(open + 1, close - open - 1));
+            } else {
+                // `archive(member)` (lld, mold).
+                candidates.push_back(trim(line.substr(0, open)));
+            }
+        }
+        candidates.push_back(line);
+        size_t colon = line.rfind(": ");
+        if (colon != std::string::npos) {
+            // `ld.gold: path`
+            candidates.push_back(trim(line.substr(colon + 2)));
+        }
+
+        for (const std::string& candidate : candidates) {
+            std::error_code ec;
+            std::filesystem::path path =
+                std::filesystem::path(candidate).lexically_normal();
+            if (candidate.empty() || is_object_file(path) ||
+                !std::filesystem::is_regular_file(path, ec)) {
+                continue;
+            }
+            if (seen.insert(path.string()).second) {
+                files.push_back(path);
+            }
+            break;
+        }
+    }
+    return files;
+}
+
+}  // namespace rules_cc_autoconf
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rules_cc_autoconf {
+
+/**
+ * @brief Hashed symbol -> library index for a toolchain.
+ *
+ * Built once per toolchain from the libraries a default link pulls in, as
+ * listed by the linker trace. Function checks and the first (no extra
+ * library) probe of AC_SEARCH_LIBS consult it before linking: a symbol
+ * exported by a library the default link is known to accept resolves, so
+ * the link can be skipped. `-l<name>` probes always link, since the named
+ * library may bring dependencies that do not resolve.
+ *
+ * The index only ever answers positively. A symbol that is not found may
+ * still be provided by something the index cannot see (linker-provided
+ * symbols, unparsed inputs, hash-less formats), so misses fall back to a
+ * real link.
+ *
+ * Shared objects contribute their exported dynamic symbols (ELF `.dynsym`,
+ * skipping undefined, local, hidden and non-default-version entries).
+ * Archives contribute their symbol table. GNU linker scripts (e.g. glibc's
+ * `libc.so`) contribute the files they reference.
+ */
+class SymbolIndex {
+   public:
+    /**
+     * @brief Name of the pseudo-library holding the symbols a plain link
+     * for `language` resolves without any extra `-l` flag.
+     * @param language Check language ("c" or "cpp").
+     */
+    static std::string default_library(const std::string& language);
+
+    /**
+     * @brief Index a library file (shared object, archive or linker script).
+     * @param library Library name (without `-l`/`lib` decoration) or a
+     *                default_library() name.
+     * @param file Path to the file providing the library.
+     * @return true if the file was recognized and indexed.
+     */
+    bool add_file(const std::string& library,
+                  const std::filesystem::path& file);
+
+    /**
+     * @brief Whether `library` was indexed.
+     */
+    bool has_library(const std::string& library) const;
+
+    /**
+     * @brief Whether `library` is known to export `symbol`.
+     * @return false if the symbol was not found or the library is unknown.
+     */
+    bool contains(const std::string& library, const std::string& symbol) const;
+
+    /** @brief Number of indexed libraries. */
+    size_t library_count() const { return libraries_.size(); }
+
+    /** @brief Number of (symbol, library) entries. */
+    size_t entry_count() const { return entries_.size(); }
+
+    /**
+     * @brief Write the index to a file.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void write(const std::filesystem::path& path) const;
+
+    /**
+     * @brief Load an index written by write().
+     * @throws std::runtime_error if the file is missing or malformed.
+     */
+    static SymbolIndex read(const std::filesystem::path& path);
+
+   private:
+    /** @brief One exported symbol. */
+    struct Entry {
+        uint64_t hash;     ///< Hash of the symbol name
+        uint32_t library;  ///< Id of the exporting library
+
+        bool operator<(const Entry& other) const {
+            return hash != other.hash ? hash < other.hash
+                                      : library < other.library;
+        }
+        bool operator==(const Entry& other) const {
+            return hash == other.hash && library == other.library;
+        }
+    };
+
+    std::vector<std::string> libraries_{};  ///< Library names by id
+    std::map<std::string, uint32_t> library_ids_{};  ///< Name -> id
+    std::vector<Entry> entries_{};  ///< Sorted, deduplicated entries
+
+    /**
+     * @brief Collect the symbol hashes exported by a file.
+     * @param file Shared object, archive or linker script.
+     * @param depth Remaining linker script nesting depth.
+     * @param hashes Receives the hashes.
+     * @return true if the file (or any file it references) was recognized.
+     */
+    static bool collect_symbols(const std::filesystem::path& file, int depth,
+                                std::vector<uint64_t>& hashes);
+};
+
+/**
+ * @brief Extract the input files from a linker `-t`/`--trace` listing.
+ *
+ * Handles the formats printed by GNU ld, gold, lld and mold:
+ * `path`, `path(member)`, `(path)member` and `-lname (path)`.
+ * Only entries that exist on disk are returned, in order, without duplicates.
+ *
+ * @param output Combined stdout/stderr of the link.
+ * @return Shared objects, archives and linker scripts used by the link.
+ */
+std::vector<std::filesystem::path> parse_link_trace(const std::string& output);
+
+}  // namespace rules_cc_autoconf
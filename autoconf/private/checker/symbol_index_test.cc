@@ -0,0 +1,147 @@
+#include "autoconf/private/checker/symbol_index.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using rules_cc_autoconf::parse_link_trace;
+using rules_cc_autoconf::SymbolIndex;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+static std::filesystem::path test_dir() {
+    std::filesystem::path dir =
+        std::filesystem::temp_directory_path() / "symbol_index_test";
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+static void write_file(const std::filesystem::path& path,
+                       const std::string& content) {
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+}
+
+/** Build a GNU `ar` archive whose symbol table lists `symbols`. */
+static std::string make_archive(const std::vector<std::string>& symbols) {
+    std::string table;
+    auto put_be32 = [&table](uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            table.push_back(static_cast<char>((value >> shift) & 0xff));
+        }
+    };
+    put_be32(static_cast<uint32_t>(symbols.size()));
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        put_be32(0);
+    }
+    for (const std::string& symbol : symbols) {
+        table += symbol;
+        table.push_back('\0');
+    }
+
+    std::string header = "/";
+    header.resize(48, ' ');
+    std::string size = std::to_string(table.size());
+    size.resize(10, ' ');
+    header += size + "`\n";
+    return "!<arch>\n" + header + table;
+}
+
+static bool test_archive_symbols() {
+    std::filesystem::path archive = test_dir() / "libdemo.a";
+    write_file(archive, make_archive({"demo_open", "demo_close"}));
+
+    SymbolIndex index;
+    if (!index.add_file("demo", archive)) return false;
+    return index.has_library("demo") && index.contains("demo", "demo_open") &&
+           index.contains("demo", "demo_close") &&
+           !index.contains("demo", "demo_read") &&
+           !index.contains("other", "demo_open");
+}
+
+static bool test_linker_script() {
+    std::filesystem::path dir = test_dir();
+    write_file(dir / "libreal.a", make_archive({"real_fn"}));
+    write_file(dir / "libscript.so",
+               "/* GNU ld script */\n"
+               "OUTPUT_FORMAT(elf64-x86-64)\n"
+               "GROUP ( libreal.a AS_NEEDED ( -lmissing ) )\n");
+
+    SymbolIndex index;
+    return index.add_file("script", dir / "libscript.so") &&
+           index.contains("script", "real_fn");
+}
+
+static bool test_unknown_file_rejected() {
+    std::filesystem::path file = test_dir() / "libjunk.so";
+    write_file(file, std::string("\0\1\2garbage", 10));
+
+    SymbolIndex index;
+    return !index.add_file("junk", file) && !index.has_library("junk");
+}
+
+static bool test_round_trip() {
+    std::filesystem::path dir = test_dir();
+    write_file(dir / "libone.a", make_archive({"one_fn", "shared_fn"}));
+    write_file(dir / "libtwo.a", make_archive({"two_fn", "shared_fn"}));
+
+    SymbolIndex index;
+    index.add_file(SymbolIndex::default_library("c"), dir / "libone.a");
+    index.add_file("two", dir / "libtwo.a");
+    index.write(dir / "index.bin");
+
+    SymbolIndex loaded = SymbolIndex::read(dir / "index.bin");
+    return loaded.library_count() == 2 && loaded.entry_count() == 4 &&
+           loaded.contains(SymbolIndex::default_library("c"), "one_fn") &&
+           loaded.contains(SymbolIndex::default_library("c"), "shared_fn") &&
+           !loaded.contains(SymbolIndex::default_library("cpp"), "one_fn") &&
+           loaded.contains("two", "shared_fn") &&
+           !loaded.contains("two", "one_fn");
+}
+
+static bool test_parse_link_trace() {
+    std::filesystem::path dir = test_dir();
+    write_file(dir / "libc.so.6", "x");
+    write_file(dir / "libc_nonshared.a", "x");
+    write_file(dir / "libgcc.a", "x");
+    write_file(dir / "crt1.o", "x");
+
+    std::string trace = (dir / "crt1.o").string() + "\n" +
+                        (dir / "libc.so.6").string() + "\n" + "(" +
+                        (dir / "libc_nonshared.a").string() + ")elf-init.oS\n" +
+                        "-lgcc (" + (dir / "libgcc.a").string() + ")\n" +
+                        (dir / "libgcc.a").string() + "(unwind.o)\n" +
+                        "/nonexistent/libz.so\n";
+    std::vector<std::filesystem::path> files = parse_link_trace(trace);
+    return files.size() == 3 && files[0].filename() == "libc.so.6" &&
+           files[1].filename() == "libc_nonshared.a" &&
+           files[2].filename() == "libgcc.a";
+}
+
+int main() {
+    std::cout << "symbol_index_test:" << std::endl;
+    TEST(archive_symbols)
+    TEST(linker_script)
+    TEST(unknown_file_rejected)
+    TEST(round_trip)
+    TEST(parse_link_trace)
+
+    std::filesystem::remove_all(test_dir());
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
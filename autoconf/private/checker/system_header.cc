@@ -11,8 +11,8 @@
 #include <windows.h>
 #endif
 
-#include "autoconf/private/checker/debug_logger.h"
 #include "autoconf/private/common/file_util.h"
+#include "autoconf/private/common/trace.h"
 
 namespace rules_cc_autoconf {
 
@@ -103,24 +103,25 @@ std::optional<std::string> read_file_content(
 std::optional<std::filesystem::path> find_system_header_path(
     const std::string& compiler, const std::vector<std::string>& flags,
     const std::string& compiler_type, const std::string& header,
-    const std::string& source_id, const std::filesystem::path& source_dir) {
+    const std::string& source_id, ScratchSpace& scratch) {
     bool msvc = compiler_type.rfind("msvc", 0) == 0;
 
     // Write a minimal source file that includes the target header
     std::string extension = ".c";
     std::string src_code = "#include <" + header + ">\n";
-    std::filesystem::path src_path =
-        source_dir / (source_id + ".gl_next" + extension);
-    std::filesystem::path pp_out = source_dir / (source_id + ".gl_next.i");
-
-    {
-        std::ofstream src = open_ofstream(src_path);
-        if (!src.is_open()) {
-            DebugLogger::warn("GL_NEXT_HEADER: failed to write source for " +
-                              header);
-            return std::nullopt;
-        }
-        src << src_code;
+    std::filesystem::path pp_out =
+        scratch.artifact_path(source_id + ".gl_next.i");
+
+    std::optional<ScratchFile> src =
+        scratch.write_source(source_id + ".gl_next" + extension, src_code);
+    if (!src.has_value()) {
+        AUTOCONF_TRACE_WARN("GL_NEXT_HEADER: failed to write source",
+                            {"header", header});
+        return std::nullopt;
+    }
+    std::string src_arg = quote_arg(src->path().string());
+    if (src->in_memory()) {
+        src_arg = "-x c " + src_arg + " -x none";
     }
 
     // Build the preprocessor command
@@ -138,14 +139,15 @@ std::optional<std::filesystem::path> find_system_header_path(
     if (msvc) {
         // MSVC: /E writes preprocessed output to stdout, /EP suppresses #line
         // markers so we use /E to keep them
-        cmd << " /E " << quote_arg(src_path.string());
+        cmd << " /E " << src_arg;
         cmd << " > " << quote_arg(pp_out.string()) << " 2>NUL";
     } else {
-        cmd << " -E " << quote_arg(src_path.string());
+        cmd << " -E " << src_arg;
         cmd << " -o " << quote_arg(pp_out.string()) << " 2>/dev/null";
     }
 
-    DebugLogger::debug("GL_NEXT_HEADER: running preprocessor: " + cmd.str());
+    AUTOCONF_TRACE_DEBUG("GL_NEXT_HEADER: running preprocessor",
+                         {"command", cmd.str()});
 
     int rc = std::system(cmd.str().c_str());
 #ifndef _WIN32
@@ -153,22 +155,25 @@ std::optional<std::filesystem::path> find_system_header_path(
 #endif
 
     // Clean up source file
+    src.reset();
+
+    // Read preprocessor output, then clean it up
+    std::optional<std::string> pp_content;
+    if (rc == 0) {
+        pp_content = read_file_content(pp_out);
+    }
     std::error_code ec;
-    file_remove(src_path, ec);
+    file_remove(pp_out, ec);
 
     if (rc != 0) {
-        DebugLogger::debug("GL_NEXT_HEADER: preprocessor failed for " + header +
-                           " (rc=" + std::to_string(rc) + ")");
-        file_remove(pp_out, ec);
+        AUTOCONF_TRACE_DEBUG("GL_NEXT_HEADER: preprocessor failed",
+                             {"header", header}, {"exit_code", rc});
         return std::nullopt;
     }
 
-    // Read and parse preprocessor output
-    auto pp_content = read_file_content(pp_out);
-    file_remove(pp_out, ec);
-
     if (!pp_content.has_value()) {
-        DebugLogger::warn("GL_NEXT_HEADER: could not read preprocessor output");
+        AUTOCONF_TRACE_WARN(
+            "GL_NEXT_HEADER: could not read preprocessor output");
         return std::nullopt;
     }
 
@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 
+#include "autoconf/private/checker/scratch_space.h"
+
 namespace rules_cc_autoconf {
 
 /**
@@ -18,13 +20,13 @@ namespace rules_cc_autoconf {
  * @param compiler_type Compiler type string (e.g., "msvc-cl", "gcc").
  * @param header Header name (e.g., "stddef.h").
  * @param source_id Unique identifier for temporary source files.
- * @param source_dir Directory for temporary source files.
+ * @param scratch Scratch space for the temporary source and `.i` files.
  * @return Absolute path to the system header, or nullopt if not found.
  */
 std::optional<std::filesystem::path> find_system_header_path(
     const std::string& compiler, const std::vector<std::string>& flags,
     const std::string& compiler_type, const std::string& header,
-    const std::string& source_id, const std::filesystem::path& source_dir);
+    const std::string& source_id, ScratchSpace& scratch);
 
 /**
  * @brief Parse preprocessor output to extract the path of an included header.
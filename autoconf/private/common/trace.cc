@@ -0,0 +1,440 @@
+#include "autoconf/private/common/trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace rules_cc_autoconf {
+namespace trace {
+
+namespace detail {
+
+std::atomic<int> g_max_level{-1};
+
+int init_level() {
+    int level = static_cast<int>(Level::kError);
+    const char* env = std::getenv("RULES_CC_AUTOCONF_DEBUG");
+    if (env != nullptr) {
+        std::string value(env);
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        level = value == "debug" || value == "2"
+                    ? static_cast<int>(Level::kDebug)
+                    : static_cast<int>(Level::kInfo);
+    }
+    // A concurrent set_level() wins over the environment.
+    int expected = -1;
+    g_max_level.compare_exchange_strong(expected, level);
+    return g_max_level.load();
+}
+
+}  // namespace detail
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Append `value` as a JSON string literal.
+ */
+void append_json_string(std::string& out, std::string_view value) {
+    out.push_back('"');
+    for (char c : value) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[7];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+                                  static_cast<unsigned char>(c));
+                    out += escaped;
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+/**
+ * @brief Append a field value as JSON.
+ */
+void append_json_value(std::string& out, const Field& field) {
+    switch (field.kind()) {
+        case Field::Kind::kNone:
+            out += "null";
+            break;
+        case Field::Kind::kBool:
+            out += field.as_bool() ? "true" : "false";
+            break;
+        case Field::Kind::kInt:
+            out += std::to_string(field.as_int());
+            break;
+        case Field::Kind::kUint:
+            out += std::to_string(field.as_uint());
+            break;
+        case Field::Kind::kDouble: {
+            std::ostringstream number;
+            number << field.as_double();
+            out += number.str();
+            break;
+        }
+        case Field::Kind::kString:
+            append_json_string(out, field.as_string());
+            break;
+        case Field::Kind::kStrings: {
+            out.push_back('[');
+            const std::vector<std::string>& values = field.as_strings();
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (i > 0) {
+                    out.push_back(',');
+                }
+                append_json_string(out, values[i]);
+            }
+            out.push_back(']');
+            break;
+        }
+        case Field::Kind::kPath:
+            append_json_string(out, field.as_path().string());
+            break;
+    }
+}
+
+/**
+ * @brief Append the fields of `event` as JSON object members.
+ */
+void append_json_fields(std::string& out, const Event& event) {
+    for (size_t i = 0; i < event.field_count; ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        append_json_string(out, event.fields[i].key());
+        out.push_back(':');
+        append_json_value(out, event.fields[i]);
+    }
+}
+
+/**
+ * @brief Append a text value, quoted when it contains whitespace.
+ */
+void append_text_value(std::string& out, std::string_view value) {
+    if (!value.empty() &&
+        value.find_first_of(" \t\n\"") == std::string_view::npos) {
+        out += value;
+        return;
+    }
+    append_json_string(out, value);
+}
+
+const char* level_name(Level level) {
+    switch (level) {
+        case Level::kError:
+            return "error";
+        case Level::kWarn:
+            return "warn";
+        case Level::kInfo:
+            return "info";
+        case Level::kDebug:
+            return "debug";
+    }
+    return "debug";
+}
+
+class TextSink : public Sink {
+   public:
+    TextSink(std::ostream& out, std::ostream& info_out)
+        : out_(out), info_out_(info_out) {}
+
+    void write(const Event& event) override {
+        std::string line;
+        switch (event.level) {
+            case Level::kError:
+                line = "Error: ";
+                break;
+            case Level::kWarn:
+                line = "Warning: ";
+                break;
+            case Level::kInfo:
+                break;
+            case Level::kDebug:
+                line = "Debug: ";
+                break;
+        }
+        line += event.message;
+        for (size_t i = 0; i < event.field_count; ++i) {
+            const Field& field = event.fields[i];
+            line.push_back(' ');
+            line += field.key();
+            line.push_back('=');
+            switch (field.kind()) {
+                case Field::Kind::kString:
+                    append_text_value(line, field.as_string());
+                    break;
+                case Field::Kind::kPath:
+                    append_text_value(line, field.as_path().string());
+                    break;
+                default:
+                    append_json_value(line, field);
+            }
+        }
+        if (event.duration_us >= 0) {
+            char duration[32];
+            std::snprintf(duration, sizeof(duration), " (%.3f ms)",
+                          static_cast<double>(event.duration_us) / 1000.0);
+            line += duration;
+        }
+        line.push_back('\n');
+        std::ostream& out = event.level == Level::kInfo ? info_out_ : out_;
+        out << line << std::flush;
+    }
+
+   private:
+    std::ostream& out_;
+    std::ostream& info_out_;
+};
+
+class JsonLinesSink : public Sink {
+   public:
+    explicit JsonLinesSink(const std::filesystem::path& path)
+        : out_(path, std::ios::app) {}
+
+    void write(const Event& event) override {
+        std::string line = "{\"ts_us\":" + std::to_string(event.timestamp_us);
+        line += ",\"level\":\"";
+        line += level_name(event.level);
+        line += "\",\"message\":";
+        append_json_string(line, event.message);
+        if (event.duration_us >= 0) {
+            line += ",\"dur_us\":" + std::to_string(event.duration_us);
+        }
+        if (event.field_count > 0) {
+            line += ",\"fields\":{";
+            append_json_fields(line, event);
+            line.push_back('}');
+        }
+        line += "}\n";
+        out_ << line << std::flush;
+    }
+
+   private:
+    std::ofstream out_;
+};
+
+long current_pid() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return getpid();
+#endif
+}
+
+class TraceEventSink : public Sink {
+   public:
+    explicit TraceEventSink(const std::filesystem::path& path)
+        : out_(per_process_path(path), std::ios::trunc),
+          pid_(current_pid()) {
+        out_ << "[\n";
+    }
+
+    ~TraceEventSink() override { out_ << "\n]\n"; }
+
+    void write(const Event& event) override {
+        std::string line = first_ ? "" : ",\n";
+        first_ = false;
+        line += "{\"name\":";
+        append_json_string(line, event.message);
+        line += ",\"cat\":\"";
+        line += level_name(event.level);
+        line += "\",\"pid\":" + std::to_string(pid_);
+        line += ",\"tid\":" + std::to_string(std::hash<std::thread::id>()(
+                                  std::this_thread::get_id()) %
+                              100000);
+        if (event.duration_us >= 0) {
+            line += ",\"ph\":\"X\",\"ts\":" +
+                    std::to_string(event.timestamp_us - event.duration_us) +
+                    ",\"dur\":" + std::to_string(event.duration_us);
+        } else {
+            line += ",\"ph\":\"i\",\"s\":\"t\",\"ts\":" +
+                    std::to_string(event.timestamp_us);
+        }
+        line += ",\"args\":{";
+        append_json_fields(line, event);
+        line += "}}";
+        out_ << line << std::flush;
+    }
+
+   private:
+    std::ofstream out_;
+    long pid_ = 0;
+    bool first_ = true;
+};
+
+/**
+ * @brief Process-wide tracing state.
+ */
+struct Tracer {
+    std::mutex mutex{};
+    bool configured = false;  ///< Whether `sinks` is initialized
+    std::vector<std::unique_ptr<Sink>> sinks{};
+};
+
+/**
+ * @brief The tracer, never destroyed so events emitted during static
+ * destruction still have their sinks. A trace event file therefore lacks
+ * its closing bracket, which the format allows.
+ */
+Tracer& tracer() {
+    static Tracer* instance = new Tracer();
+    return *instance;
+}
+
+/**
+ * @brief Create the sinks listed in RULES_CC_AUTOCONF_TRACE.
+ */
+std::vector<std::unique_ptr<Sink>> sinks_from_env() {
+    std::vector<std::unique_ptr<Sink>> sinks;
+    const char* env = std::getenv("RULES_CC_AUTOCONF_TRACE");
+    std::string spec = env == nullptr || *env == '\0' ? "text" : env;
+
+    std::istringstream entries(spec);
+    std::string entry;
+    while (std::getline(entries, entry, ',')) {
+        if (entry == "text") {
+            sinks.push_back(make_text_sink(std::cerr, std::cout));
+        } else if (entry.rfind("jsonl:", 0) == 0) {
+            sinks.push_back(make_json_lines_sink(entry.substr(6)));
+        } else if (entry.rfind("events:", 0) == 0) {
+            sinks.push_back(make_trace_event_sink(entry.substr(7)));
+        } else if (!entry.empty()) {
+            std::cerr << "Warning: ignoring unknown RULES_CC_AUTOCONF_TRACE "
+                         "sink: "
+                      << entry << std::endl;
+        }
+    }
+    return sinks;
+}
+
+/**
+ * @brief Hand an event to every sink.
+ */
+void dispatch(Event& event) {
+    Tracer& state = tracer();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.configured) {
+        state.sinks = sinks_from_env();
+        state.configured = true;
+    }
+    // Wall clock time, so the files of concurrent processes merge into one
+    // timeline.
+    event.timestamp_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    for (const std::unique_ptr<Sink>& sink : state.sinks) {
+        sink->write(event);
+    }
+}
+
+}  // namespace
+
+std::unique_ptr<Sink> make_text_sink(std::ostream& out,
+                                     std::ostream& info_out) {
+    return std::make_unique<TextSink>(out, info_out);
+}
+
+std::unique_ptr<Sink> make_json_lines_sink(const std::filesystem::path& path) {
+    return std::make_unique<JsonLinesSink>(path);
+}
+
+std::unique_ptr<Sink> make_trace_event_sink(
+    const std::filesystem::path& path) {
+    return std::make_unique<TraceEventSink>(path);
+}
+
+std::filesystem::path per_process_path(const std::filesystem::path& path) {
+    std::filesystem::path result = path;
+    result.replace_filename(path.stem().string() + "." +
+                            std::to_string(current_pid()) +
+                            path.extension().string());
+    return result;
+}
+
+void set_sinks(std::vector<std::unique_ptr<Sink>> sinks) {
+    Tracer& state = tracer();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.sinks = std::move(sinks);
+    state.configured = true;
+}
+
+void set_level(Level level) {
+    detail::g_max_level.store(static_cast<int>(level));
+}
+
+void emit(Level level, std::string_view message, Field f1, Field f2,
+          Field f3, Field f4, Field f5, Field f6) {
+    Field all[] = {f1, f2, f3, f4, f5, f6};
+    Field fields[6];
+    size_t count = 0;
+    for (const Field& field : all) {
+        if (field.kind() != Field::Kind::kNone) {
+            fields[count++] = field;
+        }
+    }
+
+    Event event;
+    event.level = level;
+    event.message = message;
+    event.fields = fields;
+    event.field_count = count;
+    dispatch(event);
+}
+
+Span::Span(Level level, const char* name)
+    : level_(level), name_(name), active_(enabled(level)) {
+    if (active_) {
+        start_ = Clock::now();
+    }
+}
+
+Span::~Span() {
+    if (!active_) {
+        return;
+    }
+    Event event;
+    event.level = level_;
+    event.message = name_;
+    event.duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                            Clock::now() - start_)
+                            .count();
+    dispatch(event);
+}
+
+}  // namespace trace
+}  // namespace rules_cc_autoconf
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Structured tracing for the autoconf tools.
+ *
+ * Events carry a message and typed key/value fields. The trace macros only
+ * evaluate their arguments when the level is enabled, so a disabled event
+ * costs one relaxed atomic load:
+ *
+ * @code
+ * AUTOCONF_TRACE_DEBUG("Executing command", {"label", label}, {"argv", cmd});
+ * @endcode
+ *
+ * The level follows RULES_CC_AUTOCONF_DEBUG (RUST_LOG convention):
+ * - unset: errors only
+ * - set to anything: warnings and info
+ * - "debug" (or "2"): everything
+ *
+ * Events go to the sinks listed in RULES_CC_AUTOCONF_TRACE, a comma
+ * separated list of:
+ * - `text`: human readable lines; info on stdout, the rest on stderr
+ *   (the default)
+ * - `jsonl:PATH`: one JSON object per event, appended, so processes can
+ *   share PATH
+ * - `events:PATH`: Chrome/Perfetto trace event format, spans as slices, one
+ *   file per process (see per_process_path())
+ */
+
+namespace rules_cc_autoconf {
+namespace trace {
+
+/** Severity of an event, most severe first. */
+enum class Level : int {
+    kError = 0,  ///< Always shown
+    kWarn = 1,   ///< Shown when RULES_CC_AUTOCONF_DEBUG is set
+    kInfo = 2,   ///< Shown when RULES_CC_AUTOCONF_DEBUG is set
+    kDebug = 3,  ///< Shown when RULES_CC_AUTOCONF_DEBUG=debug
+};
+
+/**
+ * @brief A typed key/value pair attached to an event.
+ *
+ * Fields refer to their key and value without copying; they only live for
+ * the duration of the trace call.
+ */
+class Field {
+   public:
+    /** What the value holds. */
+    enum class Kind {
+        kNone,  ///< No field (an unused argument of emit())
+        kBool,
+        kInt,
+        kUint,
+        kDouble,
+        kString,
+        kStrings,
+        kPath,
+    };
+
+    Field() = default;
+
+    Field(std::string_view key, bool value) : key_(key), kind_(Kind::kBool) {
+        scalar_.b = value;
+    }
+
+    template <typename T,
+              std::enable_if_t<std::is_integral_v<T> &&
+                                   !std::is_same_v<T, bool> &&
+                                   !std::is_same_v<T, char>,
+                               int> = 0>
+    Field(std::string_view key, T value) : key_(key) {
+        if constexpr (std::is_signed_v<T>) {
+            kind_ = Kind::kInt;
+            scalar_.i = static_cast<int64_t>(value);
+        } else {
+            kind_ = Kind::kUint;
+            scalar_.u = static_cast<uint64_t>(value);
+        }
+    }
+
+    Field(std::string_view key, double value)
+        : key_(key), kind_(Kind::kDouble) {
+        scalar_.d = value;
+    }
+
+    Field(std::string_view key, const char* value)
+        : key_(key), kind_(Kind::kString), string_(value) {}
+
+    Field(std::string_view key, std::string_view value)
+        : key_(key), kind_(Kind::kString), string_(value) {}
+
+    Field(std::string_view key, const std::string& value)
+        : key_(key), kind_(Kind::kString), string_(value) {}
+
+    Field(std::string_view key, const std::vector<std::string>& value)
+        : key_(key), kind_(Kind::kStrings), strings_(&value) {}
+
+    Field(std::string_view key, const std::filesystem::path& value)
+        : key_(key), kind_(Kind::kPath), path_(&value) {}
+
+    std::string_view key() const { return key_; }
+    Kind kind() const { return kind_; }
+    bool as_bool() const { return scalar_.b; }
+    int64_t as_int() const { return scalar_.i; }
+    uint64_t as_uint() const { return scalar_.u; }
+    double as_double() const { return scalar_.d; }
+    std::string_view as_string() const { return string_; }
+    const std::vector<std::string>& as_strings() const { return *strings_; }
+    const std::filesystem::path& as_path() const { return *path_; }
+
+   private:
+    std::string_view key_{};
+    Kind kind_ = Kind::kNone;
+    union {
+        bool b;
+        int64_t i;
+        uint64_t u;
+        double d;
+    } scalar_{};
+    std::string_view string_{};
+    const std::vector<std::string>* strings_ = nullptr;
+    const std::filesystem::path* path_ = nullptr;
+};
+
+/**
+ * @brief One event, as handed to the sinks.
+ */
+struct Event {
+    Level level = Level::kDebug;
+    std::string_view message{};
+    const Field* fields = nullptr;  ///< The event's fields
+    size_t field_count = 0;         ///< Number of `fields`
+    ///< Microseconds since the Unix epoch
+    int64_t timestamp_us = 0;
+    ///< Duration of a span, or -1 for a point event
+    int64_t duration_us = -1;
+};
+
+/**
+ * @brief Receives enabled events. Calls are serialized.
+ */
+class Sink {
+   public:
+    virtual ~Sink() = default;
+
+    /** @brief Record an event. */
+    virtual void write(const Event& event) = 0;
+};
+
+/**
+ * @brief Human readable lines: `Debug: message key=value ...`.
+ * @param out Receives warnings, errors and debug events.
+ * @param info_out Receives info events, without a prefix.
+ */
+std::unique_ptr<Sink> make_text_sink(std::ostream& out,
+                                     std::ostream& info_out);
+
+/** @brief One JSON object per line. */
+std::unique_ptr<Sink> make_json_lines_sink(const std::filesystem::path& path);
+
+/**
+ * @brief A JSON array in the Chrome/Perfetto trace event format.
+ *
+ * A JSON array cannot be shared, so each process writes its own file at
+ * per_process_path(`path`).
+ */
+std::unique_ptr<Sink> make_trace_event_sink(const std::filesystem::path& path);
+
+/**
+ * @brief `path` with the current process id before its extension
+ * (`trace.json` becomes `trace.1234.json`).
+ */
+std::filesystem::path per_process_path(const std::filesystem::path& path);
+
+/** @brief Replace the sinks configured from the environment. */
+void set_sinks(std::vector<std::unique_ptr<Sink>> sinks);
+
+/** @brief Override the level read from the environment. */
+void set_level(Level level);
+
+namespace detail {
+
+///< Most verbose enabled level, or -1 before the environment is read
+extern std::atomic<int> g_max_level;
+
+/** @brief Read RULES_CC_AUTOCONF_DEBUG. */
+int init_level();
+
+}  // namespace detail
+
+/** @brief Whether events of `level` reach the sinks. */
+inline bool enabled(Level level) {
+    int max_level = detail::g_max_level.load(std::memory_order_relaxed);
+    if (max_level < 0) {
+        max_level = detail::init_level();
+    }
+    return static_cast<int>(level) <= max_level;
+}
+
+/**
+ * @brief Send an event to the sinks. Prefer the AUTOCONF_TRACE_* macros,
+ * which skip evaluating the fields when the level is disabled.
+ */
+void emit(Level level, std::string_view message, Field f1 = {}, Field f2 = {},
+          Field f3 = {}, Field f4 = {}, Field f5 = {}, Field f6 = {});
+
+/**
+ * @brief Times a scope and emits it as one event when the scope ends.
+ */
+class Span {
+   public:
+    /**
+     * @param level Level of the event.
+     * @param name Event message; must outlive the span (a literal).
+     */
+    Span(Level level, const char* name);
+    ~Span();
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+   private:
+    Level level_;
+    const char* name_;
+    bool active_;  ///< Whether the level was enabled at construction
+    std::chrono::steady_clock::time_point start_{};
+};
+
+}  // namespace trace
+}  // namespace rules_cc_autoconf
+
+/** Emit an event of `level`; arguments are a message and up to 6 fields. */
+#define AUTOCONF_TRACE(level, ...)                                    \
+    do {                                                              \
+        if (::rules_cc_autoconf::trace::enabled(level)) {             \
+            ::rules_cc_autoconf::trace::emit(level, __VA_ARGS__);     \
+        }                                                             \
+    } while (0)
+
+#define AUTOCONF_TRACE_ERROR(...) \
+    AUTOCONF_TRACE(::rules_cc_autoconf::trace::Level::kError, __VA_ARGS__)
+#define AUTOCONF_TRACE_WARN(...) \
+    AUTOCONF_TRACE(::rules_cc_autoconf::trace::Level::kWarn, __VA_ARGS__)
+#define AUTOCONF_TRACE_INFO(...) \
+    AUTOCONF_TRACE(::rules_cc_autoconf::trace::Level::kInfo, __VA_ARGS__)
+#define AUTOCONF_TRACE_DEBUG(...) \
+    AUTOCONF_TRACE(::rules_cc_autoconf::trace::Level::kDebug, __VA_ARGS__)
@@ -0,0 +1,174 @@
+#include "autoconf/private/common/trace.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace trace = rules_cc_autoconf::trace;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+/** Routes events to in-memory text streams for the duration of a test. */
+struct Capture {
+    std::ostringstream out{};
+    std::ostringstream info{};
+
+    explicit Capture(trace::Level level) {
+        trace::set_level(level);
+        std::vector<std::unique_ptr<trace::Sink>> sinks;
+        sinks.push_back(trace::make_text_sink(out, info));
+        trace::set_sinks(std::move(sinks));
+    }
+
+    ~Capture() { trace::set_sinks({}); }
+};
+
+static int evaluations = 0;
+
+static std::string counted(const std::string& value) {
+    ++evaluations;
+    return value;
+}
+
+static bool test_disabled_fields_are_not_evaluated() {
+    Capture capture(trace::Level::kWarn);
+    evaluations = 0;
+    AUTOCONF_TRACE_DEBUG("hidden", {"value", counted("x")});
+    AUTOCONF_TRACE_WARN("shown", {"value", counted("y")});
+    return evaluations == 1 && capture.out.str() == "Warning: shown value=y\n";
+}
+
+static bool test_text_fields() {
+    Capture capture(trace::Level::kDebug);
+    std::vector<std::string> argv = {"cc", "-c", "a.c"};
+    std::filesystem::path path = "/tmp/a b";
+    AUTOCONF_TRACE_DEBUG("Executing", {"argv", argv}, {"path", path},
+                         {"count", size_t{3}}, {"ok", true}, {"ratio", 0.5},
+                         {"delta", -2});
+    AUTOCONF_TRACE_INFO("checking foo... yes");
+    return capture.out.str() ==
+               "Debug: Executing argv=[\"cc\",\"-c\",\"a.c\"] "
+               "path=\"/tmp/a b\" count=3 ok=true ratio=0.5 delta=-2\n" &&
+           capture.info.str() == "checking foo... yes\n";
+}
+
+static bool test_json_lines() {
+    std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "trace_test.jsonl";
+    std::filesystem::remove(path);
+    trace::set_level(trace::Level::kDebug);
+    std::vector<std::unique_ptr<trace::Sink>> sinks;
+    sinks.push_back(trace::make_json_lines_sink(path));
+    trace::set_sinks(std::move(sinks));
+    AUTOCONF_TRACE_WARN("quote\"d", {"name", "a\nb"});
+    {
+        trace::Span span(trace::Level::kDebug, "span");
+    }
+    trace::set_sinks({});
+
+    std::ifstream in(path);
+    std::string first;
+    std::string second;
+    std::getline(in, first);
+    std::getline(in, second);
+    std::filesystem::remove(path);
+    return first.find("\"level\":\"warn\",\"message\":\"quote\\\"d\","
+                      "\"fields\":{\"name\":\"a\\nb\"}}") !=
+               std::string::npos &&
+           second.find("\"message\":\"span\",\"dur_us\":") !=
+               std::string::npos;
+}
+
+static int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+static bool test_timestamps_share_an_epoch() {
+    std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "trace_test_epoch.jsonl";
+    std::filesystem::remove(path);
+    trace::set_level(trace::Level::kDebug);
+    std::vector<std::unique_ptr<trace::Sink>> sinks;
+    sinks.push_back(trace::make_json_lines_sink(path));
+    trace::set_sinks(std::move(sinks));
+    int64_t before = now_us();
+    AUTOCONF_TRACE_DEBUG("stamped");
+    int64_t after = now_us();
+    trace::set_sinks({});
+
+    // Every process stamps events on the same clock, not from its own start.
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    std::filesystem::remove(path);
+    const std::string prefix = "{\"ts_us\":";
+    if (line.rfind(prefix, 0) != 0) {
+        return false;
+    }
+    int64_t ts = std::stoll(line.substr(prefix.size()));
+    return ts >= before && ts <= after;
+}
+
+static bool test_trace_events() {
+    std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "trace_test.json";
+    trace::set_level(trace::Level::kDebug);
+    std::vector<std::unique_ptr<trace::Sink>> sinks;
+    sinks.push_back(trace::make_trace_event_sink(path));
+    trace::set_sinks(std::move(sinks));
+    AUTOCONF_TRACE_DEBUG("point", {"n", 1});
+    {
+        trace::Span span(trace::Level::kDebug, "slice");
+    }
+    trace::set_sinks({});
+
+    // Written per process, so concurrent processes do not clobber it.
+    std::filesystem::path written = trace::per_process_path(path);
+    std::ifstream in(written);
+    std::stringstream content;
+    content << in.rdbuf();
+    std::filesystem::remove(written);
+    std::string text = content.str();
+    return !std::filesystem::exists(path) &&
+           written.extension() == ".json" && written != path &&
+           text.rfind("[\n", 0) == 0 &&
+           text.find("\"name\":\"point\"") != std::string::npos &&
+           text.find("\"ph\":\"i\"") != std::string::npos &&
+           text.find("\"args\":{\"n\":1}") != std::string::npos &&
+           text.find("\"name\":\"slice\"") != std::string::npos &&
+           text.find("\"ph\":\"X\"") != std::string::npos &&
+           text.find("\n]\n") != std::string::npos;
+}
+
+int main() {
+    std::cout << "trace_test:" << std::endl;
+    TEST(disabled_fields_are_not_evaluated)
+    TEST(text_fields)
+    TEST(json_lines)
+    TEST(timestamps_share_an_epoch)
+    TEST(trace_events)
+
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
@@ -68,3 +68,113 @@ def extract_condition_vars(expr):
             result.append(name)
 
     return result
+
+def static_define_value(check):
+    """Get the value an AC_DEFINE check always produces, as conditions read it.
+
+    Such a check never probes, so its result is known at analysis time: it
+    succeeds with `define_value` encoded as JSON (`1` reads as `1`, `"1"` as
+    `"1"` with quotes), or an empty value for `None` and `""`.
+
+    Args:
+        check: The check dict.
+
+    Returns:
+        The value, or None when the result depends on other results or the
+        value cannot be encoded exactly as the checker does.
+    """
+    if check.get("type") != "define" or check.get("requires") or check.get("condition"):
+        return None
+    value = check.get("define_value")
+    if value == None or value == "":
+        return ""
+    if type(value) == "string":
+        for special in ["\"", "\\", "\n", "\r", "\t"]:
+            if special in value:
+                return None
+    elif type(value) not in ["int", "bool"]:
+        return None
+    return json.encode(value)
+
+def _leading_int(value):
+    """Parse `value` like the checker's `std::stoi`, giving 0 on failure."""
+    value = value.lstrip()
+    sign = 1
+    if value.startswith("-") or value.startswith("+"):
+        sign = -1 if value.startswith("-") else 1
+        value = value[1:]
+    digits = ""
+    for c in value.elems():
+        if not c.isdigit():
+            break
+        digits += c
+    if not digits:
+        return 0
+    number = sign * int(digits)
+    if number > 2147483647 or number < -2147483648:
+        return 0
+    return number
+
+def evaluate_static_condition(expr, values):
+    """Evaluate a condition at analysis time, as the checker would.
+
+    Only a single test is handled: a variable, optionally negated, or one
+    comparison (e.g. ``"!HAVE_X"``, ``"REPLACE_X==1"``).
+
+    Args:
+        expr: A condition expression string.
+        values: Lookup name to value for results known at analysis time,
+            all of which succeeded (see `static_define_value`).
+
+    Returns:
+        True or False, or None when `expr` combines several tests or reads a
+        result that is not in `values`.
+    """
+    s = expr.strip()
+    for op in ["||", "&&", "(", ")"]:
+        if op in s:
+            return None
+
+    negations = 0
+    for _ in range(len(s)):
+        if not s.startswith("!"):
+            break
+        negations += 1
+        s = s[1:].strip()
+
+    name = s
+    op = None
+    rhs = None
+    for candidate in _COMPARISON_OPS:
+        idx = s.find(candidate)
+        if idx >= 0:
+            name = s[:idx].strip()
+            op = candidate
+            rhs = s[idx + len(candidate):].strip()
+            break
+
+    if name not in values or (rhs != None and (not rhs or " " in rhs)):
+        return None
+    actual = values[name]
+
+    if op == None:
+        result = actual != "" and actual != "0"
+    elif op in ["==", "="]:
+        result = actual == rhs
+    elif op == "!=":
+        result = actual != rhs
+    else:
+        a = _leading_int(actual)
+        b = _leading_int(rhs)
+        if op == "<":
+            result = a < b
+        elif op == ">":
+            result = a > b
+        elif op == "<=":
+            result = a <= b
+        else:
+            result = a >= b
+
+    if negations % 2:
+        return not result
+    return result
@@ -12,19 +12,31 @@
  *                --output flags.txt \
  *                [--pragma-output pragma_libs.c]
  *
- * Output format: one flag per line (linker response file format).
+ * Output format: one flag per line (linker response file format); flags
+ * that only work together (`-Wl,-rpath -Wl,/dir`, `-Wl,-Bstatic ...
+ * -Wl,-Bdynamic`) share a line.
+ *
+ * The standalone libraries (`-l<name>`, library paths) of all vars, given in
+ * link order, are deduplicated keeping each one's last occurrence, so a
+ * library needed by several earlier flags still follows all of them. All
+ * other flags are kept as they are, in order.
  *
  * When --pragma-output is given, a .c file is also written containing
  * #pragma comment(lib, ...) directives for MSVC/clang-cl, which embed
  * library references directly in the object file.
  */
 
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include "autoconf/private/common/file_util.h"
+#include "autoconf/private/common/trace.h"
 #include "tools/json/json.h"
 
 namespace rules_cc_autoconf {
@@ -135,6 +147,142 @@ std::string extract_flag_value(const std::string& file_path,
     return "";
 }
 
+/**
+ * @brief A flag, or flags that only work together, in link order.
+ */
+struct LinkUnit {
+    std::string text;         ///< The words, space separated
+    bool dedupable = false;   ///< A standalone library (see is_library())
+};
+
+/**
+ * @brief Whether a word names a library on its own: `-l<name>` or a path to
+ * a static or shared library.
+ */
+bool is_library(const std::string& word) {
+    if (word.size() > 2 && word.compare(0, 2, "-l") == 0) {
+        return true;
+    }
+    if (word.empty() || word[0] == '-') {
+        return false;
+    }
+    std::string name = std::filesystem::path(word).filename().string();
+    return name.size() > 2 &&
+           (name.rfind(".a") == name.size() - 2 ||
+            name.find(".so") != std::string::npos ||
+            name.find(".dylib") != std::string::npos ||
+            (name.size() > 4 && name.rfind(".lib") == name.size() - 4));
+}
+
+/**
+ * @brief The linker option a unit passes through the driver (`-Wl,-rpath`
+ * and `-Xlinker -rpath` both give `-rpath`), or empty.
+ */
+std::string linker_option(const std::vector<std::string>& words) {
+    if (words.size() == 1 && words[0].rfind("-Wl,", 0) == 0) {
+        return words[0].substr(4);
+    }
+    if (words.size() == 2 && words[0] == "-Xlinker") {
+        return words[1];
+    }
+    return "";
+}
+
+/**
+ * @brief Split a subst value into link units.
+ *
+ * Words stay together when they only work as an ordered pair or region:
+ * - driver options taking the next word (`-framework Foo`, `-Xlinker X`);
+ * - linker options taking the next linker argument
+ *   (`-Wl,-rpath -Wl,/dir`, `-Xlinker -rpath -Xlinker /dir`);
+ * - mode regions such as `-Wl,-Bstatic ... -Wl,-Bdynamic` or
+ *   `-Wl,--as-needed ... -Wl,--no-as-needed`, up to the closing option or
+ *   the end of the value.
+ * Only standalone libraries outside any region can be deduplicated.
+ */
+std::vector<LinkUnit> split_link_flags(const std::string& value) {
+    static const std::set<std::string> kDriverPaired = {
+        "-framework", "-weak_framework", "-Xlinker", "-L", "-u",
+    };
+    static const std::set<std::string> kLinkerPaired = {
+        "-framework", "-weak_framework", "-rpath", "-rpath-link",
+        "-z",         "-undefined",
+    };
+    static const std::map<std::string, std::string> kRegions = {
+        {"-Bstatic", "-Bdynamic"},
+        {"-Bdynamic", "-Bstatic"},
+        {"--as-needed", "--no-as-needed"},
+        {"--no-as-needed", "--as-needed"},
+        {"--whole-archive", "--no-whole-archive"},
+        {"--start-group", "--end-group"},
+        {"-(", "-)"},
+    };
+
+    std::vector<std::string> words;
+    std::istringstream stream(value);
+    for (std::string word; stream >> word;) {
+        words.push_back(word);
+    }
+
+    // Words of one flag, pairing driver options with their argument.
+    size_t i = 0;
+    auto next_flag = [&]() {
+        std::vector<std::string> flag = {words[i++]};
+        if (kDriverPaired.count(flag[0]) != 0 && i < words.size()) {
+            flag.push_back(words[i++]);
+        }
+        return flag;
+    };
+
+    std::vector<LinkUnit> units;
+    std::string closing;  // Linker option ending the open region, if any
+    while (i < words.size()) {
+        std::vector<std::string> flag = next_flag();
+        std::string option = linker_option(flag);
+        // The linker argument travels the same way as its option.
+        if (kLinkerPaired.count(option) != 0 && i < words.size() &&
+            (flag[0] == "-Xlinker" || words[i].rfind("-Wl,", 0) == 0)) {
+            std::vector<std::string> argument = next_flag();
+            flag.insert(flag.end(), argument.begin(), argument.end());
+        }
+
+        std::string text;
+        for (const std::string& word : flag) {
+            text += (text.empty() ? "" : " ") + word;
+        }
+        if (!closing.empty()) {
+            units.back().text += " " + text;
+            if (option == closing) {
+                closing.clear();
+            }
+            continue;
+        }
+        std::map<std::string, std::string>::const_iterator region =
+            kRegions.find(option);
+        if (region != kRegions.end()) {
+            closing = region->second;
+        }
+        units.push_back({text, flag.size() == 1 && closing.empty() &&
+                                   is_library(flag[0])});
+    }
+    return units;
+}
+
+/**
+ * @brief Drop repeated libraries, keeping the last occurrence of each.
+ * Other units keep every occurrence, in order.
+ */
+std::vector<std::string> dedupe_keep_last(const std::vector<LinkUnit>& units) {
+    std::set<std::string> seen;
+    std::vector<std::string> reversed;
+    for (auto it = units.rbegin(); it != units.rend(); ++it) {
+        if (!it->dedupable || seen.insert(it->text).second) {
+            reversed.push_back(it->text);
+        }
+    }
+    return std::vector<std::string>(reversed.rbegin(), reversed.rend());
+}
+
 bool write_pragma_file(const std::string& path,
                        const std::vector<std::string>& flags) {
     auto ofs = open_ofstream(path);
@@ -165,22 +313,17 @@ int run(int argc, char* argv[]) {
         return 1;
     }
 
-    std::vector<std::string> flags;
+    std::vector<LinkUnit> units;
     for (const auto& var : vars) {
-        std::string flag = extract_flag_value(var.file_path, var.name);
-        if (!flag.empty()) {
-            bool found = false;
-            for (const auto& existing : flags) {
-                if (existing == flag) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                flags.push_back(flag);
-            }
+        for (LinkUnit& unit : split_link_flags(
+                 extract_flag_value(var.file_path, var.name))) {
+            units.push_back(std::move(unit));
         }
     }
+    std::vector<std::string> flags = dedupe_keep_last(units);
+    AUTOCONF_TRACE_DEBUG("Link flags", {"vars", vars.size()},
+                         {"flags", flags},
+                         {"duplicates", units.size() - flags.size()});
 
     auto ofs = open_ofstream(output_path);
     if (!ofs.is_open()) {
@@ -2,11 +2,11 @@
  * @brief Parses MODULE.bazel to extract package name and version information.
  */
 
+#include <cctype>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <optional>
-#include <regex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -15,30 +15,262 @@
 #include "tools/json/json.h"
 
 /**
- * @brief Extract a string value from a Starlark function call parameter.
+ * @brief Kinds of token produced by StarlarkLexer.
+ */
+enum class TokenKind {
+    kIdentifier,  ///< Name or keyword
+    kString,      ///< String literal; text is the decoded value
+    kPunct,       ///< Operator or bracket
+    kOther,       ///< Number or any other character run
+    kEnd,         ///< End of input, or an unterminated string
+};
+
+/**
+ * @brief A token of the Starlark subset used by MODULE.bazel.
+ */
+struct Token {
+    TokenKind kind = TokenKind::kEnd;  ///< Token kind
+    std::string text{};                ///< Token text (decoded for strings)
+};
+
+/**
+ * @brief Single-pass lexer for the Starlark subset used by MODULE.bazel.
+ *
+ * Skips whitespace and `#` comments and understands single, double and
+ * triple-quoted strings (with `r`/`b` prefixes and backslash escapes), so
+ * brackets, quotes and `#` inside strings never confuse the caller.
+ */
+class StarlarkLexer {
+   public:
+    /**
+     * @brief Construct a lexer over `content`, which must outlive it.
+     */
+    explicit StarlarkLexer(const std::string& content) : content_(content) {}
+
+    /**
+     * @brief Return the next token, or a kEnd token at the end of input.
+     */
+    Token next() {
+        skip_space_and_comments();
+        if (pos_ >= content_.size()) {
+            return {};
+        }
+
+        char c = content_[pos_];
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = pos_;
+            while (pos_ < content_.size() &&
+                   (std::isalnum(static_cast<unsigned char>(content_[pos_])) ||
+                    content_[pos_] == '_')) {
+                ++pos_;
+            }
+            std::string word = content_.substr(start, pos_ - start);
+            if (pos_ < content_.size() &&
+                (content_[pos_] == '"' || content_[pos_] == '\'') &&
+                is_string_prefix(word)) {
+                bool raw = word.find_first_of("rR") != std::string::npos;
+                return lex_string(raw);
+            }
+            return {TokenKind::kIdentifier, std::move(word)};
+        }
+        if (c == '"' || c == '\'') {
+            return lex_string(false);
+        }
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            size_t start = pos_;
+            while (pos_ < content_.size() &&
+                   (std::isalnum(static_cast<unsigned char>(content_[pos_])) ||
+                    content_[pos_] == '.')) {
+                ++pos_;
+            }
+            return {TokenKind::kOther, content_.substr(start, pos_ - start)};
+        }
+
+        // `==`, `<=`, `>=` and `!=` must not look like a keyword `=`.
+        if (pos_ + 1 < content_.size() && content_[pos_ + 1] == '=' &&
+            (c == '=' || c == '<' || c == '>' || c == '!')) {
+            pos_ += 2;
+            return {TokenKind::kPunct, std::string(1, c) + "="};
+        }
+        ++pos_;
+        return {TokenKind::kPunct, std::string(1, c)};
+    }
+
+   private:
+    /** Whether `word` is a string literal prefix (`r`, `b`, `rb`, `br`). */
+    static bool is_string_prefix(const std::string& word) {
+        if (word.empty() || word.size() > 2) {
+            return false;
+        }
+        for (char c : word) {
+            if (c != 'r' && c != 'R' && c != 'b' && c != 'B') {
+                return false;
+            }
+        }
+        return word.size() == 1 ||
+               std::tolower(word[0]) != std::tolower(word[1]);
+    }
+
+    /** Advance past whitespace, line continuations and comments. */
+    void skip_space_and_comments() {
+        while (pos_ < content_.size()) {
+            char c = content_[pos_];
+            if (c == '#') {
+                size_t eol = content_.find('\n', pos_);
+                pos_ = eol == std::string::npos ? content_.size() : eol;
+            } else if (std::isspace(static_cast<unsigned char>(c)) ||
+                       (c == '\\' && pos_ + 1 < content_.size() &&
+                        content_[pos_ + 1] == '\n')) {
+                ++pos_;
+            } else {
+                break;
+            }
+        }
+    }
+
+    /** Lex a string literal starting at its opening quote. */
+    Token lex_string(bool raw) {
+        char quote = content_[pos_];
+        bool triple = content_.compare(pos_, 3, std::string(3, quote)) == 0;
+        pos_ += triple ? 3 : 1;
+
+        Token token{TokenKind::kString, {}};
+        while (pos_ < content_.size()) {
+            char c = content_[pos_];
+            if (c == quote &&
+                (!triple ||
+                 content_.compare(pos_, 3, std::string(3, quote)) == 0)) {
+                pos_ += triple ? 3 : 1;
+                return token;
+            }
+            if (c == '\n' && !triple) {
+                break;
+            }
+            if (c == '\\' && pos_ + 1 < content_.size()) {
+                char escaped = content_[pos_ + 1];
+                pos_ += 2;
+                if (raw) {
+                    token.text += c;
+                    token.text += escaped;
+                    continue;
+                }
+                switch (escaped) {
+                    case '\n':
+                        break;
+                    case 'n':
+                        token.text += '\n';
+                        break;
+                    case 't':
+                        token.text += '\t';
+                        break;
+                    case 'r':
+                        token.text += '\r';
+                        break;
+                    case '\\':
+                    case '"':
+                    case '\'':
+                        token.text += escaped;
+                        break;
+                    default:
+                        token.text += c;
+                        token.text += escaped;
+                        break;
+                }
+                continue;
+            }
+            token.text += c;
+            ++pos_;
+        }
+
+        // Unterminated string: nothing after it can be trusted.
+        pos_ = content_.size();
+        return {};
+    }
+
+    const std::string& content_;  ///< Text being lexed
+    size_t pos_ = 0;              ///< Offset of the next unread character
+};
+
+/**
+ * @brief Whether `token` is the punctuation `text`.
+ */
+bool is_punct(const Token& token, const char* text) {
+    return token.kind == TokenKind::kPunct && token.text == text;
+}
+
+/**
+ * @brief Extract the string keyword arguments of the top-level module() call.
  *
- * Parses patterns like `name = "value"` or `name="value"` and returns the
- * string value.
+ * Scans the file once. The arguments of the first top-level `module(...)`
+ * call are collected up to its matching `)` and every `key = "string"`
+ * argument is returned; arguments with non-string values, and calls nested
+ * inside them, are skipped.
  *
- * @param content The file content to search in.
- * @param param_name The parameter name to extract (e.g., "name" or "version").
- * @return The extracted string value, or empty string if not found.
+ * @param content The MODULE.bazel file content.
+ * @return Keyword to value, or std::nullopt if no complete module() call
+ * was found.
  */
-std::string extract_string_param(const std::string& content,
-                                 const std::string& param_name) {
-    // Pattern to match: param_name = "value" or param_name="value"
-    // Handles whitespace variations
-    std::string pattern_str = param_name + "\\s*=\\s*\"([^\"]+)\"";
-    std::regex pattern(pattern_str);
-    std::smatch match;
-
-    if (std::regex_search(content, match, pattern)) {
-        if (match.size() >= 2) {
-            return match[1].str();
+std::optional<std::map<std::string, std::string>> parse_module_kwargs(
+    const std::string& content) {
+    StarlarkLexer lexer(content);
+
+    // Find `module(` outside any brackets and not as `x.module(`.
+    int depth = 0;
+    Token before_prev{};
+    Token prev{};
+    for (Token tok = lexer.next();; tok = lexer.next()) {
+        if (tok.kind == TokenKind::kEnd) {
+            return std::nullopt;
+        }
+        if (depth == 0 && is_punct(tok, "(") &&
+            prev.kind == TokenKind::kIdentifier && prev.text == "module" &&
+            !is_punct(before_prev, ".")) {
+            break;
+        }
+        if (is_punct(tok, "(") || is_punct(tok, "[") || is_punct(tok, "{")) {
+            ++depth;
+        } else if (is_punct(tok, ")") || is_punct(tok, "]") ||
+                   is_punct(tok, "}")) {
+            --depth;
+        }
+        before_prev = std::move(prev);
+        prev = std::move(tok);
+    }
+
+    // Collect the call's top-level argument tokens up to its closing `)`.
+    std::vector<Token> args;
+    depth = 1;
+    for (Token tok = lexer.next();; tok = lexer.next()) {
+        if (tok.kind == TokenKind::kEnd) {
+            return std::nullopt;
+        }
+        if (is_punct(tok, "(") || is_punct(tok, "[") || is_punct(tok, "{")) {
+            ++depth;
+        } else if (is_punct(tok, ")") || is_punct(tok, "]") ||
+                   is_punct(tok, "}")) {
+            if (--depth == 0) {
+                break;
+            }
+            continue;
+        }
+        if (depth == 1) {
+            args.push_back(std::move(tok));
+        } else if (!args.empty() && args.back().kind != TokenKind::kOther) {
+            // Mark nested content so `k = f("v")` is not read as a string.
+            args.push_back({TokenKind::kOther, {}});
         }
     }
 
-    return "";
+    std::map<std::string, std::string> kwargs;
+    for (size_t i = 0; i + 2 < args.size(); ++i) {
+        if (args[i].kind == TokenKind::kIdentifier &&
+            is_punct(args[i + 1], "=") &&
+            args[i + 2].kind == TokenKind::kString &&
+            (i + 3 == args.size() || is_punct(args[i + 3], ","))) {
+            kwargs.emplace(args[i].text, args[i + 2].text);
+        }
+    }
+    return kwargs;
 }
 
 /**
@@ -51,44 +283,20 @@ std::string extract_string_param(const std::string& content,
  */
 bool parse_module(const std::string& content, std::string& name,
                   std::string& version) {
-    // Find the module( ... ) block
-    std::regex module_pattern(R"(module\s*\()");
-    std::smatch module_match;
-
-    if (!std::regex_search(content, module_match, module_pattern)) {
+    std::optional<std::map<std::string, std::string>> kwargs =
+        parse_module_kwargs(content);
+    if (!kwargs.has_value()) {
         return false;
     }
 
-    // Find the closing parenthesis for the module() call
-    // We'll search from the opening parenthesis
-    size_t start_pos = module_match.position() + module_match.length();
-    int paren_count = 1;
-    size_t end_pos = start_pos;
-
-    for (size_t i = start_pos; i < content.length() && paren_count > 0; ++i) {
-        if (content[i] == '(') {
-            paren_count++;
-        } else if (content[i] == ')') {
-            paren_count--;
-            if (paren_count == 0) {
-                end_pos = i;
-                break;
-            }
-        }
+    auto name_it = kwargs->find("name");
+    auto version_it = kwargs->find("version");
+    if (name_it != kwargs->end()) {
+        name = name_it->second;
     }
-
-    if (paren_count != 0) {
-        // Didn't find matching closing parenthesis
-        return false;
+    if (version_it != kwargs->end()) {
+        version = version_it->second;
     }
-
-    // Extract the content between module( and )
-    std::string module_content = content.substr(start_pos, end_pos - start_pos);
-
-    // Extract name and version
-    name = extract_string_param(module_content, "name");
-    version = extract_string_param(module_content, "version");
-
     return !name.empty() && !version.empty();
 }
 
@@ -353,8 +561,17 @@ bool write_package_json(const std::string& path, const std::string& value) {
  * @return The version with any `.bcr.N` suffix removed.
  */
 std::string strip_bcr_suffix(const std::string& version) {
-    std::regex bcr_pattern(R"(\.bcr\.\d+$)");
-    return std::regex_replace(version, bcr_pattern, "");
+    static const std::string kBcr = ".bcr.";
+    size_t pos = version.rfind(kBcr);
+    if (pos == std::string::npos || pos + kBcr.size() == version.size()) {
+        return version;
+    }
+    for (size_t i = pos + kBcr.size(); i < version.size(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(version[i]))) {
+            return version;
+        }
+    }
+    return version.substr(0, pos);
 }
 
 int main(int argc, char* argv[]) {
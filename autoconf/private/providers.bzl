@@ -32,3 +32,10 @@ CcAutoconfInfo, _new_cc_autoconf_info = provider(
     },
     init = _cc_autoconf_info_init,
 )
+
+AutoconfLinkoptsInfo = provider(
+    doc = "Link-flag result files collected by `autoconf_linkopts` targets.",
+    fields = {
+        "results": "depset[struct]: `struct(name, result)` pairs of variable names and flat result JSON files, in link order (a target's own variables precede those of the `autoconf_linkopts` targets it merges).",
+    },
+)
@@ -0,0 +1,80 @@
+#include "autoconf/private/resolver/conditional_wrap.h"
+
+#include <fstream>
+#include <stdexcept>
+
+#include "autoconf/private/common/file_util.h"
+#include "tools/json/json.h"
+
+namespace rules_cc_autoconf {
+
+WrapResult load_wrap_result(const std::filesystem::path& path) {
+    std::ifstream file = open_ifstream(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open result file: " +
+                                 path.string());
+    }
+
+    nlohmann::json j;
+    file >> j;
+
+    if (j.is_null() || !j.is_object() || j.empty()) {
+        return {};
+    }
+
+    WrapResult result;
+    auto vi = j.find("value");
+    if (vi != j.end() && !vi->is_null()) {
+        result.value = vi->is_string() ? vi->get<std::string>() : vi->dump();
+    }
+    auto si = j.find("success");
+    result.success = (si != j.end()) ? si->get<bool>() : false;
+    return result;
+}
+
+bool is_truthy(const WrapResult& result) {
+    return result.success && !result.value.empty() && result.value != "0" &&
+           result.value != "false";
+}
+
+std::string apply_conditional_wrap(const std::string& content,
+                                   const WrapResult& condition,
+                                   const WrapResult& include_next,
+                                   const WrapResult& next_header,
+                                   const std::string& output_path) {
+    if (is_truthy(condition)) {
+        return content;
+    }
+
+    // Resolve the next header value for the passthrough.  When the
+    // upstream condition on GL_NEXT_HEADERS prevented resolution the
+    // value will be empty; fall back to the output basename wrapped in
+    // angle brackets (e.g. "lib/assert.h" → "<assert.h>").
+    std::string next_hdr = next_header.value;
+    if (next_hdr.empty()) {
+        auto slash = output_path.rfind('/');
+        std::string basename = (slash != std::string::npos)
+                                   ? output_path.substr(slash + 1)
+                                   : output_path;
+        next_hdr = "<" + basename + ">";
+    }
+
+    // Construct the passthrough directive: #<include_next> <next_header>
+    // GCC/Clang: #include_next <assert.h>
+    // MSVC: # \n<inlined system header>
+    std::string passthrough = "#" + include_next.value + " " + next_hdr;
+
+    std::string out;
+    out.reserve(content.size() + passthrough.size() + 32);
+    out += "#if 1\n";
+    out += passthrough + "\n";
+    out += "#else\n";
+    out += content;
+    if (!content.empty() && content.back() != '\n') {
+        out += "\n";
+    }
+    out += "#endif\n";
+    return out;
+}
+
+}  // namespace rules_cc_autoconf
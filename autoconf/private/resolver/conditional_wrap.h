@@ -0,0 +1,60 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace rules_cc_autoconf {
+
+/**
+ * @brief A check result as consumed by conditional header wrapping.
+ */
+struct WrapResult {
+    std::string value{};   ///< String value, or the JSON dump of non-strings
+    bool success = false;  ///< Whether the check succeeded
+};
+
+/**
+ * @brief Load a flat result file for conditional wrapping.
+ * @param path Path to the result JSON file.
+ * @return The result; empty or null files yield a failed, empty result.
+ * @throws std::runtime_error if the file cannot be opened.
+ */
+WrapResult load_wrap_result(const std::filesystem::path& path);
+
+/**
+ * @brief Whether a result enables the wrapped header.
+ *
+ * Matches the autoconf_srcs truthiness pattern: a result is truthy when the
+ * check succeeded AND the value is non-empty AND the value is neither "0"
+ * nor "false".
+ */
+bool is_truthy(const WrapResult& result);
+
+/**
+ * @brief Apply gnulib's gl_CONDITIONAL_HEADER wrapping to a rendered header.
+ *
+ * When `condition` is truthy the content is returned unchanged. Otherwise it
+ * becomes dead code behind a passthrough to the system header:
+ *
+ *   #if 1
+ *   #include_next <header.h>
+ *   #else
+ *   <content>
+ *   #endif
+ *
+ * @param content The rendered header.
+ * @param condition Result deciding whether the header is needed.
+ * @param include_next Result holding the include directive
+ * (e.g. "include_next").
+ * @param next_header Result holding the system header (e.g. "<assert.h>").
+ * When empty, the basename of `output_path` in angle brackets is used.
+ * @param output_path Path of the generated header.
+ * @return The wrapped content.
+ */
+std::string apply_conditional_wrap(const std::string& content,
+                                   const WrapResult& condition,
+                                   const WrapResult& include_next,
+                                   const WrapResult& next_header,
+                                   const std::string& output_path);
+
+}  // namespace rules_cc_autoconf
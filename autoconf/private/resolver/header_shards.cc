@@ -0,0 +1,175 @@
+#include "autoconf/private/resolver/header_shards.h"
+
+#include <cctype>
+#include <vector>
+
+namespace rules_cc_autoconf {
+
+namespace {
+
+/**
+ * @brief Strip leading and trailing whitespace (including the newline).
+ */
+std::string trim(const std::string& line) {
+    size_t begin = 0;
+    size_t end = line.size();
+    while (begin < end &&
+           std::isspace(static_cast<unsigned char>(line[begin]))) {
+        ++begin;
+    }
+    while (end > begin &&
+           std::isspace(static_cast<unsigned char>(line[end - 1]))) {
+        --end;
+    }
+    return line.substr(begin, end - begin);
+}
+
+/**
+ * @brief Consume `word` at `pos` (after optional whitespace).
+ * @return true and advance `pos` past it on a match.
+ */
+bool consume(const std::string& text, size_t& pos, const std::string& word) {
+    size_t i = pos;
+    while (i < text.size() && (text[i] == ' ' || text[i] == '\t')) ++i;
+    if (text.compare(i, word.size(), word) != 0) return false;
+    pos = i + word.size();
+    return true;
+}
+
+/**
+ * @brief Read an identifier at `pos` (after at least one blank).
+ */
+std::string identifier(const std::string& text, size_t pos) {
+    size_t i = pos;
+    while (i < text.size() && (text[i] == ' ' || text[i] == '\t')) ++i;
+    if (i == pos) return {};
+    size_t begin = i;
+    while (i < text.size() &&
+           (std::isalnum(static_cast<unsigned char>(text[i])) ||
+            text[i] == '_')) {
+        ++i;
+    }
+    return text.substr(begin, i - begin);
+}
+
+/**
+ * @brief Name of the define rendered by a trimmed line, if it is one.
+ *
+ * Matches `#define NAME ...` and the commented-out `#undef NAME` that
+ * SourceGenerator renders for unset defines.
+ */
+std::string rendered_define_name(const std::string& line) {
+    size_t pos = 0;
+    if (consume(line, pos, "#") && consume(line, pos, "define")) {
+        return identifier(line, pos);
+    }
+    pos = 0;
+    if (consume(line, pos, "/*") && consume(line, pos, "#") &&
+        consume(line, pos, "undef") && line.size() >= 2 &&
+        line.compare(line.size() - 2, 2, "*/") == 0 &&
+        line.find("*/") == line.size() - 2) {
+        return identifier(line, pos);
+    }
+    return {};
+}
+
+/**
+ * @brief Conditional nesting change of a trimmed preprocessor line.
+ */
+int conditional_delta(const std::string& line) {
+    size_t pos = 0;
+    if (!consume(line, pos, "#")) return 0;
+    size_t after = pos;
+    if (consume(line, after, "endif")) return -1;
+    if (consume(line, pos, "if")) return 1;  // #if, #ifdef, #ifndef
+    return 0;
+}
+
+}  // namespace
+
+ShardedHeader shard_config_header(
+    const std::string& content,
+    const std::map<std::string, std::string>& define_owners,
+    const std::map<std::string, std::string>& includes) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (start < content.size()) {
+        size_t end = content.find('\n', start);
+        end = end == std::string::npos ? content.size() : end + 1;
+        lines.push_back(content.substr(start, end - start));
+        start = end;
+    }
+
+    ShardedHeader result;
+    std::string pending_comment;  // Comment lines not yet placed
+    bool in_comment = false;
+    // Whether a define moved since the last kept line, and whether a blank
+    // line was dropped since.
+    bool moved = false;
+    bool dropped_blank = false;
+    int depth = 0;
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        std::string text = trim(lines[i]);
+
+        if (in_comment) {
+            pending_comment += lines[i];
+            in_comment = text.find("*/") == std::string::npos;
+            continue;
+        }
+
+        std::string name = depth == 0 ? rendered_define_name(text) : "";
+        std::map<std::string, std::string>::const_iterator owner =
+            name.empty() ? define_owners.end() : define_owners.find(name);
+        if (owner != define_owners.end() && includes.count(owner->second)) {
+            std::string& fragment = result.fragments[owner->second];
+            if (fragment.empty()) {
+                result.umbrella +=
+                    "#include \"" + includes.at(owner->second) + "\"\n";
+            } else if (!pending_comment.empty()) {
+                fragment += "\n";  // Keep commented entries apart
+            }
+            fragment += pending_comment + lines[i];
+            pending_comment.clear();
+            moved = true;
+            // Keep backslash continuations with their define.
+            while (!text.empty() && text.back() == '\\' &&
+                   i + 1 < lines.size()) {
+                fragment += lines[++i];
+                text = trim(lines[i]);
+            }
+            continue;
+        }
+
+        if (name.empty() && (text.rfind("/*", 0) == 0 ||
+                             text.rfind("//", 0) == 0)) {
+            size_t close = text.find("*/");
+            if (text[1] == '/' || close == std::string::npos ||
+                close == text.size() - 2) {
+                pending_comment += lines[i];
+                in_comment = text[1] == '*' && close == std::string::npos;
+                continue;
+            }
+        }
+
+        // Blank lines between moved defines collapse into one.
+        if (moved) {
+            if (text.empty() && pending_comment.empty()) {
+                dropped_blank = true;
+                continue;
+            }
+            if (dropped_blank) result.umbrella += "\n";
+            moved = false;
+            dropped_blank = false;
+        }
+
+        depth += conditional_delta(text);
+        result.umbrella += pending_comment + lines[i];
+        pending_comment.clear();
+    }
+    if (dropped_blank && !pending_comment.empty()) result.umbrella += "\n";
+    result.umbrella += pending_comment;
+    return result;
+}
+
+}  // namespace rules_cc_autoconf
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+namespace rules_cc_autoconf {
+
+/**
+ * @brief A rendered config header split into an umbrella and fragments.
+ */
+struct ShardedHeader {
+    std::string umbrella{};  ///< Umbrella content, including the fragments
+    ///< Fragment content by owner; owners without defines are absent
+    std::map<std::string, std::string> fragments{};
+};
+
+/**
+ * @brief Split a rendered config header by define owner.
+ *
+ * Every top-level `#define NAME ...` line, or commented-out `#undef NAME`
+ * line, whose NAME has an owner moves into that owner's fragment together
+ * with the comment lines directly above it. The umbrella keeps everything
+ * else in order (prologue, conditionals, inlined content, unowned defines)
+ * and includes each fragment where its first define used to be, so
+ * including the umbrella is equivalent to including the unsharded header.
+ *
+ * @param content The rendered header.
+ * @param define_owners Map of define name to owner.
+ * @param includes Map of owner to the include path of its fragment,
+ * relative to the umbrella.
+ * @return The umbrella and fragments.
+ */
+ShardedHeader shard_config_header(
+    const std::string& content,
+    const std::map<std::string, std::string>& define_owners,
+    const std::map<std::string, std::string>& includes);
+
+}  // namespace rules_cc_autoconf
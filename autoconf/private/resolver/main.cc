@@ -37,6 +37,12 @@ struct ResolverArgs {
     /** Direct substitutions: map from placeholder name to value */
     std::map<std::string, std::string> substitutions{};
 
+    /** Optional: define owner -> fragment path for a sharded header */
+    std::map<std::string, std::filesystem::path> shards{};
+
+    /** Optional: gl_CONDITIONAL_HEADER wrapping */
+    std::optional<ConditionalHeader> conditional{};
+
     /** Mode for processing */
     Mode mode = Mode::kDefines;
 
@@ -60,6 +66,15 @@ void print_usage(const char* program_name) {
     std::cout
         << "  --mode <mode>          Processing mode: \"defines\" (default), "
            "\"subst\", or \"all\"\n";
+    std::cout << "  --shard <owner>=<file> Write the defines owned by <owner> "
+                 "to <file> and make --output an umbrella header (can be "
+                 "repeated)\n";
+    std::cout << "  --condition <name>     Wrap the output in an #include_next "
+                 "passthrough unless result <name> is truthy\n";
+    std::cout << "  --include-next <name>  Result holding the include "
+                 "directive (default: INCLUDE_NEXT)\n";
+    std::cout << "  --next-header <name>   Result holding the system header "
+                 "(required with --condition)\n";
     std::cout << "  --help                 Show this help message\n";
 }
 
@@ -75,6 +90,9 @@ std::optional<ResolverArgs> parse_args(int argc, char* argv[]) {
 
     ResolverArgs args;
     args.show_help = false;
+    std::string condition;
+    std::string include_next = "INCLUDE_NEXT";
+    std::string next_header;
 
     for (int i = 1; i < expanded_argc; ++i) {
         std::string arg = expanded_argv_ptr[i];
@@ -150,6 +168,38 @@ std::optional<ResolverArgs> parse_args(int argc, char* argv[]) {
                           << std::endl;
                 return std::nullopt;
             }
+        } else if (arg == "--condition" || arg == "--include-next" ||
+                   arg == "--next-header") {
+            if (i + 1 >= expanded_argc) {
+                std::cerr << "Error: " << arg << " requires a result name"
+                          << std::endl;
+                return std::nullopt;
+            }
+            std::string name = std::string(expanded_argv_ptr[++i]);
+            if (arg == "--condition") {
+                condition = name;
+            } else if (arg == "--include-next") {
+                include_next = name;
+            } else {
+                next_header = name;
+            }
+        } else if (arg == "--shard") {
+            if (i + 1 < expanded_argc) {
+                std::string value = std::string(expanded_argv_ptr[++i]);
+                size_t eq_pos = value.find('=');
+                if (eq_pos == std::string::npos || eq_pos == 0 ||
+                    eq_pos + 1 == value.size()) {
+                    std::cerr << "Error: --shard requires owner=path format, "
+                                 "got: "
+                              << value << std::endl;
+                    return std::nullopt;
+                }
+                args.shards[value.substr(0, eq_pos)] = value.substr(eq_pos + 1);
+            } else {
+                std::cerr << "Error: --shard requires an owner=path pair"
+                          << std::endl;
+                return std::nullopt;
+            }
         } else {
             std::cerr << "Error: Unknown argument: " << arg << std::endl;
             return std::nullopt;
@@ -171,6 +221,16 @@ std::optional<ResolverArgs> parse_args(int argc, char* argv[]) {
         return std::nullopt;
     }
 
+    if (!condition.empty()) {
+        if (next_header.empty()) {
+            std::cerr << "Error: --next-header is required with --condition"
+                      << std::endl;
+            return std::nullopt;
+        }
+        args.conditional = ConditionalHeader{condition, include_next,
+                                             next_header};
+    }
+
     return args;
 }
 }  // namespace
@@ -191,5 +251,5 @@ int main(int argc, char* argv[]) {
 
     return Resolver::resolve_and_generate(
         args.manifest_path, args.template_path, args.output_path, args.inlines,
-        args.substitutions, args.mode);
+        args.substitutions, args.mode, args.shards, args.conditional);
 }
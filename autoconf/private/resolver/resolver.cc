@@ -8,8 +8,10 @@
 
 #include "autoconf/private/checker/check.h"
 #include "autoconf/private/checker/check_result.h"
-#include "autoconf/private/checker/debug_logger.h"
 #include "autoconf/private/common/file_util.h"
+#include "autoconf/private/common/trace.h"
+#include "autoconf/private/resolver/conditional_wrap.h"
+#include "autoconf/private/resolver/header_shards.h"
 #include "autoconf/private/resolver/source_generator.h"
 #include "tools/json/json.h"
 
@@ -105,6 +107,51 @@ std::vector<CheckResult> load_manifest_section(const nlohmann::json& section,
     return results;
 }
 
+/**
+ * @brief Collect the owners named by a manifest section.
+ * @param section The manifest section JSON object.
+ * @return Map of name to owner for entries with an "owner" field.
+ */
+std::map<std::string, std::string> load_manifest_owners(
+    const nlohmann::json& section) {
+    std::map<std::string, std::string> owners;
+    for (auto it = section.begin(); it != section.end(); ++it) {
+        if (it.value().is_object() && it.value().contains("owner")) {
+            owners[it.key()] = it.value()["owner"].get<std::string>();
+        }
+    }
+    return owners;
+}
+
+/**
+ * @brief Load a result named by the manifest's "conditional" section.
+ * @throws std::runtime_error if the name has no entry.
+ */
+WrapResult load_conditional_result(const nlohmann::json& section,
+                                   const std::string& name) {
+    if (!section.contains(name) || !section[name].is_object() ||
+        !section[name].contains("path")) {
+        throw std::runtime_error("Conditional header result '" + name +
+                                 "' is missing from the manifest");
+    }
+    return load_wrap_result(section[name]["path"].get<std::string>());
+}
+
+/**
+ * @brief Write a generated file.
+ * @throws std::runtime_error if the file cannot be opened for writing.
+ */
+void write_output(const std::filesystem::path& path,
+                  const std::string& content) {
+    std::ofstream file = open_ofstream(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open output file: " +
+                                 path.string());
+    }
+    file << content;
+    file.close();
+}
+
 }  // namespace
 
 int Resolver::resolve_and_generate(
@@ -112,7 +159,9 @@ int Resolver::resolve_and_generate(
     const std::filesystem::path& template_path,
     const std::filesystem::path& output_path,
     const std::map<std::string, std::filesystem::path>& inlines,
-    const std::map<std::string, std::string>& substitutions, Mode mode) {
+    const std::map<std::string, std::string>& substitutions, Mode mode,
+    const std::map<std::string, std::filesystem::path>& shards,
+    const std::optional<ConditionalHeader>& conditional) {
     try {
         if (!file_exists(manifest_path)) {
             throw std::runtime_error("Manifest file does not exist: " +
@@ -146,15 +195,16 @@ int Resolver::resolve_and_generate(
 
         std::vector<CheckResult> cache_results;
 
-        if (DebugLogger::is_debug_enabled()) {
+        if (trace::enabled(trace::Level::kInfo)) {
             std::vector<CheckResult> sorted_defines = define_results;
             std::sort(sorted_defines.begin(), sorted_defines.end(),
                       [](const CheckResult& a, const CheckResult& b) {
                           return a.name < b.name;
                       });
             for (const CheckResult& result : sorted_defines) {
-                std::string status = result.success ? "yes" : "no";
-                DebugLogger::log("checking " + result.name + "... " + status);
+                // autoconf's own `checking X... yes` line.
+                AUTOCONF_TRACE_INFO("checking", {"name", result.name},
+                                    {"value", result.success ? "yes" : "no"});
             }
         }
 
@@ -172,9 +222,52 @@ int Resolver::resolve_and_generate(
         std::string template_content = buffer.str();
         template_file.close();
 
-        generator.generate_config_header(output_path, template_content, inlines,
-                                         substitutions);
+        if (conditional.has_value()) {
+            if (!shards.empty()) {
+                throw std::runtime_error(
+                    "Conditional headers cannot be sharded");
+            }
+            nlohmann::json section =
+                manifest.value("conditional", nlohmann::json::object());
+            write_output(
+                output_path,
+                apply_conditional_wrap(
+                    generator.render_config_header(template_content, inlines,
+                                                   substitutions),
+                    load_conditional_result(section, conditional->condition),
+                    load_conditional_result(section,
+                                            conditional->include_next),
+                    load_conditional_result(section, conditional->next_header),
+                    output_path.generic_string()));
+            return 0;
+        }
+
+        if (shards.empty()) {
+            generator.generate_config_header(output_path, template_content,
+                                             inlines, substitutions);
+            return 0;
+        }
 
+        std::map<std::string, std::string> includes;
+        for (const auto& [owner, path] : shards) {
+            includes[owner] =
+                path.lexically_relative(output_path.parent_path())
+                    .generic_string();
+        }
+        ShardedHeader sharded = shard_config_header(
+            generator.render_config_header(template_content, inlines,
+                                           substitutions),
+            load_manifest_owners(defines_section), includes);
+
+        write_output(output_path, sharded.umbrella);
+        for (const auto& [owner, path] : shards) {
+            std::map<std::string, std::string>::const_iterator fragment =
+                sharded.fragments.find(owner);
+            write_output(path, "#pragma once\n\n" +
+                                   (fragment == sharded.fragments.end()
+                                        ? std::string()
+                                        : fragment->second));
+        }
         return 0;
     } catch (const std::exception& ex) {
         std::cerr << "Error: " << ex.what() << std::endl;
@@ -10,6 +10,17 @@
 
 namespace rules_cc_autoconf {
 
+/**
+ * @brief Names of the results driving gl_CONDITIONAL_HEADER wrapping.
+ *
+ * Each name must have an entry in the manifest's "conditional" section.
+ */
+struct ConditionalHeader {
+    std::string condition{};     ///< Result deciding if the header is needed
+    std::string include_next{};  ///< Result holding the include directive
+    std::string next_header{};   ///< Result holding the system header
+};
+
 /**
  * @brief Library for resolving autoconf results and generating headers.
  *
@@ -34,6 +45,14 @@ class Resolver {
      * @param substitutions Map from placeholder names to values for direct
      * @VAR@ substitution.
      * @param mode Processing mode (default: kDefines).
+     * @param shards Map from define owner to fragment path. When non-empty,
+     * defines whose manifest entry names an owner are written to that
+     * owner's fragment and `output_path` becomes an umbrella header that
+     * includes the fragments (see shard_config_header()). Every fragment is
+     * written, even if it ends up empty.
+     * @param conditional When set, the rendered header is wrapped with an
+     * `#include_next` passthrough unless the condition result is truthy (see
+     * apply_conditional_wrap()).
      * @return 0 on success, 1 on error.
      */
     static int resolve_and_generate(
@@ -42,7 +61,9 @@ class Resolver {
         const std::filesystem::path& output_path,
         const std::map<std::string, std::filesystem::path>& inlines = {},
         const std::map<std::string, std::string>& substitutions = {},
-        Mode mode = Mode::kDefines);
+        Mode mode = Mode::kDefines,
+        const std::map<std::string, std::filesystem::path>& shards = {},
+        const std::optional<ConditionalHeader>& conditional = std::nullopt);
 };
 
 }  // namespace rules_cc_autoconf
@@ -1,9 +1,15 @@
 #include "autoconf/private/resolver/source_generator.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <exception>
 #include <fstream>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "autoconf/private/checker/check.h"
@@ -14,6 +20,40 @@ namespace rules_cc_autoconf {
 
 namespace {
 
+/// Rendering content smaller than this stays on the calling thread.
+constexpr size_t kParallelRenderBytes = 1 << 20;
+
+/// Target size of the chunks rendered concurrently.
+constexpr size_t kRenderChunkBytes = 256 << 10;
+
+/// Most threads one render uses: Bazel runs many resolver actions at once.
+constexpr size_t kMaxRenderJobs = 4;
+
+/**
+ * @brief Split content into chunks of about `chunk_bytes`, each ending at
+ * a line boundary (except possibly the last).
+ *
+ * The #undef and @VAR@ passes and the end of line cleanup never look past
+ * a newline, so rendering the chunks separately gives the same output.
+ */
+std::vector<std::string> split_at_lines(const std::string& content,
+                                        size_t chunk_bytes) {
+    std::vector<std::string> chunks;
+    size_t begin = 0;
+    while (begin < content.size()) {
+        size_t end = content.size();
+        if (content.size() - begin > chunk_bytes) {
+            size_t newline = content.find('\n', begin + chunk_bytes);
+            if (newline != std::string::npos) {
+                end = newline + 1;
+            }
+        }
+        chunks.push_back(content.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
 /**
  * @brief Describes how to replace a single #undef line.
  */
@@ -170,14 +210,63 @@ SourceGenerator::SourceGenerator(const std::vector<CheckResult>& cache_results,
     : cache_results_(cache_results),
       define_results_(define_results),
       subst_results_(subst_results),
-      mode_(mode) {}
+      mode_(mode),
+      render_jobs_(std::min<size_t>(
+          kMaxRenderJobs, std::max(1u, std::thread::hardware_concurrency()))) {
+}
+
+void SourceGenerator::set_render_jobs(size_t jobs) {
+    render_jobs_ = std::max<size_t>(1, jobs);
+}
 
 void SourceGenerator::generate_config_header(
     const std::filesystem::path& output_path,
     const std::string& template_content,
     const std::map<std::string, std::filesystem::path>& inlines,
     const std::map<std::string, std::string>& substitutions) {
-    std::string content =
+    std::vector<std::string> chunks =
+        render_chunks(template_content, inlines, substitutions);
+
+    std::ofstream file = open_ofstream(output_path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open output file: " +
+                                 output_path.string());
+    }
+
+    // Written one after the other rather than joined first.
+    for (const std::string& chunk : chunks) {
+        file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    }
+    file.close();
+}
+
+std::string SourceGenerator::render_config_header(
+    const std::string& template_content,
+    const std::map<std::string, std::filesystem::path>& inlines,
+    const std::map<std::string, std::string>& substitutions) {
+    std::vector<std::string> chunks =
+        render_chunks(template_content, inlines, substitutions);
+    if (chunks.size() == 1) {
+        return std::move(chunks.front());
+    }
+
+    size_t size = 0;
+    for (const std::string& chunk : chunks) {
+        size += chunk.size();
+    }
+    std::string content;
+    content.reserve(size);
+    for (const std::string& chunk : chunks) {
+        content += chunk;
+    }
+    return content;
+}
+
+std::vector<std::string> SourceGenerator::render_chunks(
+    const std::string& template_content,
+    const std::map<std::string, std::filesystem::path>& inlines,
+    const std::map<std::string, std::string>& substitutions) {
+    std::vector<std::string> chunks =
         process_template(template_content, inlines, substitutions);
 
     // Preserve trailing newline behavior from template
@@ -186,23 +275,23 @@ void SourceGenerator::generate_config_header(
     bool template_has_trailing_newline =
         !template_content.empty() && template_content.back() == '\n';
     if (!template_has_trailing_newline) {
-        // Remove trailing newlines to match template
-        while (!content.empty() && content.back() == '\n') {
-            content.pop_back();
+        // Remove trailing newlines to match template, dropping chunks that
+        // were nothing but newlines
+        while (true) {
+            std::string& last = chunks.back();
+            while (!last.empty() && last.back() == '\n') {
+                last.pop_back();
+            }
+            if (!last.empty() || chunks.size() == 1) {
+                break;
+            }
+            chunks.pop_back();
         }
     }
-
-    std::ofstream file = open_ofstream(output_path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open output file: " +
-                                 output_path.string());
-    }
-
-    file << content;
-    file.close();
+    return chunks;
 }
 
-std::string SourceGenerator::process_template(
+std::vector<std::string> SourceGenerator::process_template(
     const std::string& template_content,
     const std::map<std::string, std::filesystem::path>& inlines,
     const std::map<std::string, std::string>& substitutions) {
@@ -213,24 +302,71 @@ std::string SourceGenerator::process_template(
 
     // Step 4: Perform inlines and direct subst calls FIRST (before defines
     // replacement) This ensures substitutions can find #undef lines before they
-    // get commented out
+    // get commented out. Search strings may span lines, so this step sees the
+    // whole template.
     content = process_inlines_and_direct_subst(content, inlines, substitutions);
 
-    // Step 2: If in defines or all mode, do defines replacement (and comment
-    // out undefs)
-    content = process_defines_replacement(content, data);
+    // The remaining steps are line local.
+    auto render = [&](std::string chunk) {
+        // Step 2: If in defines or all mode, do defines replacement (and
+        // comment out undefs)
+        chunk = process_defines_replacement(std::move(chunk), data);
 
-    // Step 3: If in subst or all mode, do replacements
-    content = process_subst_replacements(content, data);
+        // Step 3: If in subst or all mode, do replacements
+        chunk = process_subst_replacements(std::move(chunk), data);
 
-    // If in subst mode (not all), comment out all #undef statements for defines
-    // (In defines mode, this is already handled by process_defines_replacement)
-    if (mode_ == Mode::kSubst) {
-        content = comment_out_define_undefs(content, data);
+        // If in subst mode (not all), comment out all #undef statements for
+        // defines (In defines mode, this is already handled by
+        // process_defines_replacement)
+        if (mode_ == Mode::kSubst) {
+            chunk = comment_out_define_undefs(std::move(chunk), data);
+        }
+
+        // Step 5: Clean up end of file
+        return cleanup_end_of_file(chunk);
+    };
+
+    if (content.size() < kParallelRenderBytes || render_jobs_ < 2) {
+        return {render(std::move(content))};
     }
 
-    // Step 5: Clean up end of file
-    return cleanup_end_of_file(content);
+    // Large outputs (e.g. inlined system headers) render in chunks on
+    // several threads.
+    std::vector<std::string> chunks =
+        split_at_lines(content, kRenderChunkBytes);
+    content.clear();
+    content.shrink_to_fit();
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&]() {
+        try {
+            for (size_t i = next++; i < chunks.size(); i = next++) {
+                chunks[i] = render(std::move(chunks[i]));
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            next = chunks.size();
+        }
+    };
+
+    size_t workers = std::min(render_jobs_, chunks.size());
+    std::vector<std::thread> threads;
+    for (size_t id = 1; id < workers; ++id) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return chunks;
 }
 
 // Step 1: Load and parse all data
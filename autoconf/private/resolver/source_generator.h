@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <filesystem>
 #include <map>
 #include <set>
@@ -57,6 +58,28 @@ class SourceGenerator {
         const std::map<std::string, std::filesystem::path>& inlines = {},
         const std::map<std::string, std::string>& substitutions = {});
 
+    /**
+     * @brief Render a config.h header from a template string.
+     * @param template_content Template content as a string (with @PLACEHOLDER@
+     * markers and #undef statements).
+     * @param inlines Map from search strings to file paths for inline
+     * replacements.
+     * @param substitutions Map from placeholder names to values for direct
+     * @VAR@ substitution.
+     * @return The header content generate_config_header() would write.
+     */
+    std::string render_config_header(
+        const std::string& template_content,
+        const std::map<std::string, std::filesystem::path>& inlines = {},
+        const std::map<std::string, std::string>& substitutions = {});
+
+    /**
+     * @brief Set the threads a large render may use.
+     * @param jobs At most this many threads (default: 4, or the number of
+     * CPUs if lower); 1 renders on the calling thread.
+     */
+    void set_render_jobs(size_t jobs);
+
     // Deleted copy and move assignment operators (const reference members)
     SourceGenerator& operator=(const SourceGenerator&) = delete;
     SourceGenerator& operator=(SourceGenerator&&) = delete;
@@ -69,17 +92,38 @@ class SourceGenerator {
     const std::vector<CheckResult>&
         subst_results_{};              ///< Reference to subst results
     const Mode mode_{Mode::kDefines};  ///< Processing mode
+    size_t render_jobs_ = 1;           ///< See set_render_jobs()
+
+    /**
+     * @brief Render a config.h header as consecutive chunks.
+     * @param template_content Template content with @PLACEHOLDER@ markers.
+     * @param inlines Map from search strings to file paths for inline
+     * replacements.
+     * @param substitutions Map from placeholder names to values for direct
+     * @VAR@ substitution.
+     * @return Chunks whose concatenation is render_config_header().
+     */
+    std::vector<std::string> render_chunks(
+        const std::string& template_content,
+        const std::map<std::string, std::filesystem::path>& inlines,
+        const std::map<std::string, std::string>& substitutions);
 
     /**
      * @brief Process a template string, substituting placeholders.
+     *
+     * Once inlines are expanded, content of 1 MiB or more is split at line
+     * boundaries and the chunks are processed concurrently (see
+     * set_render_jobs()).
+     *
      * @param template_content Template content with @PLACEHOLDER@ markers.
      * @param inlines Map from search strings to file paths for inline
      * replacements.
      * @param substitutions Map from placeholder names to values for direct
      * @VAR@ substitution.
-     * @return Processed content with placeholders replaced.
+     * @return Processed content with placeholders replaced, as consecutive
+     * chunks.
      */
-    std::string process_template(
+    std::vector<std::string> process_template(
         const std::string& template_content,
         const std::map<std::string, std::filesystem::path>& inlines = {},
         const std::map<std::string, std::string>& substitutions = {});
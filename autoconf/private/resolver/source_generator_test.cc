@@ -0,0 +1,99 @@
+#include "autoconf/private/resolver/source_generator.h"
+
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using rules_cc_autoconf::CheckResult;
+using rules_cc_autoconf::CheckType;
+using rules_cc_autoconf::Mode;
+using rules_cc_autoconf::SourceGenerator;
+
+static int test_count = 0;
+static int pass_count = 0;
+
+#define TEST(name)                          \
+    std::cout << "  " << #name << "... ";   \
+    test_count++;                           \
+    if (test_##name()) {                    \
+        std::cout << "PASSED" << std::endl; \
+        pass_count++;                       \
+    } else {                                \
+        std::cout << "FAILED" << std::endl; \
+    }
+
+/**
+ * @brief A template past the 1 MiB parallel render threshold where every
+ * line holds an #undef or a @VAR@, so every chunk boundary is next to one.
+ * Line lengths vary so the boundaries fall on every kind of line.
+ */
+static std::string large_template(bool trailing_newline) {
+    static const char* const kLines[] = {
+        "#undef HAVE_FOO",
+        "#define VERSION \"@SUBST_VAR@\"",
+        "#undef HAVE_MISSING",
+        "  #  undef   HAVE_FOO  ",
+        "/* @SUBST_VAR@ and @UNKNOWN_VAR@ */",
+    };
+    std::string content;
+    for (size_t i = 0; content.size() < (3u << 19); ++i) {
+        content += kLines[i % 5];
+        content += std::string(i % 37, ' ');
+        content += '\n';
+    }
+    content += "\n\n";
+    if (!trailing_newline) {
+        content += "#undef HAVE_FOO";
+    }
+    return content;
+}
+
+/** @brief Render with `jobs` threads. */
+static std::string render(Mode mode, const std::string& content,
+                          size_t jobs) {
+    std::vector<CheckResult> cache_results;
+    std::vector<CheckResult> define_results = {
+        CheckResult("HAVE_FOO", std::string("1"), true),
+        CheckResult("HAVE_MISSING", std::nullopt, false),
+    };
+    std::vector<CheckResult> subst_results = {
+        CheckResult("SUBST_VAR", std::string("hello"), true, false, true,
+                    CheckType::kDefine, std::nullopt, "SUBST_VAR"),
+    };
+    SourceGenerator generator(cache_results, define_results, subst_results,
+                              mode);
+    generator.set_render_jobs(jobs);
+    return generator.render_config_header(content);
+}
+
+static bool renders_like_one_thread(bool trailing_newline) {
+    std::string content = large_template(trailing_newline);
+    for (Mode mode : {Mode::kDefines, Mode::kSubst, Mode::kAll}) {
+        std::string serial = render(mode, content, 1);
+        if (serial.empty() || serial == content ||
+            render(mode, content, 4) != serial) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool test_chunked_render_matches_serial() {
+    return renders_like_one_thread(true);
+}
+
+static bool test_chunked_render_matches_serial_without_trailing_newline() {
+    return renders_like_one_thread(false);
+}
+
+int main() {
+    std::cout << "source_generator_test:" << std::endl;
+    TEST(chunked_render_matches_serial)
+    TEST(chunked_render_matches_serial_without_trailing_newline)
+
+    std::cout << std::endl
+              << pass_count << "/" << test_count << " tests passed."
+              << std::endl;
+    return pass_count == test_count ? 0 : 1;
+}
@@ -16,6 +16,7 @@
 
 #include "autoconf/private/checker/condition_evaluator.h"
 #include "autoconf/private/common/file_util.h"
+#include "autoconf/private/common/trace.h"
 #include "tools/json/json.h"
 
 namespace rules_cc_autoconf {
@@ -228,6 +229,8 @@ bool generate_wrapped_source(const std::filesystem::path& out_path,
     }
 
     out_file.close();
+    AUTOCONF_TRACE_DEBUG("Wrapped source", {"output", out_path},
+                         {"condition", condition}, {"enabled", enabled});
     return true;
 }
 
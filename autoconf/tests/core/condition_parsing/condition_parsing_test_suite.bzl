@@ -1,7 +1,12 @@
-"""Tests for extract_condition_vars in condition_utils.bzl."""
+"""Tests for the condition helpers in condition_utils.bzl."""
 
 load("@bazel_skylib//lib:unittest.bzl", "asserts", "unittest")
-load("//autoconf/private:condition_utils.bzl", "extract_condition_vars")
+load(
+    "//autoconf/private:condition_utils.bzl",
+    "evaluate_static_condition",
+    "extract_condition_vars",
+    "static_define_value",
+)
 
 def _simple_var_test_impl(ctx):
     env = unittest.begin(ctx)
@@ -135,8 +140,36 @@ def _gnulib_getmntent_test_impl(ctx):
 
 gnulib_getmntent_test = unittest.make(_gnulib_getmntent_test_impl)
 
+def _static_define_value_test_impl(ctx):
+    env = unittest.begin(ctx)
+    asserts.equals(env, "1", static_define_value({"type": "define", "define_value": 1}))
+    asserts.equals(env, "\"1\"", static_define_value({"type": "define", "define_value": "1"}))
+    asserts.equals(env, "", static_define_value({"type": "define", "define_value": None}))
+    asserts.equals(env, None, static_define_value({"type": "define", "define_value": "a\\b"}))
+    asserts.equals(env, None, static_define_value({"type": "define", "define_value": 1, "requires": ["HAVE_X"]}))
+    asserts.equals(env, None, static_define_value({"type": "function", "define_value": 1}))
+    return unittest.end(env)
+
+static_define_value_test = unittest.make(_static_define_value_test_impl)
+
+def _evaluate_static_condition_test_impl(ctx):
+    env = unittest.begin(ctx)
+    values = {"HAVE_X": "1", "HAVE_Y": "", "REPLACE_X": "\"1\""}
+    asserts.equals(env, True, evaluate_static_condition("HAVE_X", values))
+    asserts.equals(env, False, evaluate_static_condition("!HAVE_X", values))
+    asserts.equals(env, True, evaluate_static_condition("!!HAVE_X", values))
+    asserts.equals(env, False, evaluate_static_condition("HAVE_Y", values))
+    asserts.equals(env, True, evaluate_static_condition("HAVE_X==1", values))
+    asserts.equals(env, False, evaluate_static_condition("REPLACE_X==1", values))
+    asserts.equals(env, True, evaluate_static_condition("HAVE_X >= 1", values))
+    asserts.equals(env, None, evaluate_static_condition("HAVE_Z", values))
+    asserts.equals(env, None, evaluate_static_condition("HAVE_X && HAVE_Y", values))
+    return unittest.end(env)
+
+evaluate_static_condition_test = unittest.make(_evaluate_static_condition_test_impl)
+
 def condition_parsing_test_suite(*, name, **kwargs):
-    """Test suite for extract_condition_vars.
+    """Test suite for the condition helpers.
 
     Args:
         name: Name of the test suite.
@@ -189,6 +222,12 @@ def condition_parsing_test_suite(*, name, **kwargs):
     gnulib_getmntent_test(name = name + "_gnulib_getmntent")
     tests.append(":" + name + "_gnulib_getmntent")
 
+    static_define_value_test(name = name + "_static_define_value")
+    tests.append(":" + name + "_static_define_value")
+
+    evaluate_static_condition_test(name = name + "_evaluate_static_condition")
+    tests.append(":" + name + "_evaluate_static_condition")
+
     native.test_suite(
         name = name,
         tests = tests,
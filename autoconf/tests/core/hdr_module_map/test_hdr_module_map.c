@@ -0,0 +1,9 @@
+#include <assert.h>
+
+#include "autoconf/tests/core/hdr_module_map/config.h"
+
+int main(void) {
+    assert(CUSTOM_VALUE == 42);
+    assert(ENABLE_FEATURE == 1);
+    return 0;
+}
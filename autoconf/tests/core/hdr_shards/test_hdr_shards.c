@@ -0,0 +1,18 @@
+#include <assert.h>
+#include <string.h>
+
+// Including the umbrella header pulls in every fragment.
+#include "autoconf/tests/core/hdr_shards/config.h"
+
+int main(void) {
+    assert(CUSTOM_VALUE == 42);
+    assert(ENABLE_FEATURE == 1);
+    assert(strcmp(PACKAGE_NAME, "test_hdr_shards") == 0);
+    assert(strcmp(PACKAGE_VERSION, "1.0.0") == 0);
+
+#ifdef HAVE_UNOWNED
+    assert(0 && "HAVE_UNOWNED should not be defined");
+#endif
+
+    return 0;
+}
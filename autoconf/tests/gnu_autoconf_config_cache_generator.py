@@ -0,0 +1,92 @@
+"""Generates the shared `config.cache` seed for `gnu_autoconf_configure_test`."""
+
+import argparse
+import shutil
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+
+def parse_args() -> argparse.Namespace:
+    """Parse command line arguments."""
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument(
+        "--configure-ac",
+        type=Path,
+        required=True,
+        help="The configure.ac whose probes populate the cache.",
+    )
+    parser.add_argument(
+        "--output",
+        type=Path,
+        required=True,
+        help="The path of the config.cache to write.",
+    )
+    return parser.parse_args()
+
+
+def _run(command: list[str], cwd: Path) -> bool:
+    """Run a command, echoing its output to stderr when it fails."""
+    try:
+        result = subprocess.run(
+            command,
+            cwd=cwd,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True,
+            encoding="utf-8",
+        )
+    except OSError as error:
+        # e.g. `./configure` is not directly executable on Windows.
+        print(f"`{' '.join(command)}` failed: {error}", file=sys.stderr)
+        return False
+    if result.returncode != 0:
+        print(
+            f"`{' '.join(command)}` failed:\n{result.stdout}",
+            file=sys.stderr,
+        )
+        return False
+    return True
+
+
+def generate_cache(configure_ac: Path) -> str:
+    """Run autoreconf and configure, returning the resulting config.cache.
+
+    `ac_cv_env_*` entries record the precious variables (CC, CFLAGS, ...)
+    of this run. They are dropped so configure does not reject the seed
+    when a test runs with a different environment.
+
+    Returns an empty string when autoconf is unavailable or a step fails.
+    """
+    autoreconf = shutil.which("autoreconf")
+    if not autoreconf:
+        print("autoreconf not found, writing an empty seed", file=sys.stderr)
+        return ""
+
+    with tempfile.TemporaryDirectory(prefix="config_cache_") as tmp:
+        work_dir = Path(tmp)
+        shutil.copyfile(configure_ac, work_dir / "configure.ac")
+
+        if not _run([autoreconf, "-i"], work_dir):
+            return ""
+        if not _run(["./configure", "--cache-file=config.cache"], work_dir):
+            return ""
+
+        cache = (work_dir / "config.cache").read_text(encoding="utf-8")
+
+    return "".join(
+        line + "\n"
+        for line in cache.splitlines()
+        if not line.startswith("ac_cv_env_")
+    )
+
+
+def main() -> None:
+    """The main entrypoint."""
+    args = parse_args()
+    args.output.write_text(generate_cache(args.configure_ac), encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
@@ -44,6 +44,10 @@ def _gnu_autoconf_configure_test_impl(ctx):
             ctx.file.golden_subst_h,
         ])
 
+    if ctx.file.config_cache:
+        env["TEST_CONFIG_CACHE"] = _rlocationpath(ctx.file.config_cache, ctx.workspace_name)
+        data_files.append(ctx.file.config_cache)
+
     if ctx.attr.verify_variables:
         env["VERIFY_VARIABLES"] = "1"
 
@@ -79,6 +83,11 @@ _gnu_autoconf_configure_test = rule(
             allow_single_file = True,
             mandatory = True,
         ),
+        "config_cache": attr.label(
+            doc = "A `config.cache` seed passed to configure via `--cache-file`. An empty file disables the seed.",
+            allow_single_file = True,
+            default = Label("//autoconf/tests:config_cache"),
+        ),
         "configure_ac": attr.label(
             doc = "The configure.ac file specific to this m4 module",
             allow_single_file = True,
@@ -113,6 +122,50 @@ _gnu_autoconf_configure_test = rule(
     test = True,
 )
 
+def _gnu_autoconf_config_cache_impl(ctx):
+    output = ctx.actions.declare_file("{}/config.cache".format(ctx.label.name))
+
+    args = ctx.actions.args()
+    args.add("--configure-ac", ctx.file.configure_ac)
+    args.add("--output", output)
+
+    ctx.actions.run(
+        executable = ctx.executable._generator,
+        arguments = [args],
+        inputs = [ctx.file.configure_ac],
+        outputs = [output],
+        mnemonic = "GnuAutoconfConfigCache",
+        # GNU autoconf and the host compiler are found through `PATH`, the
+        # same way `gnu_autoconf_configure_test` finds them.
+        use_default_shell_env = True,
+        execution_requirements = {"no-remote": "1"},
+    )
+
+    return [DefaultInfo(files = depset([output]))]
+
+gnu_autoconf_config_cache = rule(
+    doc = """\
+Run GNU autoconf and configure once to produce a `config.cache` seed.
+
+Every `gnu_autoconf_configure_test` starts configure from a copy of this seed,
+so probes shared by all suites (compiler detection, system extensions, common
+headers, ...) run once per platform instead of once per suite. When autoconf
+is not installed the seed is empty and configure runs uncached.""",
+    implementation = _gnu_autoconf_config_cache_impl,
+    attrs = {
+        "configure_ac": attr.label(
+            doc = "The configure.ac whose probes populate the cache.",
+            allow_single_file = True,
+            mandatory = True,
+        ),
+        "_generator": attr.label(
+            executable = True,
+            cfg = "exec",
+            default = Label("//autoconf/tests:gnu_autoconf_config_cache_generator"),
+        ),
+    },
+)
+
 def gnu_autoconf_configure_test(*, name, tags = [], **kwargs):
     _gnu_autoconf_configure_test(
         name = name,
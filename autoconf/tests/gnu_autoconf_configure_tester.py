@@ -321,6 +321,12 @@ class GnuAutoconfConfigureTest(unittest.TestCase):
             cls.golden_subst_h_path = get_path("TEST_GOLDEN_SUBST_H")
             cls.golden_subst_h_name = os.environ["TEST_GOLDEN_SUBST_H"]
 
+        # Shared config.cache seed (optional, may be empty when the seed
+        # could not be generated on this platform)
+        cls.config_cache_seed = None
+        if "TEST_CONFIG_CACHE" in os.environ:
+            cls.config_cache_seed = get_path("TEST_CONFIG_CACHE")
+
         # Set up work directory
         cls.outputs_dir = Path(
             os.environ.get(
@@ -489,9 +495,18 @@ class GnuAutoconfConfigureTest(unittest.TestCase):
         # configure.chmod(0o755)
         cls._cleanup_unused_m4_files()
 
+        # Start from the shared seed so the common compiler probes are
+        # answered from the cache. configure rewrites its cache file on
+        # exit, so it gets a private copy of the read-only runfile.
+        configure_args = [str(configure)]
+        if cls.config_cache_seed and cls.config_cache_seed.stat().st_size:
+            config_cache = cls.work_dir / "config.cache"
+            shutil.copyfile(cls.config_cache_seed, config_cache)
+            configure_args.append(f"--cache-file={config_cache.name}")
+
         # Run configure
         result = subprocess.run(
-            [str(configure)],
+            configure_args,
             cwd=cls.work_dir,
             stdout=subprocess.PIPE,
             stderr=subprocess.STDOUT,
@@ -5,50 +5,12 @@ load(
     "//autoconf/private:autoconf_config.bzl",
     "collect_deps",
     "collect_transitive_results",
+    "find_result_file",
 )
 
 # buildifier: disable=bzl-visibility
 load("//autoconf/private:providers.bzl", "CcAutoconfInfo")
 
-def _find_result_file(name, all_cache, all_define, all_subst, label):
-    """Look up a check result name across cache/define/subst namespaces.
-
-    Returns the result File, or fails with a clear error if not found or
-    ambiguous.
-    """
-    candidates = []
-    if name in all_cache:
-        candidates.append(("cache", all_cache[name]))
-    if name in all_define:
-        candidates.append(("define", all_define[name]))
-    if name in all_subst:
-        candidates.append(("subst", all_subst[name]))
-
-    if not candidates:
-        all_available = {
-            "cache": sorted(all_cache.keys()),
-            "define": sorted(all_define.keys()),
-            "subst": sorted(all_subst.keys()),
-        }
-        fail("gnulib_conditional_hdr `{}` requires `{}` which is not provided by any deps. Available: {}".format(
-            label,
-            name,
-            json.encode_indent(all_available, indent = " " * 4),
-        ))
-
-    distinct_paths = {}
-    for bucket, f in candidates:
-        distinct_paths[f.path] = (bucket, f)
-
-    if len(distinct_paths) != 1:
-        fail("gnulib_conditional_hdr `{}` requires `{}` but it is ambiguous across deps.\nMatches: {}".format(
-            label,
-            name,
-            [(bucket, f.path) for (bucket, f) in candidates],
-        ))
-
-    return distinct_paths.values()[0][1]
-
 def _gnulib_conditional_hdr_impl(ctx):
     deps = collect_deps(ctx.attr.deps)
     dep_infos = deps.to_list()
@@ -58,9 +20,9 @@ def _gnulib_conditional_hdr_impl(ctx):
     all_define = dep_results["define"]
     all_subst = dep_results["subst"]
 
-    condition_file = _find_result_file(ctx.attr.condition, all_cache, all_define, all_subst, ctx.label)
-    include_next_file = _find_result_file(ctx.attr.include_next, all_cache, all_define, all_subst, ctx.label)
-    next_header_file = _find_result_file(ctx.attr.next_header, all_cache, all_define, all_subst, ctx.label)
+    condition_file = find_result_file(ctx.attr.condition, all_cache, all_define, all_subst, ctx.label)
+    include_next_file = find_result_file(ctx.attr.include_next, all_cache, all_define, all_subst, ctx.label)
+    next_header_file = find_result_file(ctx.attr.next_header, all_cache, all_define, all_subst, ctx.label)
 
     src_file = ctx.file.src
 
@@ -91,7 +53,9 @@ Conditionally wrap a processed gnulib header with a passthrough fallback.
 
 This rule mirrors upstream gnulib's `gl_CONDITIONAL_HEADER` + Makefile.am
 pattern.  It sits downstream of `autoconf_hdr` and decides, based on a
-check result, whether the processed wrapper header is needed:
+check result, whether the processed wrapper header is needed.  Setting
+`condition` on the `autoconf_hdr` itself produces the same output in a
+single action, without the intermediate processed header:
 
 - **Condition truthy** (wrapper needed): the `src` content is output as-is.
 - **Condition falsy** (wrapper not needed): the output wraps the processed
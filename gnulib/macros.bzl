@@ -9,7 +9,7 @@ easier to port modules while maintaining consistency with gnulib behavior.
 load("//autoconf:checks.bzl", autoconf_checks = "checks")
 
 # buildifier: disable=bzl-visibility
-load("//autoconf/private:check_info.bzl", "make_check")
+load("//autoconf/private:check_info.bzl", "add_outputs", "make_check")
 
 def _normalize_for_cache_name(s):
     """Normalize a string for use in cache variable names.
@@ -63,8 +63,8 @@ def _check_funcs_android(
     ```
 
     Implementation:
-    For each function, this creates: AC_CHECK_FUNC; AC_DEFINE(HAVE_<FUNCTION>) when
-    present; AC_SUBST(HAVE_<FUNCTION>, "1"/"0").
+    For each function, this creates one AC_CHECK_FUNC whose checker action also
+    writes AC_DEFINE(HAVE_<FUNCTION>) when present.
 
     Args:
         functions: List of function names to check (e.g., ["dup3", "printf"]) or single function name.
@@ -96,14 +96,13 @@ def _check_funcs_android(
             requires = requires,
         )
 
-        result.append(func_check)
-
-        # 2. AC_DEFINE - only when function exists
-        result.append(autoconf_checks.AC_DEFINE(
+        # 2. AC_DEFINE - only when function exists, written by the same
+        # checker run as the function check.
+        result.append(add_outputs(func_check, [autoconf_checks.AC_DEFINE(
             have_var,
             condition = cache_var,
             requires = [cache_var],
-        ))
+        )]))
 
     return result
 
@@ -221,7 +220,9 @@ def _next_headers_internal(headers, value = None, condition = None):
 
     When `value` is provided, uses a static AC_SUBST (the caller knows the
     exact value to use). When `condition` is provided, uses a conditional
-    AC_SUBST.
+    AC_SUBST. Either way the second variable is an output of the first, so
+    one checker action writes both. GL_NEXT_HEADER pairs share their result
+    through the content cache instead.
 
     Args:
         headers: List of header names.
@@ -242,11 +243,15 @@ def _next_headers_internal(headers, value = None, condition = None):
         next_as_first_var = "NEXT_AS_FIRST_DIRECTIVE_{}".format(header_upper)
         if condition:
             header_value = value if value != None else "<{}>".format(header)
-            result.append(autoconf_checks.AC_SUBST(next_var, condition = condition, if_true = header_value, if_false = ""))
-            result.append(autoconf_checks.AC_SUBST(next_as_first_var, condition = condition, if_true = header_value, if_false = ""))
+            result.append(add_outputs(
+                autoconf_checks.AC_SUBST(next_var, condition = condition, if_true = header_value, if_false = ""),
+                [autoconf_checks.AC_SUBST(next_as_first_var, condition = condition, if_true = header_value, if_false = "")],
+            ))
         elif value != None:
-            result.append(autoconf_checks.AC_SUBST(next_var, value))
-            result.append(autoconf_checks.AC_SUBST(next_as_first_var, value))
+            result.append(add_outputs(
+                autoconf_checks.AC_SUBST(next_var, value),
+                [autoconf_checks.AC_SUBST(next_as_first_var, value)],
+            ))
         else:
             result.append(_gl_next_header(header, name = next_var))
             result.append(_gl_next_header(header, name = next_as_first_var))
@@ -278,7 +283,7 @@ def _check_next_headers(headers, value = None, condition = None):
             define names (e.g., `"!HAVE_FOO"`), cache variables, or comparisons.
 
     Returns:
-        List of JSON-encoded check strings (header check + two AC_SUBST per header).
+        List of JSON-encoded check strings (NEXT_* and NEXT_AS_FIRST_DIRECTIVE_* per header).
     """
     return _next_headers_internal(headers, value, condition = condition)
 
@@ -300,7 +305,7 @@ def _next_headers(headers, value = None, condition = None):
             define names (e.g., `"!HAVE_FOO"`), cache variables, or comparisons.
 
     Returns:
-        List of JSON-encoded check strings (two AC_SUBST checks per header).
+        List of JSON-encoded check strings (NEXT_* and NEXT_AS_FIRST_DIRECTIVE_* per header).
     """
     return _next_headers_internal(headers, value, condition = condition)
 
@@ -351,7 +356,7 @@ def _ac_lib_have_linkflags(
         lib_prefix_value: Value for LIB_<NAME>_PREFIX when link succeeds.
 
     Returns:
-        List of JSON-encoded check strings (one link check + four subst).
+        List with one JSON-encoded link check carrying the four substs as outputs.
     """
     name_normalized = _normalize_for_cache_name(lib_name)
 
@@ -363,8 +368,6 @@ def _ac_lib_have_linkflags(
     ltlib_var = "LTLIB" + name_upper
     lib_prefix_var = "LIB" + name_upper + "_PREFIX"
 
-    result = []
-
     # 1. Link check (library must come from target deps; no per-check link_flags in checker)
     if includes:
         prologue = "\n".join(includes) if type(includes) == type([]) else includes
@@ -372,27 +375,30 @@ def _ac_lib_have_linkflags(
     else:
         full_code = "int main(void) {\n  " + test_code.replace("\n", "\n  ") + "\n  return 0;\n}"
 
-    result.append(autoconf_checks.AC_TRY_LINK(
+    link_check = autoconf_checks.AC_TRY_LINK(
         code = full_code,
         name = cache_var,
         define = have_var,
-    ))
-
-    # 2–5. AC_SUBST(HAVE_LIB_<NAME>, LIB_<NAME>, LTLIB_<NAME>, LIB_<NAME>_PREFIX)
-    for (var, val_true, val_false) in [
-        (have_var, "yes", "no"),
-        (lib_var, lib_value, ""),
-        (ltlib_var, ltlib_value, ""),
-        (lib_prefix_var, lib_prefix_value, ""),
-    ]:
-        result.append(autoconf_checks.AC_SUBST(
+    )
+
+    # 2–5. AC_SUBST(HAVE_LIB_<NAME>, LIB_<NAME>, LTLIB_<NAME>, LIB_<NAME>_PREFIX),
+    # written by the link check's action.
+    substs = [
+        autoconf_checks.AC_SUBST(
             var,
             condition = cache_var,
             if_true = val_true,
             if_false = val_false,
-        ))
-
-    return result
+        )
+        for (var, val_true, val_false) in [
+            (have_var, "yes", "no"),
+            (lib_var, lib_value, ""),
+            (ltlib_var, ltlib_value, ""),
+            (lib_prefix_var, lib_prefix_value, ""),
+        ]
+    ]
+
+    return [add_outputs(link_check, substs)]
 
 checks = struct(
     GL_NEXT_HEADER = _gl_next_header,
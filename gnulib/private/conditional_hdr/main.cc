@@ -23,7 +23,7 @@
 #include <vector>
 
 #include "autoconf/private/common/file_util.h"
-#include "tools/json/json.h"
+#include "autoconf/private/resolver/conditional_wrap.h"
 
 namespace rules_cc_autoconf {
 
@@ -95,43 +95,6 @@ bool parse_args(int argc, char* argv[], Args& out) {
     return true;
 }
 
-struct ResultEntry {
-    std::string value;
-    bool success = false;
-};
-
-ResultEntry load_result(const std::string& path) {
-    auto file = open_ifstream(path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open result file: " + path);
-    }
-
-    nlohmann::json j;
-    file >> j;
-
-    if (j.is_null() || !j.is_object() || j.empty()) {
-        return {};
-    }
-
-    ResultEntry entry;
-    auto vi = j.find("value");
-    if (vi != j.end() && !vi->is_null()) {
-        entry.value = vi->is_string() ? vi->get<std::string>() : vi->dump();
-    }
-    auto si = j.find("success");
-    entry.success = (si != j.end()) ? si->get<bool>() : false;
-    return entry;
-}
-
-/**
- * Matches the autoconf_srcs truthiness pattern: a result is truthy when the
- * check succeeded AND the value is non-empty AND the value is not "0".
- */
-bool is_truthy(const ResultEntry& entry) {
-    return entry.success && !entry.value.empty() && entry.value != "0" &&
-           entry.value != "false";
-}
-
 }  // namespace rules_cc_autoconf
 
 int main(int argc, char* argv[]) {
@@ -164,11 +127,13 @@ int main(int argc, char* argv[]) {
     }
 
     // Load results for the three named checks.
-    ResultEntry condition_result, include_next_result, next_header_result;
+    WrapResult condition_result, include_next_result, next_header_result;
     try {
-        condition_result = load_result(dep_map.at(args.condition_name));
-        include_next_result = load_result(dep_map.at(args.include_next_name));
-        next_header_result = load_result(dep_map.at(args.next_header_name));
+        condition_result = load_wrap_result(dep_map.at(args.condition_name));
+        include_next_result =
+            load_wrap_result(dep_map.at(args.include_next_name));
+        next_header_result =
+            load_wrap_result(dep_map.at(args.next_header_name));
     } catch (const std::exception& ex) {
         std::cerr << "Error loading result: " << ex.what() << "\n";
         return EXIT_FAILURE;
@@ -193,38 +158,9 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    if (is_truthy(condition_result)) {
-        out << src_content;
-    } else {
-        // Resolve the next header value for the passthrough.  When the
-        // upstream condition on GL_NEXT_HEADERS prevented resolution the
-        // value will be empty; fall back to the output basename wrapped in
-        // angle brackets (e.g. "lib/assert.h" → "<assert.h>").
-        std::string next_hdr = next_header_result.value;
-        if (next_hdr.empty()) {
-            auto slash = args.output_path.rfind('/');
-            std::string basename = (slash != std::string::npos)
-                                       ? args.output_path.substr(slash + 1)
-                                       : args.output_path;
-            next_hdr = "<" + basename + ">";
-        }
-
-        // Construct the passthrough directive: #<include_next> <next_header>
-        // GCC/Clang: #include_next <assert.h>
-        // MSVC: # \n<inlined system header>
-        std::string passthrough =
-            "#" + include_next_result.value + " " + next_hdr;
-
-        out << "#if 1\n";
-        out << passthrough << "\n";
-        out << "#else\n";
-        out << src_content;
-        if (!src_content.empty() && src_content.back() != '\n') {
-            out << "\n";
-        }
-        out << "#endif\n";
-    }
-
+    out << apply_conditional_wrap(src_content, condition_result,
+                                  include_next_result, next_header_result,
+                                  args.output_path);
     out.close();
     return EXIT_SUCCESS;
 }